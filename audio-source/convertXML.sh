@@ -0,0 +1,11 @@
+#!/bin/sh
+# Converts config.xml into samv71-ucs/src/default_config.c, the portable counterpart of convertXML.bat.
+# With --check nothing is written, the script fails if default_config.c does not match config.xml.
+cd "$(dirname "$0")" || exit 1
+if [ "$1" = "--check" ]; then
+    python3 ../tools/xml2struct/xml2struct.py --check samv71-ucs/src/default_config.c config.xml || exit 1
+    echo "default_config.c is up to date"
+else
+    python3 ../tools/xml2struct/xml2struct.py -o samv71-ucs/src/default_config.c config.xml || exit 1
+    echo "Conversion was successful"
+fi
@@ -35,6 +35,7 @@
 #include <assert.h>
 #include "timetick.h"
 #include "Console.h"
+#include "profile.h"
 
 #define SEND_BUFFER         (4096)
 #define ETHERNET_MAX_LEN    (1300)
@@ -104,6 +105,7 @@ void ConsoleService( void )
 {
     if (!initialied) return;
 	if (0 == txBufPosIn) return;
+    PROFILE_BEGIN(PROF_CONSOLE_SERVICE);
     do
     {
         uint32_t sendLen = txBufPosIn - txBufPosOut;
@@ -125,6 +127,7 @@ void ConsoleService( void )
             break;
         }
     } while (true);
+    PROFILE_END(PROF_CONSOLE_SERVICE);
 }
 
 static void InitUdpHeaders()
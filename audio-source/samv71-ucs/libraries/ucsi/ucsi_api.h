@@ -64,6 +64,20 @@ void UCSI_Init(UCSI_Data_t *pPriv, void *pTag);
  */
 bool UCSI_RunInProgrammingMode(UCSI_Data_t *pPriv, uint8_t amountOfNodes);
 
+/**
+ * \brief Attaches memory, which keeps the topology of the last network session across a controller reset
+ * \note Call after UCSI_Init and before UCSI_NewConfig. The memory must not be cleared by the startup code.
+ * \note On a warm start, nodes with an unchanged configuration fingerprint (MD5 of the node script and
+ *       the routes of the node), which show the same signature at the same position, are reported as unchanged.
+ *       Their scripts still run, as the signature does not tell if the node was reset in the meantime.
+ *       Routes are always built again, but changed connection labels are reported.
+ * \note The node list given to UCSI_NewConfig is not modified.
+ *
+ * \param pPriv - private data section of this instance
+ * \param pCache - Memory surviving a reset, the content is validated by UCSI_NewConfig
+ */
+void UCSI_SetTopologyCache(UCSI_Data_t *pPriv, UCSI_TopologyCache_t *pCache);
+
 /**
  * \brief Executes the given configuration. If already started, all
  *        existing local and remote INIC resources will be destroyed
@@ -82,6 +96,30 @@ bool UCSI_NewConfig(UCSI_Data_t *pPriv,
     uint16_t packetBw, Ucs_Rm_Route_t *pRoutesList, uint16_t routesListSize,
     Ucs_Rm_Node_t *pNodesList, uint16_t nodesListSize);
 
+/**
+ * \brief Changes the running configuration without tearing down unaffected routes
+ * \note Routes of the new list are matched by route ID against the running configuration.
+ *       Routes missing in the new list are deactivated, kept routes follow their active flag.
+ *       All other routes keep streaming.
+ * \note The running route list may be passed again with edited active flags. Changes are compared against the
+ *       last requested state of each route, requests still waiting in the queue included.
+ * \note Either all route changes are enqueued or none, if the command queue can not take them.
+ * \note UNICENS only knows the route objects given at start, so the running lists stay in use.
+ *       A new or changed route (other endpoints or XRM jobs), a changed node list or node script and a
+ *       changed packet bandwidth can not be applied at runtime. In this case UCSI_NewConfig is called.
+ *
+ * \param pPriv - private data section of this instance
+ * \param packetBw - The amount of bytes per frame, reserved for Ethernet channel.
+ * \param pRoutesList - Reference to a list of routes
+ * \param routesListSize - Number of routes in the list
+ * \param pNodesList - Reference to the list of nodes
+ * \param nodesListSize - Number of nodes in the list
+ * \return true, if the update or the full restart was enqueued, false otherwise
+ */
+bool UCSI_UpdateConfig(UCSI_Data_t *pPriv,
+    uint16_t packetBw, Ucs_Rm_Route_t *pRoutesList, uint16_t routesListSize,
+    Ucs_Rm_Node_t *pNodesList, uint16_t nodesListSize);
+
 /**
  * \brief Executes the given script. If already started, all
  *        existing local and remote INIC resources will be destroyed
@@ -191,17 +229,19 @@ bool UCSI_SetRouteActive(UCSI_Data_t *pPriv, uint16_t routeId, bool isActive);
 /**
  * \brief Performs an remote I2C write command
  * \note Call this function only from single context (not from ISR)
+ * \note Bursts longer than I2C_WRITE_MAX_LEN are split at block boundaries into several writes.
+ *        Consecutive not yet started writes of equal block length to the same node and slave are joined to one burst.
  *
  * \param pPriv - private data section of this instance
  * \param targetAddress - targetAddress - The node / group target address
- * \param isBurst - true, write blockCount I2C telegrams dataLen with a single call. false, write a single I2C message.
+ * \param isBurst - true, write blockCount I2C telegrams of (dataLen / blockCount) bytes with a single call. false, write a single I2C message.
  * \param blockCount - amount of blocks to write. Only used when isBurst is set to true.
  * \param slaveAddr - The I2C address.
  * \param timeout - Timeout in milliseconds.
  * \param dataLen - Amount of bytes to send via I2C
  * \param pData - The payload to be send.
  *
- * \return true, if route command was enqueued to UNICENS.
+ * \return true, if route command was enqueued to UNICENS. false, nothing or only the first part of a split burst was enqueued.
  */
 bool UCSI_I2CWrite(UCSI_Data_t *pPriv, uint16_t targetAddress, bool isBurst, uint8_t blockCount,
     uint8_t slaveAddr, uint16_t timeout, uint8_t dataLen, const uint8_t *pData);
@@ -268,6 +308,31 @@ bool UCSI_ProgramIdentStringRom(UCSI_Data_t *pPriv, const Ucs_Signature_t *signa
  */
 bool UCSI_EnablePromiscuousMode(UCSI_Data_t *pPriv, uint16_t targetAddress, bool enablePromiscuous);
 
+/**
+ * \brief Retrieves the statistics of the command queue.
+ * \note Repeated GPIO writes to the same node and repeated route requests are coalesced while
+ *       they wait in the queue. A route request replaces the state of a pending request for the same
+ *       route, so the last requested state wins. The counters show how many commands never had to
+ *       be sent to the INIC.
+ *
+ * \param pPriv - private data section of this instance
+ * \param pStats - Will be filled with the current counter values
+ */
+void UCSI_GetQueueStats(UCSI_Data_t *pPriv, UCSI_QueueStats_t *pStats);
+
+/**
+ * \brief Retrieves the statistics of the error recovery.
+ * \note Failed GPIO, I2C, script and packet filter commands are retried up to CMD_MAX_RETRIES times.
+ *       A suspended route is rebuilt on its own. A general communication error resets the control
+ *       channel and restarts UNICENS, any other general error or a second one within
+ *       RECOVERY_ESCALATE_MS additionally resets the INIC. The downtime runs from the error until
+ *       the command succeeded, or until the network is available and all active routes are built again.
+ *
+ * \param pPriv - private data section of this instance
+ * \param pStats - Will be filled with the current counter values
+ */
+void UCSI_GetRecoveryStats(UCSI_Data_t *pPriv, UCSI_RecoveryStats_t *pStats);
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                        CALLBACK SECTION                              */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
@@ -341,11 +406,21 @@ extern void UCSI_CB_OnServiceRequired(void *pTag);
 
 /**
  * \brief Callback when ever the INIC should be reseted by the integration code
+ * \note On a full error recovery, UCSI_CB_OnResetControlChannel is called right before
   * \note This function must be implemented by the integrator
  * \param pTag - Pointer given by the integrator by UCSI_Init
  */
 extern void UCSI_CB_OnResetInic(void *pTag);
 
+/**
+ * \brief Callback when the control channel must be reset after a general error of UNICENS
+ * \note Drop all control messages received but not yet passed to UCSI_ProcessRxData, they belong to the terminated UNICENS instance.
+ *       Reset the control channel of the LLD, so that no transfer of the old instance is left in the hardware
+ * \note This function must be implemented by the integrator
+ * \param pTag - Pointer given by the integrator by UCSI_Init
+ */
+extern void UCSI_CB_OnResetControlChannel(void *pTag);
+
 /**
  * \brief Callback when ever this instance of UNICENS wants to send control data to the LLD.
  * \note This function must be implemented by the integrator
@@ -42,16 +42,24 @@
 #define DEBUG_XRM
 #define ENABLE_RESOURCE_PRINT
 #define BOARD_PMS_TX_SIZE       (72)
-#define CMD_QUEUE_LEN           (8)
+#define CMD_QUEUE_SIZE          (512)
+#define CMD_MAX_IN_FLIGHT       (4)
+#define MAX_CONCURRENT_SCRIPTS  (3)
+#define CMD_MAX_RETRIES         (2)
+#define CMD_RETRY_DELAY_MS      (50)
+#define RECOVERY_ESCALATE_MS    (10000)
 #define I2C_WRITE_MAX_LEN       (32)
 #define AMS_MSG_MAX_LEN         (45)
-#define MAX_NODES               (8)
+#define MAX_NODES               (64)
+#define MAX_ROUTES              (128)
 
 #include <string.h>
 #include <stdarg.h>
 
 #include "ucs_cfg.h"
 #include "ucs_api.h"
+#include "ucsi_index.h"
+#include "ucsi_fingerprint.h"
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                          PRIVATE SECTION                             */
@@ -67,7 +75,9 @@ typedef enum
     /**Result is OK but the processing is ongoing. Must wait for callback.*/
     UniCmdResult_OK_NeedToWaitForCB,
     /**Result is error and the processing is finished. Safe to dequeue this command.*/
-    UniCmdResult_ERROR_ProcessFinished
+    UniCmdResult_ERROR_ProcessFinished,
+    /**UNICENS API is locked by an ongoing request. Keep the command queued and retry later.*/
+    UniCmdResult_Busy_TryLater
 } UnicensCmdResult_t;
 
 /**
@@ -152,7 +162,7 @@ typedef struct
     uint8_t slaveAddr;
     uint16_t timeout;
     uint8_t dataLen;
-    uint8_t data[I2C_WRITE_MAX_LEN];
+    uint8_t data[I2C_WRITE_MAX_LEN]; /* Must be the last member, only dataLen bytes are queued */
 } UnicensCmdI2CWrite_t;
 
 /**
@@ -173,8 +183,8 @@ typedef struct
 {
     uint16_t msgId;
     uint16_t targetAddress;
-    uint8_t pPayload[AMS_MSG_MAX_LEN];
     uint32_t payloadLen;
+    uint8_t pPayload[AMS_MSG_MAX_LEN]; /* Must be the last member, only payloadLen bytes are queued */
 } UnicensCmdSendAmsMessage_t;
 
 /**
@@ -235,15 +245,107 @@ typedef struct
  * \note Never touch any of this fields!
  */
 typedef struct {
-    volatile uint8_t *dataQueue;
-    volatile uint8_t *pRx;
-    volatile uint8_t *pTx;
-    volatile uint32_t amountOfEntries;
-    volatile uint32_t sizeOfEntry;
-    volatile uint32_t rxPos;
-    volatile uint32_t txPos;
+    uint8_t *dataQueue;
+    uint32_t size;
+    uint32_t rxPos;
+    uint32_t txPos;
+    uint32_t used;
 } RB_t;
 
+/**
+ * \brief Configuration timeline of one node, all times in milliseconds after the network became available
+ */
+typedef struct
+{
+    uint16_t welcomed;
+    uint16_t scriptTime;
+    uint16_t configured;
+} UCSI_NodeTimeline_t;
+
+/**
+ * \brief Signature of one node, as it was seen in the last network session
+ */
+typedef struct
+{
+    uint16_t posAddr;
+    uint16_t mac[3];
+    uint32_t fwBuild;
+    uint8_t fwVersion[3];
+    uint8_t flags;
+    uint8_t fingerprint[UCSI_FINGERPRINT_LEN]; /* Configuration the script was applied with */
+} UCSI_CachedNode_t;
+
+/**
+ * \brief Topology of the last network session, kept by the integrator across a controller reset
+ * \note Entries are stored in the order of the node and route lists given to UCSI_NewConfig
+ */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t configId;
+    uint16_t nodeCount;
+    uint16_t routeCount;
+    uint32_t warmStarts;
+    UCSI_CachedNode_t node[MAX_NODES];
+    uint16_t conLabel[MAX_ROUTES];
+    uint32_t checksum; /* Must be the last member */
+} UCSI_TopologyCache_t;
+
+/**
+ * \brief Statistics of the UNICENS Integration command queue
+ */
+typedef struct
+{
+    /**Commands added to the queue.*/
+    uint32_t enqueued;
+    /**Commands absorbed by an already pending command for the same GPIO port or route, the last requested state wins.*/
+    uint32_t merged;
+    /**Route requests dropped, because a route recovery replaced them before they were started.*/
+    uint32_t cancelled;
+} UCSI_QueueStats_t;
+
+/**
+ * \brief Recovery steps, ordered by the downtime they cause
+ */
+typedef enum
+{
+    /**A failed command was sent again, nothing else was touched.*/
+    UCSI_Recovery_Retry,
+    /**A suspended route was rebuilt, all other routes kept running.*/
+    UCSI_Recovery_Route,
+    /**The control channel was reset and UNICENS restarted, the INIC was not reset.*/
+    UCSI_Recovery_Channel,
+    /**The control channel and the INIC were reset and UNICENS restarted.*/
+    UCSI_Recovery_Full,
+    UCSI_Recovery_Count
+} UCSI_RecoveryTier_t;
+
+/**
+ * \brief Statistics of the error recovery, all times in milliseconds
+ */
+typedef struct
+{
+    /**Recoveries which brought the command or the routes back.*/
+    uint32_t count[UCSI_Recovery_Count];
+    /**Recoveries which gave up or had to be escalated to the next step.*/
+    uint32_t failed[UCSI_Recovery_Count];
+    /**Downtime of the last successful recovery.*/
+    uint16_t lastDowntime[UCSI_Recovery_Count];
+    /**Longest downtime of a successful recovery.*/
+    uint16_t maxDowntime[UCSI_Recovery_Count];
+} UCSI_RecoveryStats_t;
+
+/**
+ * \brief Retry state of one in-flight command
+ */
+typedef struct
+{
+    uint8_t count;
+    bool pending;
+    uint16_t failTime;
+    uint16_t retryTime;
+} UCSI_RetryState_t;
+
 /**
  * \brief Internal variables for one instance of UNICENS Integration
  * \note Allocate this structure for each instance (static or malloc)
@@ -259,15 +361,51 @@ typedef struct
     bool programmingMode;
     bool programmingJobsTotal;
     bool programmingJobsFinished;
-    Ucs_Rm_Route_t *pendingRoutePtr;
     RB_t rb;
-    uint8_t rbBuf[(CMD_QUEUE_LEN * sizeof(UnicensCmdEntry_t))];
+    void *rbBuf[(CMD_QUEUE_SIZE / sizeof(void *))]; /* Pointer typed to keep the command records aligned */
     Ucs_Inst_t *unicens;
     Ucs_InitData_t uniInitData;
     bool triggerService;
     Ucs_Lld_Api_t *uniLld;
     void *uniLldHPtr;
-    UnicensCmdEntry_t *currentCmd;
+    UnicensCmdEntry_t inFlight[CMD_MAX_IN_FLIGHT];
+    uint8_t inFlightCount;
+    UCSI_QueueStats_t queueStats;
+    UCSI_Index_t routeIndex;
+    uintptr_t routeIndexKeys[UCSI_INDEX_CAPACITY(MAX_ROUTES)];
+    uint16_t routeIndexSlots[UCSI_INDEX_CAPACITY(MAX_ROUTES)];
+    bool routeIndexComplete;
+    UCSI_Index_t nodeIndex;
+    uintptr_t nodeIndexKeys[UCSI_INDEX_CAPACITY(MAX_NODES)];
+    uint16_t nodeIndexSlots[UCSI_INDEX_CAPACITY(MAX_NODES)];
+    bool nodeIndexComplete;
+    uint32_t routeBuiltMask[((MAX_ROUTES + 31) / 32)];
+    uint16_t routesBuilt;
+    uint16_t routesToBuild;
+    uint16_t networkUpTime;
+    bool networkAvailable;
+    bool measureRouteBuild;
+    uint16_t scriptStartTime[MAX_NODES];
+    uint32_t scriptRunningMask[((MAX_NODES + 31) / 32)];
+    uint8_t scriptsRunning;
+    UCSI_NodeTimeline_t nodeTimeline[MAX_NODES];
+    uint32_t nodeConfiguredMask[((MAX_NODES + 31) / 32)];
+    uint16_t nodesConfigured;
+    UCSI_TopologyCache_t *topoCache;
+    uint8_t nodeFingerprint[MAX_NODES][UCSI_FINGERPRINT_LEN];
+    UCSI_RetryState_t retry[CMD_MAX_IN_FLIGHT];
+    bool uniTimerArmed;
+    uint16_t uniTimerStart;
+    uint16_t uniTimerLen;
+    UCSI_RecoveryStats_t recoveryStats;
+    UCSI_RecoveryTier_t recoveryTier;
+    bool recoveryRunning;
+    uint16_t recoveryStart;
+    bool generalErrorSeen;
+    uint16_t lastGeneralError;
+    uint16_t routeSuspendTime[MAX_ROUTES];
+    uint32_t routeSuspendedMask[((MAX_ROUTES + 31) / 32)];
+    uint32_t routeRequestedMask[((MAX_ROUTES + 31) / 32)]; /* Last requested active state, queued or not */
     bool printTrigger;
 } UCSI_Data_t;
 
@@ -0,0 +1,264 @@
+/*------------------------------------------------------------------------------------------------*/
+/* UNICENS Integration Helper Component                                                           */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "md5.h"
+#include "ucsi_fingerprint.h"
+
+/************************************************************************/
+/* Private Function Prototypes                                          */
+/************************************************************************/
+
+static void AppendU8(md5_state_t *md5, uint8_t val);
+static void AppendU16(md5_state_t *md5, uint16_t val);
+static void AppendMsg(md5_state_t *md5, const Ucs_Ns_ConfigMsg_t *msg);
+static void AppendEndpoint(md5_state_t *md5, const Ucs_Rm_EndPoint_t *ep);
+static void AppendJob(md5_state_t *md5, Ucs_Xrm_ResObject_t **ppJobList, Ucs_Xrm_ResObject_t *job);
+static void AppendLink(md5_state_t *md5, Ucs_Xrm_ResObject_t **ppJobList, const void *obj);
+
+/************************************************************************/
+/* Public Function Implementations                                      */
+/************************************************************************/
+
+void UCSIFingerprint_Node(const Ucs_Rm_Node_t *pNode, const Ucs_Rm_Route_t *pRoutes, uint16_t routesSize,
+    uint8_t fingerprint[UCSI_FINGERPRINT_LEN])
+{
+    uint16_t i;
+    md5_state_t md5;
+    assert(NULL != pNode);
+    assert(NULL != fingerprint);
+    md5_init(&md5);
+    AppendU8(&md5, pNode->script_list_size);
+    for (i = 0; NULL != pNode->script_list_ptr && i < pNode->script_list_size; i++)
+    {
+        AppendU16(&md5, pNode->script_list_ptr[i].pause);
+        AppendMsg(&md5, pNode->script_list_ptr[i].send_cmd);
+        AppendMsg(&md5, pNode->script_list_ptr[i].exp_result);
+    }
+    for (i = 0; NULL != pRoutes && i < routesSize; i++)
+    {
+        const Ucs_Rm_EndPoint_t *src = pRoutes[i].source_endpoint_ptr;
+        const Ucs_Rm_EndPoint_t *snk = pRoutes[i].sink_endpoint_ptr;
+        bool isSrc = (NULL != src && pNode == src->node_obj_ptr);
+        bool isSnk = (NULL != snk && pNode == snk->node_obj_ptr);
+        if (!isSrc && !isSnk)
+            continue;
+        /* The active flag is left out, UCSI_SetRouteActive() switches it without touching the node */
+        AppendU16(&md5, pRoutes[i].route_id);
+        if (isSrc)
+            AppendEndpoint(&md5, src);
+        if (isSnk)
+            AppendEndpoint(&md5, snk);
+    }
+    md5_finish(&md5, fingerprint);
+}
+
+/************************************************************************/
+/* Private Functions                                                    */
+/************************************************************************/
+
+static void AppendU8(md5_state_t *md5, uint8_t val)
+{
+    md5_append(md5, &val, 1);
+}
+
+static void AppendU16(md5_state_t *md5, uint16_t val)
+{
+    /* Fixed byte order, independent of the structure layout */
+    md5_byte_t b[2];
+    b[0] = (md5_byte_t)(val & 0xFF);
+    b[1] = (md5_byte_t)(val >> 8);
+    md5_append(md5, b, sizeof(b));
+}
+
+static void AppendMsg(md5_state_t *md5, const Ucs_Ns_ConfigMsg_t *msg)
+{
+    if (NULL == msg)
+    {
+        AppendU8(md5, 0);
+        return;
+    }
+    AppendU8(md5, 1);
+    AppendU8(md5, msg->FBlockId);
+    AppendU8(md5, msg->InstId);
+    AppendU16(md5, msg->FunktId);
+    AppendU8(md5, msg->OpCode);
+    AppendU8(md5, msg->DataLen);
+    if (NULL != msg->DataPtr && 0 != msg->DataLen)
+        md5_append(md5, msg->DataPtr, msg->DataLen);
+}
+
+static void AppendEndpoint(md5_state_t *md5, const Ucs_Rm_EndPoint_t *ep)
+{
+    uint16_t i;
+    Ucs_Xrm_ResObject_t **ppJobList = ep->jobs_list_ptr;
+    AppendU8(md5, (uint8_t)ep->endpoint_type);
+    for (i = 0; NULL != ppJobList && NULL != ppJobList[i]; i++)
+        AppendJob(md5, ppJobList, ppJobList[i]);
+    AppendU8(md5, 0xFF);
+}
+
+static void AppendJob(md5_state_t *md5, Ucs_Xrm_ResObject_t **ppJobList, Ucs_Xrm_ResObject_t *job)
+{
+    Ucs_Xrm_ResourceType_t typ = *((Ucs_Xrm_ResourceType_t *)job);
+    AppendU8(md5, (uint8_t)typ);
+    switch(typ)
+    {
+    case UCS_XRM_RC_TYPE_DC_PORT:
+    {
+        Ucs_Xrm_DefaultCreatedPort_t *m = (Ucs_Xrm_DefaultCreatedPort_t *)job;
+        AppendU8(md5, (uint8_t)m->port_type);
+        AppendU8(md5, (uint8_t)m->index);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_NW_SOCKET:
+    {
+        Ucs_Xrm_NetworkSocket_t *m = (Ucs_Xrm_NetworkSocket_t *)job;
+        AppendU16(md5, m->nw_port_handle);
+        AppendU8(md5, (uint8_t)m->direction);
+        AppendU8(md5, (uint8_t)m->data_type);
+        AppendU16(md5, m->bandwidth);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_MLB_PORT:
+    {
+        Ucs_Xrm_MlbPort_t *m = (Ucs_Xrm_MlbPort_t *)job;
+        AppendU8(md5, (uint8_t)m->index);
+        AppendU8(md5, (uint8_t)m->clock_config);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_MLB_SOCKET:
+    {
+        Ucs_Xrm_MlbSocket_t *m = (Ucs_Xrm_MlbSocket_t *)job;
+        AppendLink(md5, ppJobList, m->mlb_port_obj_ptr);
+        AppendU8(md5, (uint8_t)m->direction);
+        AppendU8(md5, (uint8_t)m->data_type);
+        AppendU16(md5, m->bandwidth);
+        AppendU16(md5, m->channel_address);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_USB_PORT:
+    {
+        Ucs_Xrm_UsbPort_t *m = (Ucs_Xrm_UsbPort_t *)job;
+        AppendU8(md5, (uint8_t)m->index);
+        AppendU8(md5, (uint8_t)m->physical_layer);
+        AppendU16(md5, (uint16_t)m->devices_interfaces);
+        AppendU8(md5, (uint8_t)m->streaming_if_ep_out_count);
+        AppendU8(md5, (uint8_t)m->streaming_if_ep_in_count);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_USB_SOCKET:
+    {
+        Ucs_Xrm_UsbSocket_t *m = (Ucs_Xrm_UsbSocket_t *)job;
+        AppendLink(md5, ppJobList, m->usb_port_obj_ptr);
+        AppendU8(md5, (uint8_t)m->direction);
+        AppendU8(md5, (uint8_t)m->data_type);
+        AppendU8(md5, (uint8_t)m->end_point_addr);
+        AppendU16(md5, (uint16_t)m->frames_per_transfer);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_STRM_PORT:
+    {
+        Ucs_Xrm_StrmPort_t *m = (Ucs_Xrm_StrmPort_t *)job;
+        AppendU8(md5, (uint8_t)m->index);
+        AppendU8(md5, (uint8_t)m->clock_config);
+        AppendU8(md5, (uint8_t)m->data_alignment);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_STRM_SOCKET:
+    {
+        Ucs_Xrm_StrmSocket_t *m = (Ucs_Xrm_StrmSocket_t *)job;
+        AppendLink(md5, ppJobList, m->stream_port_obj_ptr);
+        AppendU8(md5, (uint8_t)m->direction);
+        AppendU8(md5, (uint8_t)m->data_type);
+        AppendU16(md5, m->bandwidth);
+        AppendU8(md5, (uint8_t)m->stream_pin_id);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_SYNC_CON:
+    {
+        Ucs_Xrm_SyncCon_t *m = (Ucs_Xrm_SyncCon_t *)job;
+        AppendLink(md5, ppJobList, m->socket_in_obj_ptr);
+        AppendLink(md5, ppJobList, m->socket_out_obj_ptr);
+        AppendU8(md5, (uint8_t)m->mute_mode);
+        AppendU16(md5, m->offset);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_COMBINER:
+    {
+        Ucs_Xrm_Combiner_t *m = (Ucs_Xrm_Combiner_t *)job;
+        AppendLink(md5, ppJobList, m->port_socket_obj_ptr);
+        AppendU16(md5, m->bytes_per_frame);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_SPLITTER:
+    {
+        Ucs_Xrm_Splitter_t *m = (Ucs_Xrm_Splitter_t *)job;
+        AppendLink(md5, ppJobList, m->socket_in_obj_ptr);
+        AppendU16(md5, m->bytes_per_frame);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_AVP_CON:
+    {
+        Ucs_Xrm_AvpCon_t *m = (Ucs_Xrm_AvpCon_t *)job;
+        AppendLink(md5, ppJobList, m->socket_in_obj_ptr);
+        AppendLink(md5, ppJobList, m->socket_out_obj_ptr);
+        AppendU16(md5, m->isoc_packet_size);
+        break;
+    }
+    case UCS_XRM_RC_TYPE_QOS_CON:
+    {
+        Ucs_Xrm_QoSCon_t *m = (Ucs_Xrm_QoSCon_t *)job;
+        AppendLink(md5, ppJobList, m->socket_in_obj_ptr);
+        AppendLink(md5, ppJobList, m->socket_out_obj_ptr);
+        break;
+    }
+    default:
+        assert(false);
+        break;
+    }
+}
+
+static void AppendLink(md5_state_t *md5, Ucs_Xrm_ResObject_t **ppJobList, const void *obj)
+{
+    /* The resource objects link each other by pointers, take the position in the job list instead */
+    uint8_t i;
+    for (i = 0; NULL != ppJobList[i] && 0xFF != i; i++)
+    {
+        if (obj == ppJobList[i])
+            break;
+    }
+    if (NULL == ppJobList[i])
+        i = 0xFF;
+    AppendU8(md5, i);
+}
@@ -0,0 +1,70 @@
+/*------------------------------------------------------------------------------------------------*/
+/* UNICENS Integration Helper Component                                                           */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+#ifndef UCSI_FINGERPRINT_H_
+#define UCSI_FINGERPRINT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ucs_api.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/**
+ * \brief Length of a node fingerprint in bytes (MD5 digest).
+ */
+#define UCSI_FINGERPRINT_LEN (16)
+
+/**
+ * \brief Calculates the fingerprint of the effective configuration of one node.
+ * \note Covers the content of the node script and the structure of all routes ending at the node,
+ *       that is route ID, endpoint direction and all parameters of the XRM job list. Links between
+ *       the resource objects are taken by their position in the job list. Addresses of the configuration
+ *       data are not part of it, so a rebuilt firmware with identical configuration keeps the fingerprint.
+ *       The active flag of the routes is not part of it either, as switching a route does not touch the node.
+ *
+ * \param pNode - the node, as given in the node list
+ * \param pRoutes - the route list of the configuration, may be NULL
+ * \param routesSize - number of routes in the list
+ * \param fingerprint - receives the fingerprint
+ */
+void UCSIFingerprint_Node(const Ucs_Rm_Node_t *pNode, const Ucs_Rm_Route_t *pRoutes, uint16_t routesSize,
+    uint8_t fingerprint[UCSI_FINGERPRINT_LEN]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCSI_FINGERPRINT_H_ */
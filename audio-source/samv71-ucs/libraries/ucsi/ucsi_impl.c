@@ -28,6 +28,7 @@
 /* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
 /*------------------------------------------------------------------------------------------------*/
 #include <assert.h>
+#include <stddef.h>
 #include <stdio.h>
 #include "ucsi_api.h"
 #include "ucsi_collision.h"
@@ -41,6 +42,20 @@
 #define MAGIC (0xA144BEAF)
 #define LOCAL_NODE_ADDR (0x1)
 #define UNKNOWN_NODE_ADDR (0xFFFF)
+#define TOPO_CACHE_MAGIC (0x70C0CAC2)
+#define CACHE_NODE_SEEN (0x01)
+#define CACHE_NODE_SCRIPT_OK (0x02)
+#define RB_WRAP_MARKER (0xFFFF)
+
+/* Header in front of every command record in the queue, len is the record payload without alignment padding.
+ * The pointer member keeps the payload aligned for the pointers inside UnicensCmdEntry_t */
+typedef union
+{
+    uint16_t len;
+    void *align;
+} RB_Hdr_t;
+
+#define RB_ALIGN (sizeof(RB_Hdr_t))
 
 #define LIB_VERSION_MAJOR   (2)
 #define LIB_VERSION_MINOR   (2)
@@ -48,6 +63,7 @@
 #define LIB_VERSION_BUILD   (4073)
 
 static char m_traceBuffer[TRACE_BUFFER_SZ];
+static const char *const m_recoveryName[UCSI_Recovery_Count] = { "Retry", "Route rebuild", "Channel reset", "Full restart" };
 static Ucs_Signature_t PrgSignature = { 0x200 };
 static Ucs_Rm_Node_t PrgNodes[] = {
 {
@@ -71,12 +87,63 @@ static Ucs_Rm_Node_t PrgNodes[] = {
 /* Private Function Prototypes                                          */
 /************************************************************************/
 static bool EnqueueCommand(UCSI_Data_t *my, UnicensCmdEntry_t *cmd);
-static void OnCommandExecuted(UCSI_Data_t *my, UnicensCmd_t cmd, bool success);
-static void RB_Init(RB_t *rb, uint16_t amountOfEntries, uint32_t sizeOfEntry, uint8_t *workingBuffer);
+static bool AppendCommand(UCSI_Data_t *my, UnicensCmdEntry_t *cmd);
+static bool CoalesceCommand(UCSI_Data_t *my, const UnicensCmdEntry_t *cmd);
+static bool MergeI2CWrite(UCSI_Data_t *my, UnicensCmdEntry_t *pending, const UnicensCmdI2CWrite_t *w);
+static UnicensCmdEntry_t *FindPendingRoute(UCSI_Data_t *my, const Ucs_Rm_Route_t *route);
+static void SetRouteRequested(UCSI_Data_t *my, const Ucs_Rm_Route_t *route, bool isActive);
+static bool IsRouteRequested(UCSI_Data_t *my, const Ucs_Rm_Route_t *route);
+static bool FindRouteState(const Ucs_Rm_Route_t *pRoutesList, uint16_t routesListSize, uint16_t routeId, bool *pIsActive);
+static void DispatchCommands(UCSI_Data_t *my);
+static UnicensCmdResult_t StartCommand(UCSI_Data_t *my, UnicensCmdEntry_t *e);
+static bool IsSerializingCmd(UnicensCmd_t cmd);
+static bool IsSerializingInFlight(UCSI_Data_t *my);
+static bool IsNodeBlocked(const uint16_t *pBlocked, uint16_t blockedCnt, uint16_t nodeAddress);
+static uint16_t GetRouteNodeAddress(const Ucs_Rm_Route_t *route);
+static uint16_t GetCmdTarget(const UnicensCmdEntry_t *e);
+static UnicensCmdEntry_t *FindInFlight(UCSI_Data_t *my, UnicensCmd_t cmd, uint16_t nodeAddress);
+static void FailInFlight(UCSI_Data_t *my);
+static bool OnCommandExecuted(UCSI_Data_t *my, UnicensCmd_t cmd, uint16_t nodeAddress, bool success);
+static bool IsRetryableCmd(UnicensCmd_t cmd);
+static bool ScheduleRetry(UCSI_Data_t *my, UnicensCmdEntry_t *e);
+static void StartRetries(UCSI_Data_t *my);
+static void ArmServiceTimer(UCSI_Data_t *my);
+static void RecordRecovery(UCSI_Data_t *my, UCSI_RecoveryTier_t tier, uint16_t downtime);
+static void CheckRecoveryDone(UCSI_Data_t *my);
+static void BuildIndices(UCSI_Data_t *my);
+static Ucs_Rm_Route_t *FindRoute(UCSI_Data_t *my, uint16_t routeId);
+static Ucs_Rm_Node_t *FindNode(UCSI_Data_t *my, uint16_t nodeAddress);
+static int32_t GetRouteSlot(UCSI_Data_t *my, const Ucs_Rm_Route_t *route);
+static void TrackRouteBuild(UCSI_Data_t *my, const Ucs_Rm_Route_t *route, bool isBuilt);
+static void ResetRouteTracking(UCSI_Data_t *my);
+static int32_t GetNodeSlot(UCSI_Data_t *my, uint16_t nodeAddress);
+static void ScriptTimingStart(UCSI_Data_t *my, uint16_t nodeAddress);
+static void ScriptTimingStop(UCSI_Data_t *my, uint16_t nodeAddress, bool success);
+static void ResetNodeTimeline(UCSI_Data_t *my);
+static void OnNodeWelcomed(UCSI_Data_t *my, uint16_t nodeAddress);
+static void OnNodeConfigured(UCSI_Data_t *my, uint16_t nodeAddress, bool isConfigured);
+static void PrintNodeTimeline(UCSI_Data_t *my);
+static uint32_t HashBytes(uint32_t hash, const void *pData, uint32_t len);
+static uint32_t GetConfigId(UCSI_Data_t *my);
+static void CommitCache(UCSI_Data_t *my);
+static void LoadTopologyCache(UCSI_Data_t *my);
+static void VerifyCachedNode(UCSI_Data_t *my, const Ucs_Signature_t *signature);
+static void SetCachedScriptState(UCSI_Data_t *my, uint16_t nodeAddress, bool applied);
+static bool IsNodeScript(UCSI_Data_t *my, uint16_t nodeAddress, const Ucs_Ns_Script_t *pScript);
+static void CacheConnectionLabel(UCSI_Data_t *my, const Ucs_Rm_Route_t *route, uint16_t conLabel);
+static uint16_t GetNodeAddress(const Ucs_Rm_Node_t *pNode);
+static bool IsSameEndpoint(const Ucs_Rm_EndPoint_t *a, const Ucs_Rm_EndPoint_t *b);
+static const char *GetUpdateBlocker(UCSI_Data_t *my, uint16_t packetBw, const Ucs_Rm_Route_t *pRoutesList,
+    uint16_t routesListSize, const Ucs_Rm_Node_t *pNodesList, uint16_t nodesListSize);
+static uint32_t GetCmdSize(const UnicensCmdEntry_t *e);
+static void RB_Init(RB_t *rb, uint32_t size, uint8_t *workingBuffer);
+static uint32_t RB_RecordSize(const RB_Hdr_t *hdr);
+static RB_Hdr_t *RB_GetHdr(RB_t *rb, uint32_t pos);
 static void *RB_GetReadPtr(RB_t *rb);
+static void *RB_GetNextPtr(RB_t *rb, const void *pRecord);
 static void RB_PopReadPtr(RB_t *rb);
-static void *RB_GetWritePtr(RB_t *rb);
-static void RB_PopWritePtr(RB_t *rb);
+static bool RB_Push(RB_t *rb, const void *pData, uint32_t len);
+static uint32_t RB_GetFreeRecords(RB_t *rb, uint32_t len);
 static uint16_t OnUnicensGetTime(void *user_ptr);
 static void OnUnicensService( void *user_ptr );
 static void OnUnicensError( Ucs_Error_t error_code, void *user_ptr );
@@ -170,24 +237,24 @@ void UCSI_Init(UCSI_Data_t *my, void *pTag)
 
     my->uniInitData.gpio.trigger_event_status_fptr = &OnUcsGpioTriggerEventStatus;
 
-    RB_Init(&my->rb, CMD_QUEUE_LEN, sizeof(UnicensCmdEntry_t), my->rbBuf);
+    RB_Init(&my->rb, sizeof(my->rbBuf), (uint8_t *)my->rbBuf);
+    UCSIIndex_Init(&my->routeIndex, my->routeIndexKeys, my->routeIndexSlots, UCSI_INDEX_CAPACITY(MAX_ROUTES));
+    UCSIIndex_Init(&my->nodeIndex, my->nodeIndexKeys, my->nodeIndexSlots, UCSI_INDEX_CAPACITY(MAX_NODES));
     UCSICollision_Init();
     UCSICollision_SetUserPtr(my);
 }
 
 bool UCSI_RunInProgrammingMode(UCSI_Data_t *my, uint8_t amountOfNodes)
 {
-    UnicensCmdEntry_t *e;
+    UnicensCmdEntry_t e;
     assert(MAGIC == my->magic);
     if (NULL == my) return false;
     my->programmingMode  = true;
     UCSICollision_SetExpectedNodeCount(amountOfNodes);
     if (my->initialized)
     {
-        e = (UnicensCmdEntry_t *)RB_GetWritePtr(&my->rb);
-        if (NULL == e) return false;
-        e->cmd = UnicensCmd_Stop;
-        RB_PopWritePtr(&my->rb);
+        e.cmd = UnicensCmd_Stop;
+        if (!AppendCommand(my, &e)) return false;
     }
     my->uniInitData.mgr.packet_bw = 0;
     my->uniInitData.mgr.routes_list_ptr = NULL;
@@ -195,40 +262,37 @@ bool UCSI_RunInProgrammingMode(UCSI_Data_t *my, uint8_t amountOfNodes)
     my->uniInitData.mgr.nodes_list_ptr = PrgNodes;
     my->uniInitData.mgr.nodes_list_size = 1;
     my->uniInitData.mgr.enabled = false;
-    e = (UnicensCmdEntry_t *)RB_GetWritePtr(&my->rb);
-    if (NULL == e) return false;
-    e->cmd =  UnicensCmd_Init;
-    e->val.Init.init_ptr = &my->uniInitData;
-    RB_PopWritePtr(&my->rb);
-    e = (UnicensCmdEntry_t *)RB_GetWritePtr(&my->rb);
-    if (NULL == e) return false;
-    e->cmd =  UnicensCmd_NwStartup;
-    RB_PopWritePtr(&my->rb);
-    e = (UnicensCmdEntry_t *)RB_GetWritePtr(&my->rb);
-    if (NULL == e) return false;
-    e->cmd =  UnicensCmd_ProgInitAll;
-    RB_PopWritePtr(&my->rb);
-    e = (UnicensCmdEntry_t *)RB_GetWritePtr(&my->rb);
-    if (NULL == e) return false;
-    e->cmd =  UnicensCmd_NDStart;
-    RB_PopWritePtr(&my->rb);
+    BuildIndices(my);
+    e.cmd =  UnicensCmd_Init;
+    e.val.Init.init_ptr = &my->uniInitData;
+    if (!AppendCommand(my, &e)) return false;
+    e.cmd =  UnicensCmd_NwStartup;
+    if (!AppendCommand(my, &e)) return false;
+    e.cmd =  UnicensCmd_ProgInitAll;
+    if (!AppendCommand(my, &e)) return false;
+    e.cmd =  UnicensCmd_NDStart;
+    if (!AppendCommand(my, &e)) return false;
     UCSI_CB_OnServiceRequired(my->tag);
     return true;
 }
 
+void UCSI_SetTopologyCache(UCSI_Data_t *my, UCSI_TopologyCache_t *pCache)
+{
+    assert(MAGIC == my->magic);
+    my->topoCache = pCache;
+}
+
 bool UCSI_NewConfig(UCSI_Data_t *my,
     uint16_t packetBw, Ucs_Rm_Route_t *pRoutesList, uint16_t routesListSize,
     Ucs_Rm_Node_t *pNodesList, uint16_t nodesListSize)
 {
-    UnicensCmdEntry_t *e;
+    UnicensCmdEntry_t e;
     assert(MAGIC == my->magic);
     if (NULL == my || my->programmingMode) return false;
     if (my->initialized)
     {
-        e = (UnicensCmdEntry_t *)RB_GetWritePtr(&my->rb);
-        if (NULL == e) return false;
-        e->cmd = UnicensCmd_Stop;
-        RB_PopWritePtr(&my->rb);
+        e.cmd = UnicensCmd_Stop;
+        if (!AppendCommand(my, &e)) return false;
     }
     my->uniInitData.mgr.packet_bw = packetBw;
     my->uniInitData.mgr.routes_list_ptr = pRoutesList;
@@ -236,42 +300,91 @@ bool UCSI_NewConfig(UCSI_Data_t *my,
     my->uniInitData.mgr.nodes_list_ptr = pNodesList;
     my->uniInitData.mgr.nodes_list_size = nodesListSize;
     my->uniInitData.mgr.enabled = true;
-    e = (UnicensCmdEntry_t *)RB_GetWritePtr(&my->rb);
-    if (NULL == e) return false;
-    e->cmd =  UnicensCmd_Init;
-    e->val.Init.init_ptr = &my->uniInitData;
-    RB_PopWritePtr(&my->rb);
+    BuildIndices(my);
+    LoadTopologyCache(my);
+    e.cmd =  UnicensCmd_Init;
+    e.val.Init.init_ptr = &my->uniInitData;
+    if (!AppendCommand(my, &e)) return false;
     UCSI_CB_OnServiceRequired(my->tag);
     UCSIPrint_Init(pRoutesList, routesListSize, my);
     return true;
 }
 
-bool UCSI_ExecuteScript(UCSI_Data_t *my, uint16_t targetAddress, Ucs_Ns_Script_t *pScriptList, uint8_t scriptListLength)
+bool UCSI_UpdateConfig(UCSI_Data_t *my,
+    uint16_t packetBw, Ucs_Rm_Route_t *pRoutesList, uint16_t routesListSize,
+    Ucs_Rm_Node_t *pNodesList, uint16_t nodesListSize)
 {
-    uint8_t i = 0;
-    Ucs_Rm_Node_t *pNode = NULL;
+    uint16_t i;
+    uint16_t kept = 0, activated = 0, deactivated = 0, toBuild = 0, changes = 0;
+    bool isActive;
+    const char *blocker;
+    Ucs_Rm_Route_t *pOld;
     UnicensCmdEntry_t e;
     assert(MAGIC == my->magic);
     if (NULL == my || my->programmingMode) return false;
-    if (!my->initialized || !my->uniInitData.mgr.enabled
-        || NULL == my->uniInitData.mgr.nodes_list_ptr || 0 == my->uniInitData.mgr.nodes_list_size
-        || NULL == pScriptList || 0 == scriptListLength)
+    blocker = GetUpdateBlocker(my, packetBw, pRoutesList, routesListSize, pNodesList, nodesListSize);
+    if (NULL != blocker)
+    {
+        UCSI_CB_OnUserMessage(my->tag, false, "Config update needs a restart, %s", 1, blocker);
+        return UCSI_NewConfig(my, packetBw, pRoutesList, routesListSize, pNodesList, nodesListSize);
+    }
+    pOld = my->uniInitData.mgr.routes_list_ptr;
+    e.cmd = UnicensCmd_RmSetRoute;
+    /* The new list may be the running one with edited active flags, so the current state is taken
+     * from the last request, which also covers requests still waiting in the queue.
+     * Every route ID of the new list is known to be in the running list, see GetUpdateBlocker */
+    for (i = 0; i < my->uniInitData.mgr.routes_list_size; i++)
+    {
+        isActive = false;
+        FindRouteState(pRoutesList, routesListSize, pOld[i].route_id, &isActive);
+        if (isActive != IsRouteRequested(my, &pOld[i]))
+            ++changes;
+    }
+    /* Either the whole update is enqueued or nothing of it. Merged requests would need no space, so this is on the safe side */
+    if (RB_GetFreeRecords(&my->rb, GetCmdSize(&e)) < changes)
     {
+        UCSI_CB_OnUserMessage(my->tag, true, "Config update with %d route changes does not fit into the queue. Increase CMD_QUEUE_SIZE define", 1, changes);
         return false;
     }
-    for (i = 0; i < my->uniInitData.mgr.nodes_list_size; i++)
+    for (i = 0; i < my->uniInitData.mgr.routes_list_size; i++)
     {
-        Ucs_Rm_Node_t *pTempNode = &my->uniInitData.mgr.nodes_list_ptr[i];
-        if (NULL == pTempNode)
-            break;
-        if (pTempNode->signature_ptr && targetAddress == pTempNode->signature_ptr->node_address)
+        isActive = false;
+        if (FindRouteState(pRoutesList, routesListSize, pOld[i].route_id, &isActive))
+            ++kept;
+        if (isActive && i < MAX_ROUTES)
+            ++toBuild;
+        if (isActive == IsRouteRequested(my, &pOld[i]))
+            continue;
+        e.val.RmSetRoute.routePtr = &pOld[i];
+        e.val.RmSetRoute.isActive = isActive;
+        if (!EnqueueCommand(my, &e))
         {
-            /* Found correct node in List */
-            pNode = pTempNode;
-            break;
+            assert(false);
+            return false;
         }
+        if (isActive)
+            ++activated;
+        else
+            ++deactivated;
     }
-    if (NULL == pNode)
+    my->routesToBuild = toBuild;
+    UCSI_CB_OnUserMessage(my->tag, false, "Config update: %d routes kept, %d activated, %d deactivated", 3,
+        kept, activated, deactivated);
+    return true;
+}
+
+bool UCSI_ExecuteScript(UCSI_Data_t *my, uint16_t targetAddress, Ucs_Ns_Script_t *pScriptList, uint8_t scriptListLength)
+{
+    UnicensCmdEntry_t e;
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode) return false;
+    if (!my->initialized || !my->uniInitData.mgr.enabled
+        || NULL == my->uniInitData.mgr.nodes_list_ptr || 0 == my->uniInitData.mgr.nodes_list_size
+        || NULL == pScriptList || 0 == scriptListLength)
+    {
+        return false;
+    }
+    if (NULL == FindNode(my, targetAddress))
         return false;
     e.cmd = UnicensCmd_NsRun;
     e.val.NsRun.nodeAddress = targetAddress;
@@ -301,8 +414,6 @@ bool UCSI_ProcessRxData(UCSI_Data_t *my,
 
 void UCSI_Service(UCSI_Data_t *my)
 {
-    UnicensCmdEntry_t *e;
-    bool popEntry = true; /*Set to false in specific case, where function will callback asynchrony.*/
     assert(MAGIC == my->magic);
     if (NULL != my->unicens && my->triggerService) {
         my->triggerService = false;
@@ -313,502 +424,1513 @@ void UCSI_Service(UCSI_Data_t *my)
         my->printTrigger = false;
         UCSIPrint_Service(UCSI_CB_OnGetTime(my->tag));
     }
-    if (NULL != my->currentCmd) return;
-    my->currentCmd = e = (UnicensCmdEntry_t *)RB_GetReadPtr(&my->rb);
-    if (NULL == e) return;
-    switch (e->cmd) {
-        case UnicensCmd_Init:
-            if (UCS_RET_SUCCESS == Ucs_Init(my->unicens, e->val.Init.init_ptr, OnUcsInitResult))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Init failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_Init, false, LOCAL_NODE_ADDR);
-            }
-            break;
-        case UnicensCmd_Stop:
-            if (UCS_RET_SUCCESS == Ucs_Stop(my->unicens, OnUcsStopResult))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Stop failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_Stop, false, LOCAL_NODE_ADDR);
-            }
-            break;
-        case UnicensCmd_RmSetRoute:
-            if (UCS_RET_SUCCESS == Ucs_Rm_SetRouteActive(my->unicens, e->val.RmSetRoute.routePtr, e->val.RmSetRoute.isActive))
-            {
-                my->pendingRoutePtr = e->val.RmSetRoute.routePtr;
-                popEntry = false;
-            } else  {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Rm_SetRouteActive failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_RmSetRoute, false, e->val.RmSetRoute.routePtr->sink_endpoint_ptr->node_obj_ptr->signature_ptr->node_address);
-            }
-            break;
-        case UnicensCmd_NsRun:
-            if (UCS_RET_SUCCESS != Ucs_Ns_Run(my->unicens, e->val.NsRun.nodeAddress, e->val.NsRun.scriptPtr, e->val.NsRun.scriptSize, OnUcsNsRun))
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Ns_Run failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_NsRun, false, e->val.NsRun.nodeAddress);
-            }
-            break;
-        case UnicensCmd_GpioCreatePort:
-            if (UCS_RET_SUCCESS == Ucs_Gpio_CreatePort(my->unicens, e->val.GpioCreatePort.destination, 0, e->val.GpioCreatePort.debounceTime, OnUcsGpioPortCreate))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Gpio_CreatePort failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_GpioCreatePort, false, e->val.GpioCreatePort.destination);
-            }
-            break;
-        case UnicensCmd_GpioWritePort:
-            if (UCS_RET_SUCCESS == Ucs_Gpio_WritePort(my->unicens, e->val.GpioWritePort.destination, 0x1D00, e->val.GpioWritePort.mask, e->val.GpioWritePort.data, OnUcsGpioPortWrite))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Gpio_WritePort failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_GpioWritePort, false, e->val.GpioWritePort.destination);
-            }
-            break;
-        case UnicensCmd_I2CWrite:
-            if (UCS_RET_SUCCESS == Ucs_I2c_WritePort(my->unicens, e->val.I2CWrite.destination, 0x0F00,
-                (e->val.I2CWrite.isBurst ? UCS_I2C_BURST_MODE : UCS_I2C_DEFAULT_MODE), e->val.I2CWrite.blockCount,
-                e->val.I2CWrite.slaveAddr, e->val.I2CWrite.timeout, e->val.I2CWrite.dataLen, e->val.I2CWrite.data, OnUcsI2CWrite))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_I2c_WritePort failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_I2CWrite, false, e->val.I2CWrite.destination);
-            }
-            break;
-        case UnicensCmd_I2CRead:
-            if (UCS_RET_SUCCESS == Ucs_I2c_ReadPort(my->unicens, e->val.I2CRead.destination, 0x0F00,
-                e->val.I2CRead.slaveAddr, e->val.I2CRead.dataLen, e->val.I2CRead.timeout, OnUcsI2CRead))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_I2c_ReadPort failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_I2CRead, false, e->val.I2CRead.destination);
-            }
-            break;
+    DispatchCommands(my);
+}
+
+void UCSI_Timeout(UCSI_Data_t *my)
+{
+    assert(MAGIC == my->magic);
+    if (NULL == my->unicens) return;
+    /* The service timer is shared between UNICENS and the command retries */
+    if (my->uniTimerArmed && my->uniTimerLen <= (uint16_t)(UCSI_CB_OnGetTime(my->tag) - my->uniTimerStart))
+    {
+        my->uniTimerArmed = false;
+        Ucs_ReportTimeout(my->unicens);
+    }
+    UCSI_CB_OnServiceRequired(my->tag);
+    ArmServiceTimer(my);
+    if (my->printTrigger)
+    {
+        my->printTrigger = false;
+        UCSIPrint_Service(UCSI_CB_OnGetTime(my->tag));
+    }
+}
+
+bool UCSI_SendAmsMessage(UCSI_Data_t *my, uint16_t msgId, uint16_t targetAddress, uint8_t *pPayload, uint32_t payloadLen)
+{
 #if ENABLE_AMS_LIB
-        case UnicensCmd_SendAmsMessage:
-        {
-            Ucs_AmsTx_Msg_t *msg;
-            msg = Ucs_AmsTx_AllocMsg(my->unicens, e->val.SendAms.payloadLen);
-            if (NULL == msg)
-            {
-                /* Try again later */
-                popEntry = false;
-                break;
-            }
-            if (0 != e->val.SendAms.payloadLen)
-            {
-                assert(NULL != msg->data_ptr);
-                memcpy(msg->data_ptr, e->val.SendAms.pPayload, e->val.SendAms.payloadLen);
-            }
-            msg->custom_info_ptr = NULL;
-            msg->data_size = e->val.SendAms.payloadLen;
-            msg->destination_address = e->val.SendAms.targetAddress;
-            msg->llrbc = 10;
-            msg->msg_id = e->val.SendAms.msgId;
-            if (UCS_RET_SUCCESS == Ucs_AmsTx_SendMsg(my->unicens, msg, OnUcsAmsWrite))
-            {
-                popEntry = false;
-            }
-            else
-            {
-                Ucs_AmsTx_FreeUnusedMsg(my->unicens, msg);
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_AmsTx_SendMsg failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_SendAmsMessage, false, e->val.SendAms.targetAddress);
-            }
-            break;
-        }
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode) return false;
+    if (payloadLen > AMS_MSG_MAX_LEN)
+    {
+        UCSI_CB_OnUserMessage(my->tag, true, "SendAms was called with payload length=%d, allowed is=%d", 2, payloadLen, AMS_MSG_MAX_LEN);
+        return false;
+    }
+    entry.cmd = UnicensCmd_SendAmsMessage;
+    entry.val.SendAms.msgId = msgId;
+    entry.val.SendAms.targetAddress = targetAddress;
+    entry.val.SendAms.payloadLen = payloadLen;
+    memcpy(entry.val.SendAms.pPayload, pPayload, payloadLen);
+    return EnqueueCommand(my, &entry);
+#else
+    return false;
 #endif
-        case UnicensCmd_ProgIsRam:
-            if (UCS_RET_SUCCESS == Ucs_Prog_IS_RAM(my->unicens, &e->val.ProgIsRam.signature, &e->val.ProgIsRam.ident_string, OnUcsProgRam))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Prog_IS_RAM failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_ProgIsRam, false, e->val.ProgIsRam.signature.node_address);
-            }
-            break;
-        case UnicensCmd_ProgIsRom:
-            if (UCS_RET_SUCCESS == Ucs_Prog_IS_ROM(my->unicens, &e->val.ProgIsRom.signature, &e->val.ProgIsRom.ident_string, OnUcsProgRom))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Prog_IS_ROM failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_ProgIsRom, false, e->val.ProgIsRom.signature.node_address);
-            }
-            break;
-        case UnicensCmd_NDStart:
-            if (UCS_RET_SUCCESS == Ucs_Nd_Start(my->unicens))
-            {
-                my->ndRunning = true;
-            } else  {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Nd_Start failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_NDStart, false, LOCAL_NODE_ADDR);
-            }
-            break;
-        case UnicensCmd_NDStop:
-            if (UCS_RET_SUCCESS == Ucs_Nd_Stop(my->unicens))
-            {
-                my->ndRunning = false;
-            } else  {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Nd_Stop failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_NDStop, false, LOCAL_NODE_ADDR);
-            }
-            break;
-        case UnicensCmd_NwStartup:
-            if (UCS_RET_SUCCESS == Ucs_Network_Startup(my->unicens, 0, 0xFFFFU, OnUcsNetworkStartup))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Network_Startup failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_NwStartup, false, LOCAL_NODE_ADDR);
-            }
-            break;
-        case UnicensCmd_NwShutdown:
-            if (UCS_RET_SUCCESS == Ucs_Network_Shutdown(my->unicens, OnUcsNetworkShutdown))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Network_Shutdown failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_NwShutdown, false, LOCAL_NODE_ADDR);
-            }
-            break;
-        case UnicensCmd_ProgInitAll:
-            if (UCS_RET_SUCCESS == Ucs_Nd_InitAll(my->unicens))
-            {
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_ProgInitAll, true, LOCAL_NODE_ADDR);
-            } else {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Nd_InitAll failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_ProgInitAll, false, LOCAL_NODE_ADDR);
-            }
-            break;
-        case UnicensCmd_PacketFilterMode:
-            if (UCS_RET_SUCCESS == Ucs_Network_SetPacketFilterMode(my->unicens, e->val.PacketFilterMode.destination_address, e->val.PacketFilterMode.mode, OnUcsPacketFilterMode))
-                popEntry = false;
-            else
-            {
-                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Network_SetPacketFilterMode failed", 0);
-                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_PacketFilterMode, false, e->val.PacketFilterMode.destination_address);
-            }
-            break;
-        default:
-            assert(false);
-            break;
+}
+
+bool UCSI_GetAmsMessage(UCSI_Data_t *my, uint16_t *pMsgId, uint16_t *pSourceAddress, uint8_t **pPayload, uint32_t *pPayloadLen)
+{
+    Ucs_AmsRx_Msg_t *msg;
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode || NULL == my->unicens || NULL == pPayload || NULL == pPayloadLen) return false;
+    msg = Ucs_AmsRx_PeekMsg(my->unicens);
+    if (NULL == msg) return false;
+    *pMsgId = msg->msg_id;
+    *pSourceAddress = msg->source_address;
+    *pPayload = msg->data_ptr;
+    *pPayloadLen = msg->data_size;
+    return true;
+}
+
+void UCSI_ReleaseAmsMessage(UCSI_Data_t *my)
+{
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode || NULL == my->unicens) return;
+    Ucs_AmsRx_ReleaseMsg(my->unicens);
+}
+
+bool UCSI_SetRouteActive(UCSI_Data_t *my, uint16_t routeId, bool isActive)
+{
+    Ucs_Rm_Route_t *route;
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode || NULL == my->uniInitData.mgr.routes_list_ptr) return false;
+    route = FindRoute(my, routeId);
+    if (NULL == route)
+        return false;
+    entry.cmd = UnicensCmd_RmSetRoute;
+    entry.val.RmSetRoute.routePtr = route;
+    entry.val.RmSetRoute.isActive = isActive;
+    return EnqueueCommand(my, &entry);
+}
+
+bool UCSI_I2CWrite(UCSI_Data_t *my, uint16_t targetAddress, bool isBurst, uint8_t blockCount,
+    uint8_t slaveAddr, uint16_t timeout, uint8_t dataLen, const uint8_t *pData)
+{
+    uint8_t blockLen, maxBlocks;
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode || NULL == pData || 0 == dataLen) return false;
+    if (isBurst && (0 == blockCount || 0 != (dataLen % blockCount)))
+    {
+        UCSI_CB_OnUserMessage(my->tag, true, "I2CWrite was called with payload length=%d, not a multiple of blockCount=%d", 2, dataLen, blockCount);
+        return false;
+    }
+    blockLen = isBurst ? (dataLen / blockCount) : dataLen;
+    if (blockLen > I2C_WRITE_MAX_LEN)
+    {
+        UCSI_CB_OnUserMessage(my->tag, true, "I2CWrite was called with payload length=%d, allowed is=%d", 2, blockLen, I2C_WRITE_MAX_LEN);
+        return false;
+    }
+    /* Bursts are split at block boundaries into writes UNICENS can take */
+    maxBlocks = I2C_WRITE_MAX_LEN / blockLen;
+    entry.cmd = UnicensCmd_I2CWrite;
+    entry.val.I2CWrite.destination = targetAddress;
+    entry.val.I2CWrite.isBurst = isBurst;
+    entry.val.I2CWrite.slaveAddr = slaveAddr;
+    entry.val.I2CWrite.timeout = timeout;
+    while (0 != dataLen)
+    {
+        uint8_t blocks = isBurst ? blockCount : 1;
+        if (blocks > maxBlocks)
+            blocks = maxBlocks;
+        entry.val.I2CWrite.blockCount = blocks;
+        entry.val.I2CWrite.dataLen = blocks * blockLen;
+        memcpy(entry.val.I2CWrite.data, pData, entry.val.I2CWrite.dataLen);
+        if (!EnqueueCommand(my, &entry))
+            return false;
+        pData += entry.val.I2CWrite.dataLen;
+        dataLen -= entry.val.I2CWrite.dataLen;
+        blockCount -= blocks;
     }
-    if (popEntry)
+    return true;
+}
+
+bool UCSI_I2CRead(UCSI_Data_t *my, uint16_t targetAddress, uint8_t slaveAddr, uint16_t timeout, uint8_t dataLen)
+{
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode || 0 == dataLen) return false;
+    entry.cmd = UnicensCmd_I2CRead;
+    entry.val.I2CRead.destination = targetAddress;
+    entry.val.I2CRead.slaveAddr = slaveAddr;
+    entry.val.I2CRead.timeout = timeout;
+    entry.val.I2CRead.dataLen = dataLen;
+    return EnqueueCommand(my, &entry);
+}
+
+bool UCSI_SetGpioState(UCSI_Data_t *my, uint16_t targetAddress, uint8_t gpioPinId, bool isHighState)
+{
+    uint16_t mask;
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my || my->programmingMode) return false;
+    mask = 1 << gpioPinId;
+    entry.cmd = UnicensCmd_GpioWritePort;
+    entry.val.GpioWritePort.destination = targetAddress;
+    entry.val.GpioWritePort.mask = mask;
+    entry.val.GpioWritePort.data = isHighState ? mask : 0;
+    return EnqueueCommand(my, &entry);
+}
+
+bool UCSI_ProgramIdentStringRam(UCSI_Data_t *my, const Ucs_Signature_t *signature, const Ucs_IdentString_t *newIdentString)
+{
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my || !my->programmingMode || NULL == signature || NULL == newIdentString) return false;
+    entry.cmd = UnicensCmd_ProgIsRam;
+    memcpy(&entry.val.ProgIsRam.signature, signature, sizeof(Ucs_Signature_t));
+    memcpy(&entry.val.ProgIsRam.ident_string, newIdentString, sizeof(Ucs_IdentString_t));
+    return EnqueueCommand(my, &entry);
+}
+
+bool UCSI_ProgramIdentStringRom(UCSI_Data_t *my, const Ucs_Signature_t *signature, const Ucs_IdentString_t *newIdentString)
+{
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my  || !my->programmingMode || NULL == signature || NULL == newIdentString) return false;
+    entry.cmd = UnicensCmd_ProgIsRom;
+    memcpy(&entry.val.ProgIsRom.signature, signature, sizeof(Ucs_Signature_t));
+    memcpy(&entry.val.ProgIsRom.ident_string, newIdentString, sizeof(Ucs_IdentString_t));
+    return EnqueueCommand(my, &entry);
+}
+
+bool UCSI_EnablePromiscuousMode(UCSI_Data_t *my, uint16_t targetAddress, bool enablePromiscuous)
+{
+    UnicensCmdEntry_t entry;
+    assert(MAGIC == my->magic);
+    if (NULL == my  || my->programmingMode) return false;
+    entry.cmd = UnicensCmd_PacketFilterMode;
+    entry.val.PacketFilterMode.destination_address = targetAddress;
+    entry.val.PacketFilterMode.mode = enablePromiscuous ? 0xA : 0x0;
+    return EnqueueCommand(my, &entry);
+}
+
+void UCSI_GetQueueStats(UCSI_Data_t *my, UCSI_QueueStats_t *pStats)
+{
+    assert(MAGIC == my->magic);
+    if (NULL == my || NULL == pStats) return;
+    memcpy(pStats, &my->queueStats, sizeof(UCSI_QueueStats_t));
+}
+
+void UCSI_GetRecoveryStats(UCSI_Data_t *my, UCSI_RecoveryStats_t *pStats)
+{
+    assert(MAGIC == my->magic);
+    if (NULL == my || NULL == pStats) return;
+    memcpy(pStats, &my->recoveryStats, sizeof(UCSI_RecoveryStats_t));
+}
+
+/************************************************************************/
+/* Private Functions                                                    */
+/************************************************************************/
+
+static bool EnqueueCommand(UCSI_Data_t *my, UnicensCmdEntry_t *cmd)
+{
+    if (NULL == my || NULL == cmd)
+    {
+        assert(false);
+        return false;
+    }
+    if (CoalesceCommand(my, cmd))
+        return true;
+    return AppendCommand(my, cmd);
+}
+
+static bool AppendCommand(UCSI_Data_t *my, UnicensCmdEntry_t *cmd)
+{
+    if (!RB_Push(&my->rb, cmd, GetCmdSize(cmd)))
+    {
+        UCSI_CB_OnUserMessage(my->tag, true, "Could not enqueue command. Increase CMD_QUEUE_SIZE define", 0);
+        return false;
+    }
+    if (UnicensCmd_RmSetRoute == cmd->cmd)
+        SetRouteRequested(my, cmd->val.RmSetRoute.routePtr, cmd->val.RmSetRoute.isActive);
+    my->queueStats.enqueued++;
+    UCSI_CB_OnServiceRequired(my->tag);
+    UCSIPrint_UnicensActivity();
+    return true;
+}
+
+static bool CoalesceCommand(UCSI_Data_t *my, const UnicensCmdEntry_t *cmd)
+{
+    uint16_t target;
+    UnicensCmdEntry_t *e;
+    UnicensCmdEntry_t *last = NULL;
+    if (UnicensCmd_GpioWritePort != cmd->cmd && UnicensCmd_RmSetRoute != cmd->cmd
+        && UnicensCmd_I2CWrite != cmd->cmd)
+        return false;
+    target = GetCmdTarget(cmd);
+    /* Only the latest pending command for the same node may absorb the new one, this keeps the per node order.
+     * Nothing queued before a serializing command may be changed, it must still run before it */
+    for (e = (UnicensCmdEntry_t *)RB_GetReadPtr(&my->rb); NULL != e; e = (UnicensCmdEntry_t *)RB_GetNextPtr(&my->rb, e))
+    {
+        if (IsSerializingCmd(e->cmd))
+            last = NULL;
+        else if (UnicensCmd_Unknown != e->cmd && target == GetCmdTarget(e))
+            last = e;
+    }
+    if (NULL != (e = last))
+    {
+        if (cmd->cmd != e->cmd)
+            return false;
+        if (UnicensCmd_I2CWrite == cmd->cmd)
+            return MergeI2CWrite(my, e, &cmd->val.I2CWrite);
+        if (UnicensCmd_GpioWritePort == cmd->cmd)
+        {
+            /* Same port, last written pin state wins */
+            e->val.GpioWritePort.mask |= cmd->val.GpioWritePort.mask;
+            e->val.GpioWritePort.data = (e->val.GpioWritePort.data & ~cmd->val.GpioWritePort.mask)
+                | (cmd->val.GpioWritePort.data & cmd->val.GpioWritePort.mask);
+            my->queueStats.merged++;
+            return true;
+        }
+        if (cmd->val.RmSetRoute.routePtr != e->val.RmSetRoute.routePtr)
+            return false;
+        /* Last requested state wins. Dropping both on opposite states would lose the request,
+         * whenever the pending one did not change the route anyway */
+        e->val.RmSetRoute.isActive = cmd->val.RmSetRoute.isActive;
+        SetRouteRequested(my, cmd->val.RmSetRoute.routePtr, cmd->val.RmSetRoute.isActive);
+        my->queueStats.merged++;
+        return true;
+    }
+    return false;
+}
+
+static bool MergeI2CWrite(UCSI_Data_t *my, UnicensCmdEntry_t *pending, const UnicensCmdI2CWrite_t *w)
+{
+    UnicensCmdEntry_t merged;
+    const UnicensCmdI2CWrite_t *p = &pending->val.I2CWrite;
+    uint8_t pBlocks = p->isBurst ? p->blockCount : 1;
+    uint8_t wBlocks = w->isBurst ? w->blockCount : 1;
+    /* A burst writes blocks of equal length as separate I2C messages, so only writes with the same length can be joined */
+    if (p->slaveAddr != w->slaveAddr || p->timeout != w->timeout
+        || (p->dataLen / pBlocks) != (w->dataLen / wBlocks)
+        || I2C_WRITE_MAX_LEN < (p->dataLen + w->dataLen) || 0xFF < (pBlocks + wBlocks))
+        return false;
+    /* Queued records only hold dataLen bytes of data, so the members are copied one by one */
+    merged.cmd = UnicensCmd_I2CWrite;
+    merged.val.I2CWrite.destination = p->destination;
+    merged.val.I2CWrite.isBurst = true;
+    merged.val.I2CWrite.blockCount = pBlocks + wBlocks;
+    merged.val.I2CWrite.slaveAddr = p->slaveAddr;
+    merged.val.I2CWrite.timeout = p->timeout;
+    merged.val.I2CWrite.dataLen = p->dataLen + w->dataLen;
+    memcpy(merged.val.I2CWrite.data, p->data, p->dataLen);
+    memcpy(&merged.val.I2CWrite.data[p->dataLen], w->data, w->dataLen);
+    /* The record grows, so it is moved to the end of the queue. No command for this node is queued in between */
+    if (!RB_Push(&my->rb, &merged, GetCmdSize(&merged)))
+        return false;
+    pending->cmd = UnicensCmd_Unknown;
+    my->queueStats.merged++;
+    UCSI_CB_OnServiceRequired(my->tag);
+    return true;
+}
+
+static UnicensCmdEntry_t *FindPendingRoute(UCSI_Data_t *my, const Ucs_Rm_Route_t *route)
+{
+    UnicensCmdEntry_t *e;
+    UnicensCmdEntry_t *last = NULL;
+    for (e = (UnicensCmdEntry_t *)RB_GetReadPtr(&my->rb); NULL != e; e = (UnicensCmdEntry_t *)RB_GetNextPtr(&my->rb, e))
+    {
+        if (UnicensCmd_RmSetRoute == e->cmd && route == e->val.RmSetRoute.routePtr)
+            last = e;
+    }
+    return last;
+}
+
+static void SetRouteRequested(UCSI_Data_t *my, const Ucs_Rm_Route_t *route, bool isActive)
+{
+    uint32_t i;
+    int32_t slot = GetRouteSlot(my, route);
+    if (slot < 0)
+        return;
+    i = (uint32_t)slot;
+    if (isActive)
+        my->routeRequestedMask[i / 32] |= (1u << (i % 32));
+    else
+        my->routeRequestedMask[i / 32] &= ~(1u << (i % 32));
+}
+
+static bool IsRouteRequested(UCSI_Data_t *my, const Ucs_Rm_Route_t *route)
+{
+    UnicensCmdEntry_t *pending;
+    int32_t slot = GetRouteSlot(my, route);
+    if (0 <= slot)
+        return (0 != (my->routeRequestedMask[slot / 32] & (1u << (slot % 32))));
+    /* Not tracked, GetUpdateBlocker makes sure the flags of the running list were not edited in place */
+    pending = FindPendingRoute(my, route);
+    if (NULL != pending)
+        return pending->val.RmSetRoute.isActive;
+    return (0 != route->active);
+}
+
+static bool FindRouteState(const Ucs_Rm_Route_t *pRoutesList, uint16_t routesListSize, uint16_t routeId, bool *pIsActive)
+{
+    uint16_t i;
+    for (i = 0; NULL != pRoutesList && i < routesListSize; i++)
+    {
+        if (routeId == pRoutesList[i].route_id)
+        {
+            *pIsActive = (0 != pRoutesList[i].active);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void DispatchCommands(UCSI_Data_t *my)
+{
+    uint16_t target;
+    uint16_t blockedCnt = 0;
+    uint16_t blocked[MAX_NODES];
+    UnicensCmdEntry_t *e;
+    UnicensCmdEntry_t *slot;
+    UnicensCmdResult_t result;
+    bool serializing;
+    if (NULL == my)
+    {
+        assert(false);
+        return;
+    }
+    StartRetries(my);
+    /* A serializing command owns the whole pipeline until its callback arrives */
+    if (IsSerializingInFlight(my)) return;
+    for (e = (UnicensCmdEntry_t *)RB_GetReadPtr(&my->rb); NULL != e; e = (UnicensCmdEntry_t *)RB_GetNextPtr(&my->rb, e))
+    {
+        if (UnicensCmd_Unknown == e->cmd)
+            continue; /* Already started out of queue order */
+        serializing = IsSerializingCmd(e->cmd);
+        target = GetCmdTarget(e);
+        if (serializing)
+        {
+            /* Nothing may overtake it, and it waits until all earlier commands are done */
+            if (0 != my->inFlightCount || 0 != blockedCnt)
+                break;
+        }
+        else
+        {
+            if (CMD_MAX_IN_FLIGHT <= my->inFlightCount)
+                break;
+            if (IsNodeBlocked(blocked, blockedCnt, target))
+                continue;
+            /* Scripts of different nodes run in parallel, but limited to spare control channel bandwidth.
+             * Scripts run by the manager after a welcome count as well */
+            if (NULL != FindInFlight(my, UnicensCmd_Unknown, target)
+                || (UnicensCmd_NsRun == e->cmd && MAX_CONCURRENT_SCRIPTS <= my->scriptsRunning))
+            {
+                /* Keep per node order, later commands for other nodes may still pass */
+                if (MAX_NODES <= blockedCnt)
+                    break;
+                blocked[blockedCnt++] = target;
+                continue;
+            }
+        }
+        slot = FindInFlight(my, UnicensCmd_Unknown, UNKNOWN_NODE_ADDR);
+        assert(NULL != slot);
+        memcpy(slot, e, GetCmdSize(e));
+        memset(&my->retry[slot - my->inFlight], 0, sizeof(UCSI_RetryState_t));
+        my->inFlightCount++;
+        result = StartCommand(my, slot);
+        if (UniCmdResult_Busy_TryLater == result)
+        {
+            /* UNICENS has locked this API, leave the command queued and retry on the next service */
+            slot->cmd = UnicensCmd_Unknown;
+            my->inFlightCount--;
+            if (serializing || MAX_NODES <= blockedCnt)
+                break;
+            blocked[blockedCnt++] = target;
+            continue;
+        }
+        e->cmd = UnicensCmd_Unknown;
+        if (UniCmdResult_OK_NeedToWaitForCB != result)
+        {
+            slot->cmd = UnicensCmd_Unknown;
+            my->inFlightCount--;
+        }
+        else if (serializing)
+        {
+            break;
+        }
+    }
+    /* Drop started commands from the head of the queue */
+    while (NULL != (e = (UnicensCmdEntry_t *)RB_GetReadPtr(&my->rb)) && UnicensCmd_Unknown == e->cmd)
+        RB_PopReadPtr(&my->rb);
+}
+
+static UnicensCmdResult_t StartCommand(UCSI_Data_t *my, UnicensCmdEntry_t *e)
+{
+    Ucs_Return_t ret;
+    UnicensCmdResult_t result = UniCmdResult_OK_NeedToWaitForCB;
+    switch (e->cmd) {
+        case UnicensCmd_Init:
+            ret = Ucs_Init(my->unicens, e->val.Init.init_ptr, OnUcsInitResult);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Init failed", 0);
+            break;
+        case UnicensCmd_Stop:
+            ret = Ucs_Stop(my->unicens, OnUcsStopResult);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Stop failed", 0);
+            break;
+        case UnicensCmd_RmSetRoute:
+            ret = Ucs_Rm_SetRouteActive(my->unicens, e->val.RmSetRoute.routePtr, e->val.RmSetRoute.isActive);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Rm_SetRouteActive failed", 0);
+            break;
+        case UnicensCmd_NsRun:
+            ret = Ucs_Ns_Run(my->unicens, e->val.NsRun.nodeAddress, e->val.NsRun.scriptPtr, e->val.NsRun.scriptSize, OnUcsNsRun);
+            if (UCS_RET_SUCCESS == ret)
+                ScriptTimingStart(my, e->val.NsRun.nodeAddress);
+            else if (UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Ns_Run failed", 0);
+            break;
+        case UnicensCmd_GpioCreatePort:
+            ret = Ucs_Gpio_CreatePort(my->unicens, e->val.GpioCreatePort.destination, 0, e->val.GpioCreatePort.debounceTime, OnUcsGpioPortCreate);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Gpio_CreatePort failed", 0);
+            break;
+        case UnicensCmd_GpioWritePort:
+            ret = Ucs_Gpio_WritePort(my->unicens, e->val.GpioWritePort.destination, 0x1D00, e->val.GpioWritePort.mask, e->val.GpioWritePort.data, OnUcsGpioPortWrite);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Gpio_WritePort failed", 0);
+            break;
+        case UnicensCmd_I2CWrite:
+            ret = Ucs_I2c_WritePort(my->unicens, e->val.I2CWrite.destination, 0x0F00,
+                (e->val.I2CWrite.isBurst ? UCS_I2C_BURST_MODE : UCS_I2C_DEFAULT_MODE), e->val.I2CWrite.blockCount,
+                e->val.I2CWrite.slaveAddr, e->val.I2CWrite.timeout, e->val.I2CWrite.dataLen, e->val.I2CWrite.data, OnUcsI2CWrite);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_I2c_WritePort failed", 0);
+            break;
+        case UnicensCmd_I2CRead:
+            ret = Ucs_I2c_ReadPort(my->unicens, e->val.I2CRead.destination, 0x0F00,
+                e->val.I2CRead.slaveAddr, e->val.I2CRead.dataLen, e->val.I2CRead.timeout, OnUcsI2CRead);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_I2c_ReadPort failed", 0);
+            break;
+#if ENABLE_AMS_LIB
+        case UnicensCmd_SendAmsMessage:
+        {
+            Ucs_AmsTx_Msg_t *msg;
+            msg = Ucs_AmsTx_AllocMsg(my->unicens, e->val.SendAms.payloadLen);
+            if (NULL == msg)
+            {
+                /* Try again later */
+                ret = UCS_RET_ERR_API_LOCKED;
+                break;
+            }
+            if (0 != e->val.SendAms.payloadLen)
+            {
+                assert(NULL != msg->data_ptr);
+                memcpy(msg->data_ptr, e->val.SendAms.pPayload, e->val.SendAms.payloadLen);
+            }
+            msg->custom_info_ptr = NULL;
+            msg->data_size = e->val.SendAms.payloadLen;
+            msg->destination_address = e->val.SendAms.targetAddress;
+            msg->llrbc = 10;
+            msg->msg_id = e->val.SendAms.msgId;
+            ret = Ucs_AmsTx_SendMsg(my->unicens, msg, OnUcsAmsWrite);
+            if (UCS_RET_SUCCESS != ret)
+            {
+                Ucs_AmsTx_FreeUnusedMsg(my->unicens, msg);
+                if (UCS_RET_ERR_API_LOCKED != ret)
+                    UCSI_CB_OnUserMessage(my->tag, true, "Ucs_AmsTx_SendMsg failed", 0);
+            }
+            break;
+        }
+#endif
+        case UnicensCmd_ProgIsRam:
+            ret = Ucs_Prog_IS_RAM(my->unicens, &e->val.ProgIsRam.signature, &e->val.ProgIsRam.ident_string, OnUcsProgRam);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Prog_IS_RAM failed", 0);
+            break;
+        case UnicensCmd_ProgIsRom:
+            ret = Ucs_Prog_IS_ROM(my->unicens, &e->val.ProgIsRom.signature, &e->val.ProgIsRom.ident_string, OnUcsProgRom);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Prog_IS_ROM failed", 0);
+            break;
+        case UnicensCmd_NDStart:
+            result = UniCmdResult_OK_ProcessFinished;
+            ret = Ucs_Nd_Start(my->unicens);
+            if (UCS_RET_SUCCESS == ret)
+                my->ndRunning = true;
+            else if (UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Nd_Start failed", 0);
+            break;
+        case UnicensCmd_NDStop:
+            result = UniCmdResult_OK_ProcessFinished;
+            ret = Ucs_Nd_Stop(my->unicens);
+            if (UCS_RET_SUCCESS == ret)
+                my->ndRunning = false;
+            else if (UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Nd_Stop failed", 0);
+            break;
+        case UnicensCmd_NwStartup:
+            ret = Ucs_Network_Startup(my->unicens, 0, 0xFFFFU, OnUcsNetworkStartup);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Network_Startup failed", 0);
+            break;
+        case UnicensCmd_NwShutdown:
+            ret = Ucs_Network_Shutdown(my->unicens, OnUcsNetworkShutdown);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Network_Shutdown failed", 0);
+            break;
+        case UnicensCmd_ProgInitAll:
+            result = UniCmdResult_OK_ProcessFinished;
+            ret = Ucs_Nd_InitAll(my->unicens);
+            if (UCS_RET_SUCCESS == ret)
+                UCSI_CB_OnCommandResult(my->tag, UnicensCmd_ProgInitAll, true, LOCAL_NODE_ADDR);
+            else if (UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Nd_InitAll failed", 0);
+            break;
+        case UnicensCmd_PacketFilterMode:
+            ret = Ucs_Network_SetPacketFilterMode(my->unicens, e->val.PacketFilterMode.destination_address, e->val.PacketFilterMode.mode, OnUcsPacketFilterMode);
+            if (UCS_RET_SUCCESS != ret && UCS_RET_ERR_API_LOCKED != ret)
+                UCSI_CB_OnUserMessage(my->tag, true, "Ucs_Network_SetPacketFilterMode failed", 0);
+            break;
+        default:
+            assert(false);
+            return UniCmdResult_ERROR_ProcessFinished;
+    }
+    if (UCS_RET_ERR_API_LOCKED == ret)
+        return UniCmdResult_Busy_TryLater;
+    if (UCS_RET_SUCCESS != ret)
+    {
+        UCSI_CB_OnCommandResult(my->tag, e->cmd, false, GetCmdTarget(e));
+        return UniCmdResult_ERROR_ProcessFinished;
+    }
+    return result;
+}
+
+static bool IsSerializingCmd(UnicensCmd_t cmd)
+{
+    switch (cmd) {
+        case UnicensCmd_Init:
+        case UnicensCmd_Stop:
+        case UnicensCmd_NDStart:
+        case UnicensCmd_NDStop:
+        case UnicensCmd_NwStartup:
+        case UnicensCmd_NwShutdown:
+        case UnicensCmd_ProgIsRam:
+        case UnicensCmd_ProgIsRom:
+        case UnicensCmd_ProgInitAll:
+            /* Affect the whole network or use a single UNICENS resource without node address in the result */
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool IsSerializingInFlight(UCSI_Data_t *my)
+{
+    uint8_t i;
+    for (i = 0; i < CMD_MAX_IN_FLIGHT; i++)
+    {
+        if (UnicensCmd_Unknown != my->inFlight[i].cmd && IsSerializingCmd(my->inFlight[i].cmd))
+            return true;
+    }
+    return false;
+}
+
+static bool IsNodeBlocked(const uint16_t *pBlocked, uint16_t blockedCnt, uint16_t nodeAddress)
+{
+    uint16_t i;
+    for (i = 0; i < blockedCnt; i++)
+    {
+        if (nodeAddress == pBlocked[i])
+            return true;
+    }
+    return false;
+}
+
+static uint16_t GetRouteNodeAddress(const Ucs_Rm_Route_t *route)
+{
+    return route->sink_endpoint_ptr->node_obj_ptr->signature_ptr->node_address;
+}
+
+static uint16_t GetCmdTarget(const UnicensCmdEntry_t *e)
+{
+    switch (e->cmd) {
+        case UnicensCmd_RmSetRoute:
+            return GetRouteNodeAddress(e->val.RmSetRoute.routePtr);
+        case UnicensCmd_NsRun:
+            return e->val.NsRun.nodeAddress;
+        case UnicensCmd_GpioCreatePort:
+            return e->val.GpioCreatePort.destination;
+        case UnicensCmd_GpioWritePort:
+            return e->val.GpioWritePort.destination;
+        case UnicensCmd_I2CWrite:
+            return e->val.I2CWrite.destination;
+        case UnicensCmd_I2CRead:
+            return e->val.I2CRead.destination;
+#if ENABLE_AMS_LIB
+        case UnicensCmd_SendAmsMessage:
+            return e->val.SendAms.targetAddress;
+#endif
+        case UnicensCmd_ProgIsRam:
+            return e->val.ProgIsRam.signature.node_address;
+        case UnicensCmd_ProgIsRom:
+            return e->val.ProgIsRom.signature.node_address;
+        case UnicensCmd_PacketFilterMode:
+            return e->val.PacketFilterMode.destination_address;
+        default:
+            return LOCAL_NODE_ADDR;
+    }
+}
+
+static UnicensCmdEntry_t *FindInFlight(UCSI_Data_t *my, UnicensCmd_t cmd, uint16_t nodeAddress)
+{
+    uint8_t i;
+    UnicensCmdEntry_t *e;
+    for (i = 0; i < CMD_MAX_IN_FLIGHT; i++)
+    {
+        e = &my->inFlight[i];
+        if (UnicensCmd_Unknown == cmd)
+        {
+            /* Free slot, or any command busy with the given node */
+            if (UNKNOWN_NODE_ADDR == nodeAddress && UnicensCmd_Unknown == e->cmd)
+                return e;
+            if (UNKNOWN_NODE_ADDR != nodeAddress && UnicensCmd_Unknown != e->cmd && nodeAddress == GetCmdTarget(e))
+                return e;
+            continue;
+        }
+        /* A command waiting for its retry has no request pending in UNICENS */
+        if (my->retry[i].pending)
+            continue;
+        if (cmd == e->cmd && (UNKNOWN_NODE_ADDR == nodeAddress || nodeAddress == GetCmdTarget(e)))
+            return e;
+    }
+    return NULL;
+}
+
+static void FailInFlight(UCSI_Data_t *my)
+{
+    uint8_t i;
+    UnicensCmdEntry_t *e;
+    for (i = 0; i < CMD_MAX_IN_FLIGHT; i++)
+    {
+        e = &my->inFlight[i];
+        if (UnicensCmd_Unknown == e->cmd)
+            continue;
+        if (UnicensCmd_NsRun == e->cmd)
+            ScriptTimingStop(my, e->val.NsRun.nodeAddress, false);
+        UCSI_CB_OnCommandResult(my->tag, e->cmd, false, GetCmdTarget(e));
+        e->cmd = UnicensCmd_Unknown;
+    }
+    my->inFlightCount = 0;
+}
+
+static bool OnCommandExecuted(UCSI_Data_t *my, UnicensCmd_t cmd, uint16_t nodeAddress, bool success)
+{
+    UnicensCmdEntry_t *e;
+    UCSI_RetryState_t *r;
+    if (NULL == my)
+    {
+        assert(false);
+        return true;
+    }
+    e = FindInFlight(my, cmd, nodeAddress);
+    if (NULL == e)
+    {
+        UCSI_CB_OnUserMessage(my->tag, true, "OnUniCommandExecuted was called, but no "\
+            "matching command is in flight (cmd=0x%X, node=0x%X)", 2, cmd, nodeAddress);
+        return true;
+    }
+    UCSIPrint_UnicensActivity();
+    if (!success && ScheduleRetry(my, e))
+        return false;
+    r = &my->retry[e - my->inFlight];
+    if (0 != r->count && success)
+    {
+        uint16_t downtime = UCSI_CB_OnGetTime(my->tag) - r->failTime;
+        RecordRecovery(my, UCSI_Recovery_Retry, downtime);
+        UCSI_CB_OnUserMessage(my->tag, false, "Node=%X: Command 0x%X recovered by retry %d after %d ms", 4,
+            GetCmdTarget(e), cmd, r->count, downtime);
+    }
+    else if (0 != r->count)
+    {
+        my->recoveryStats.failed[UCSI_Recovery_Retry]++;
+        UCSI_CB_OnUserMessage(my->tag, true, "Node=%X: Command 0x%X still failing after %d retries", 3,
+            GetCmdTarget(e), cmd, r->count);
+    }
+    UCSI_CB_OnCommandResult(my->tag, cmd, success, GetCmdTarget(e));
+    e->cmd = UnicensCmd_Unknown;
+    assert(0 != my->inFlightCount);
+    my->inFlightCount--;
+    return true;
+}
+
+static bool IsRetryableCmd(UnicensCmd_t cmd)
+{
+    /* Commands which leave the same state when sent twice. Routes are retried by UNICENS itself,
+     * AMS has its own retries and the remaining commands act on the whole network */
+    switch (cmd)
+    {
+        case UnicensCmd_NsRun:
+        case UnicensCmd_GpioCreatePort:
+        case UnicensCmd_GpioWritePort:
+        case UnicensCmd_I2CWrite:
+        case UnicensCmd_I2CRead:
+        case UnicensCmd_PacketFilterMode:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool ScheduleRetry(UCSI_Data_t *my, UnicensCmdEntry_t *e)
+{
+    UCSI_RetryState_t *r = &my->retry[e - my->inFlight];
+    uint16_t now = UCSI_CB_OnGetTime(my->tag);
+    if (!IsRetryableCmd(e->cmd) || CMD_MAX_RETRIES <= r->count || !my->initialized)
+        return false;
+    if (0 == r->count)
+        r->failTime = now;
+    ++r->count;
+    r->pending = true;
+    r->retryTime = now;
+    /* The slot stays occupied, so later commands for this node keep their order */
+    UCSI_CB_OnUserMessage(my->tag, false, "Node=%X: Command 0x%X failed, retry %d of %d in %d ms", 5,
+        GetCmdTarget(e), e->cmd, r->count, CMD_MAX_RETRIES, CMD_RETRY_DELAY_MS * r->count);
+    ArmServiceTimer(my);
+    return true;
+}
+
+static void StartRetries(UCSI_Data_t *my)
+{
+    uint8_t i;
+    UnicensCmdResult_t result;
+    UnicensCmdEntry_t *e;
+    UCSI_RetryState_t *r;
+    uint16_t now = UCSI_CB_OnGetTime(my->tag);
+    for (i = 0; i < CMD_MAX_IN_FLIGHT; i++)
+    {
+        e = &my->inFlight[i];
+        r = &my->retry[i];
+        if (UnicensCmd_Unknown == e->cmd || !r->pending)
+            continue;
+        /* Back off a little longer with every retry */
+        if ((uint16_t)(now - r->retryTime) < CMD_RETRY_DELAY_MS * r->count)
+            continue;
+        r->pending = false;
+        result = StartCommand(my, e);
+        if (UniCmdResult_Busy_TryLater == result)
+        {
+            r->pending = true;
+            continue;
+        }
+        if (UniCmdResult_OK_NeedToWaitForCB != result)
+        {
+            my->recoveryStats.failed[UCSI_Recovery_Retry]++;
+            if (UnicensCmd_NsRun == e->cmd)
+            {
+                if (IsNodeScript(my, e->val.NsRun.nodeAddress, e->val.NsRun.scriptPtr))
+                    SetCachedScriptState(my, e->val.NsRun.nodeAddress, false);
+                ScriptTimingStop(my, e->val.NsRun.nodeAddress, false);
+            }
+            e->cmd = UnicensCmd_Unknown;
+            my->inFlightCount--;
+        }
+    }
+}
+
+static void ArmServiceTimer(UCSI_Data_t *my)
+{
+    uint8_t i;
+    uint16_t elapsed;
+    uint32_t next = 0xFFFFFFFF;
+    uint16_t now = UCSI_CB_OnGetTime(my->tag);
+    if (my->uniTimerArmed)
+    {
+        elapsed = now - my->uniTimerStart;
+        next = (elapsed < my->uniTimerLen) ? (my->uniTimerLen - elapsed) : 0;
+    }
+    for (i = 0; i < CMD_MAX_IN_FLIGHT; i++)
+    {
+        uint16_t delay = CMD_RETRY_DELAY_MS * my->retry[i].count;
+        if (UnicensCmd_Unknown == my->inFlight[i].cmd || !my->retry[i].pending)
+            continue;
+        elapsed = now - my->retry[i].retryTime;
+        if (elapsed >= delay)
+            next = 0;
+        else if (delay - elapsed < next)
+            next = delay - elapsed;
+    }
+    if (0xFFFFFFFF == next)
+        UCSI_CB_OnSetServiceTimer(my->tag, 0);
+    else
+        UCSI_CB_OnSetServiceTimer(my->tag, (0 != next) ? next : 1);
+}
+
+static void RecordRecovery(UCSI_Data_t *my, UCSI_RecoveryTier_t tier, uint16_t downtime)
+{
+    my->recoveryStats.count[tier]++;
+    my->recoveryStats.lastDowntime[tier] = downtime;
+    if (my->recoveryStats.maxDowntime[tier] < downtime)
+        my->recoveryStats.maxDowntime[tier] = downtime;
+}
+
+static void CheckRecoveryDone(UCSI_Data_t *my)
+{
+    uint16_t downtime;
+    if (!my->recoveryRunning || !my->networkAvailable || my->routesBuilt < my->routesToBuild)
+        return;
+    downtime = UCSI_CB_OnGetTime(my->tag) - my->recoveryStart;
+    my->recoveryRunning = false;
+    RecordRecovery(my, my->recoveryTier, downtime);
+    UCSI_CB_OnUserMessage(my->tag, false, "%s recovered network and %d routes after %d ms", 3,
+        m_recoveryName[my->recoveryTier], my->routesBuilt, downtime);
+}
+
+static void BuildIndices(UCSI_Data_t *my)
+{
+    uint16_t i;
+    const Ucs_Rm_Route_t *pRoutes = my->uniInitData.mgr.routes_list_ptr;
+    const Ucs_Rm_Node_t *pNodes = my->uniInitData.mgr.nodes_list_ptr;
+    UCSIIndex_Clear(&my->routeIndex);
+    UCSIIndex_Clear(&my->nodeIndex);
+    my->routeIndexComplete = true;
+    my->nodeIndexComplete = true;
+    memset(my->routeBuiltMask, 0, sizeof(my->routeBuiltMask));
+    memset(my->routeSuspendedMask, 0, sizeof(my->routeSuspendedMask));
+    memset(my->routeRequestedMask, 0, sizeof(my->routeRequestedMask));
+    ResetNodeTimeline(my);
+    my->routesBuilt = 0;
+    my->routesToBuild = 0;
+    my->measureRouteBuild = false;
+    /* On duplicated IDs the first list entry wins, like the former linear search did */
+    for (i = 0; NULL != pRoutes && i < my->uniInitData.mgr.routes_list_size; i++)
+    {
+        if (!UCSIIndex_Insert(&my->routeIndex, pRoutes[i].route_id, i))
+            my->routeIndexComplete = false;
+        if (i < MAX_ROUTES && pRoutes[i].active)
+        {
+            my->routeRequestedMask[i / 32] |= (1u << (i % 32));
+            ++my->routesToBuild;
+        }
+    }
+    for (i = 0; NULL != pNodes && i < my->uniInitData.mgr.nodes_list_size; i++)
+    {
+        if (NULL == pNodes[i].signature_ptr)
+            continue;
+        if (!UCSIIndex_Insert(&my->nodeIndex, pNodes[i].signature_ptr->node_address, i))
+            my->nodeIndexComplete = false;
+    }
+    if (!my->routeIndexComplete)
+        UCSI_CB_OnUserMessage(my->tag, false, "Route index full, increase MAX_ROUTES define. Falling back to linear search", 0);
+    if (!my->nodeIndexComplete)
+        UCSI_CB_OnUserMessage(my->tag, false, "Node index full, increase MAX_NODES define. Falling back to linear search", 0);
+}
+
+static Ucs_Rm_Route_t *FindRoute(UCSI_Data_t *my, uint16_t routeId)
+{
+    uint16_t i;
+    Ucs_Rm_Route_t *pRoutes = my->uniInitData.mgr.routes_list_ptr;
+    if (NULL == pRoutes)
+        return NULL;
+    if (UCSIIndex_Find(&my->routeIndex, routeId, &i))
+        return &pRoutes[i];
+    if (my->routeIndexComplete)
+        return NULL;
+    for (i = 0; i < my->uniInitData.mgr.routes_list_size; i++)
+    {
+        if (routeId == pRoutes[i].route_id)
+            return &pRoutes[i];
+    }
+    return NULL;
+}
+
+static Ucs_Rm_Node_t *FindNode(UCSI_Data_t *my, uint16_t nodeAddress)
+{
+    uint16_t i;
+    Ucs_Rm_Node_t *pNodes = my->uniInitData.mgr.nodes_list_ptr;
+    if (NULL == pNodes)
+        return NULL;
+    if (UCSIIndex_Find(&my->nodeIndex, nodeAddress, &i))
+        return &pNodes[i];
+    if (my->nodeIndexComplete)
+        return NULL;
+    for (i = 0; i < my->uniInitData.mgr.nodes_list_size; i++)
+    {
+        if (NULL != pNodes[i].signature_ptr && nodeAddress == pNodes[i].signature_ptr->node_address)
+            return &pNodes[i];
+    }
+    return NULL;
+}
+
+static int32_t GetRouteSlot(UCSI_Data_t *my, const Ucs_Rm_Route_t *route)
+{
+    uint32_t i;
+    if (NULL == my->uniInitData.mgr.routes_list_ptr || route < my->uniInitData.mgr.routes_list_ptr)
+        return -1;
+    i = (uint32_t)(route - my->uniInitData.mgr.routes_list_ptr);
+    if (MAX_ROUTES <= i || my->uniInitData.mgr.routes_list_size <= i)
+        return -1;
+    return (int32_t)i;
+}
+
+static void TrackRouteBuild(UCSI_Data_t *my, const Ucs_Rm_Route_t *route, bool isBuilt)
+{
+    uint32_t i, bit;
+    int32_t slot = GetRouteSlot(my, route);
+    if (slot < 0)
+        return;
+    i = (uint32_t)slot;
+    bit = 1u << (i % 32);
+    if (isBuilt && 0 != (my->routeSuspendedMask[i / 32] & bit))
+    {
+        uint16_t downtime = UCSI_CB_OnGetTime(my->tag) - my->routeSuspendTime[i];
+        my->routeSuspendedMask[i / 32] &= ~bit;
+        RecordRecovery(my, UCSI_Recovery_Route, downtime);
+        UCSI_CB_OnUserMessage(my->tag, false, "Route=%X: Rebuilt %d ms after it was suspended", 2, route->route_id, downtime);
+    }
+    if (isBuilt == (0 != (my->routeBuiltMask[i / 32] & bit)))
+        return;
+    if (isBuilt)
+    {
+        my->routeBuiltMask[i / 32] |= bit;
+        ++my->routesBuilt;
+    }
+    else
+    {
+        my->routeBuiltMask[i / 32] &= ~bit;
+        --my->routesBuilt;
+    }
+    if (my->measureRouteBuild && 0 != my->routesToBuild && my->routesToBuild <= my->routesBuilt)
+    {
+        uint16_t elapsed = UCSI_CB_OnGetTime(my->tag) - my->networkUpTime;
+        my->measureRouteBuild = false;
+        UCSI_CB_OnUserMessage(my->tag, false, "All %d routes built %d ms after network available", 2,
+            my->routesBuilt, elapsed);
+    }
+    CheckRecoveryDone(my);
+}
+
+static void ResetRouteTracking(UCSI_Data_t *my)
+{
+    uint32_t i;
+    /* Suspended routes are rebuilt with all others, the outage is measured by the network recovery */
+    for (i = 0; i < MAX_ROUTES; i++)
+    {
+        if (0 != (my->routeSuspendedMask[i / 32] & (1u << (i % 32))))
+            my->recoveryStats.failed[UCSI_Recovery_Route]++;
+    }
+    memset(my->routeSuspendedMask, 0, sizeof(my->routeSuspendedMask));
+    memset(my->routeBuiltMask, 0, sizeof(my->routeBuiltMask));
+    my->routesBuilt = 0;
+    my->measureRouteBuild = false;
+}
+
+static int32_t GetNodeSlot(UCSI_Data_t *my, uint16_t nodeAddress)
+{
+    uint32_t i;
+    Ucs_Rm_Node_t *pNode = FindNode(my, nodeAddress);
+    if (NULL == pNode)
+        return -1;
+    i = (uint32_t)(pNode - my->uniInitData.mgr.nodes_list_ptr);
+    return (MAX_NODES > i) ? (int32_t)i : -1;
+}
+
+static void ScriptTimingStart(UCSI_Data_t *my, uint16_t nodeAddress)
+{
+    int32_t i = GetNodeSlot(my, nodeAddress);
+    if (0 > i)
+        return;
+    my->scriptStartTime[i] = UCSI_CB_OnGetTime(my->tag);
+    if (0 == (my->scriptRunningMask[i / 32] & (1u << (i % 32))))
+    {
+        my->scriptRunningMask[i / 32] |= (1u << (i % 32));
+        my->scriptsRunning++;
+    }
+}
+
+static void ScriptTimingStop(UCSI_Data_t *my, uint16_t nodeAddress, bool success)
+{
+    uint16_t elapsed;
+    int32_t i = GetNodeSlot(my, nodeAddress);
+    if (0 > i || 0 == (my->scriptRunningMask[i / 32] & (1u << (i % 32))))
+        return;
+    my->scriptRunningMask[i / 32] &= ~(1u << (i % 32));
+    my->scriptsRunning--;
+    elapsed = UCSI_CB_OnGetTime(my->tag) - my->scriptStartTime[i];
+    my->nodeTimeline[i].scriptTime += elapsed;
+    UCSI_CB_OnUserMessage(my->tag, !success, "Node=%X: Script %s after %d ms", 3, nodeAddress,
+        (success ? "finished" : "failed"), elapsed);
+    /* A script started by UCSI_ExecuteScript may free the way for the next one */
+    UCSI_CB_OnServiceRequired(my->tag);
+}
+
+static void ResetNodeTimeline(UCSI_Data_t *my)
+{
+    memset(my->nodeTimeline, 0, sizeof(my->nodeTimeline));
+    memset(my->nodeConfiguredMask, 0, sizeof(my->nodeConfiguredMask));
+    memset(my->scriptRunningMask, 0, sizeof(my->scriptRunningMask));
+    my->scriptsRunning = 0;
+    my->nodesConfigured = 0;
+}
+
+static void OnNodeWelcomed(UCSI_Data_t *my, uint16_t nodeAddress)
+{
+    int32_t i = GetNodeSlot(my, nodeAddress);
+    if (0 > i)
+        return;
+    my->nodeTimeline[i].welcomed = UCSI_CB_OnGetTime(my->tag) - my->networkUpTime;
+    my->nodeTimeline[i].scriptTime = 0;
+}
+
+static void OnNodeConfigured(UCSI_Data_t *my, uint16_t nodeAddress, bool isConfigured)
+{
+    int32_t i = GetNodeSlot(my, nodeAddress);
+    if (0 > i || isConfigured == (0 != (my->nodeConfiguredMask[i / 32] & (1u << (i % 32)))))
+        return;
+    if (!isConfigured)
     {
-        my->currentCmd = NULL;
-        RB_PopReadPtr(&my->rb);
+        my->nodeConfiguredMask[i / 32] &= ~(1u << (i % 32));
+        my->nodesConfigured--;
+        return;
     }
+    my->nodeConfiguredMask[i / 32] |= (1u << (i % 32));
+    my->nodesConfigured++;
+    my->nodeTimeline[i].configured = UCSI_CB_OnGetTime(my->tag) - my->networkUpTime;
+    if (my->nodesConfigured == my->uniInitData.mgr.nodes_list_size)
+        PrintNodeTimeline(my);
 }
 
-void UCSI_Timeout(UCSI_Data_t *my)
+static void PrintNodeTimeline(UCSI_Data_t *my)
 {
-    assert(MAGIC == my->magic);
-    if (NULL == my->unicens) return;
-    Ucs_ReportTimeout(my->unicens);
-    if (my->printTrigger)
+    uint16_t i;
+    UCSI_CB_OnUserMessage(my->tag, false, "Node timeline, %d nodes configured (ms after network available):", 1, my->nodesConfigured);
+    for (i = 0; i < my->uniInitData.mgr.nodes_list_size && i < MAX_NODES; i++)
     {
-        my->printTrigger = false;
-        UCSIPrint_Service(UCSI_CB_OnGetTime(my->tag));
+        const UCSI_NodeTimeline_t *t = &my->nodeTimeline[i];
+        if (0 == (my->nodeConfiguredMask[i / 32] & (1u << (i % 32))))
+            continue;
+        UCSI_CB_OnUserMessage(my->tag, false, "  Node=%X welcomed=%5d script=%5d configured=%5d", 4,
+            my->uniInitData.mgr.nodes_list_ptr[i].signature_ptr->node_address, t->welcomed, t->scriptTime, t->configured);
     }
 }
 
-bool UCSI_SendAmsMessage(UCSI_Data_t *my, uint16_t msgId, uint16_t targetAddress, uint8_t *pPayload, uint32_t payloadLen)
+static uint32_t HashBytes(uint32_t hash, const void *pData, uint32_t len)
 {
-#if ENABLE_AMS_LIB
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my || my->programmingMode) return false;
-    if (payloadLen > AMS_MSG_MAX_LEN)
+    /* FNV-1a, only used to detect changes, not for security */
+    const uint8_t *p = (const uint8_t *)pData;
+    while (0 != len--)
     {
-        UCSI_CB_OnUserMessage(my->tag, true, "SendAms was called with payload length=%d, allowed is=%d", 2, payloadLen, AMS_MSG_MAX_LEN);
-        return false;
+        hash ^= *p++;
+        hash *= 16777619u;
     }
-    entry.cmd = UnicensCmd_SendAmsMessage;
-    entry.val.SendAms.msgId = msgId;
-    entry.val.SendAms.targetAddress = targetAddress;
-    entry.val.SendAms.payloadLen = payloadLen;
-    memcpy(entry.val.SendAms.pPayload, pPayload, payloadLen);
-    return EnqueueCommand(my, &entry);
-#else
-    return false;
-#endif
+    return hash;
 }
 
-bool UCSI_GetAmsMessage(UCSI_Data_t *my, uint16_t *pMsgId, uint16_t *pSourceAddress, uint8_t **pPayload, uint32_t *pPayloadLen)
+static uint32_t GetConfigId(UCSI_Data_t *my)
 {
-    Ucs_AmsRx_Msg_t *msg;
-    assert(MAGIC == my->magic);
-    if (NULL == my || my->programmingMode || NULL == my->unicens || NULL == pPayload || NULL == pPayloadLen) return false;
-    msg = Ucs_AmsRx_PeekMsg(my->unicens);
-    if (NULL == msg) return false;
-    *pMsgId = msg->msg_id;
-    *pSourceAddress = msg->source_address;
-    *pPayload = msg->data_ptr;
-    *pPayloadLen = msg->data_size;
-    return true;
+    uint16_t i;
+    uint32_t hash = 2166136261u;
+    const Ucs_Rm_Node_t *pNodes = my->uniInitData.mgr.nodes_list_ptr;
+    const Ucs_Rm_Route_t *pRoutes = my->uniInitData.mgr.routes_list_ptr;
+    for (i = 0; NULL != pNodes && i < my->uniInitData.mgr.nodes_list_size; i++)
+    {
+        /* Only the layout of the lists, changed node content is detected by the node fingerprints */
+        uint16_t nodeAddress = (NULL != pNodes[i].signature_ptr) ? pNodes[i].signature_ptr->node_address : 0;
+        hash = HashBytes(hash, &nodeAddress, sizeof(nodeAddress));
+    }
+    for (i = 0; NULL != pRoutes && i < my->uniInitData.mgr.routes_list_size; i++)
+        hash = HashBytes(hash, &pRoutes[i].route_id, sizeof(pRoutes[i].route_id));
+    return hash;
 }
 
-void UCSI_ReleaseAmsMessage(UCSI_Data_t *my)
+static void CommitCache(UCSI_Data_t *my)
 {
-    assert(MAGIC == my->magic);
-    if (NULL == my || my->programmingMode || NULL == my->unicens) return;
-    Ucs_AmsRx_ReleaseMsg(my->unicens);
+    UCSI_TopologyCache_t *c = my->topoCache;
+    if (NULL == c)
+        return;
+    c->checksum = HashBytes(2166136261u, c, offsetof(UCSI_TopologyCache_t, checksum));
 }
 
-bool UCSI_SetRouteActive(UCSI_Data_t *my, uint16_t routeId, bool isActive)
+static void LoadTopologyCache(UCSI_Data_t *my)
 {
     uint16_t i;
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my || my->programmingMode || NULL == my->uniInitData.mgr.routes_list_ptr) return false;
-    for (i = 0; i < my->uniInitData.mgr.routes_list_size; i++)
+    uint16_t unchanged = 0;
+    UCSI_TopologyCache_t *c = my->topoCache;
+    Ucs_Rm_Node_t *pNodes = my->uniInitData.mgr.nodes_list_ptr;
+    uint32_t configId;
+    if (NULL == c)
+        return;
+    for (i = 0; i < my->uniInitData.mgr.nodes_list_size && i < MAX_NODES; i++)
     {
-        Ucs_Rm_Route_t *route = &my->uniInitData.mgr.routes_list_ptr[i];
-        if (route->route_id != routeId)
+        UCSIFingerprint_Node(&pNodes[i], my->uniInitData.mgr.routes_list_ptr, my->uniInitData.mgr.routes_list_size,
+            my->nodeFingerprint[i]);
+    }
+    configId = GetConfigId(my);
+    if (TOPO_CACHE_MAGIC != c->magic
+        || HashBytes(2166136261u, c, offsetof(UCSI_TopologyCache_t, checksum)) != c->checksum
+        || configId != c->configId
+        || my->uniInitData.mgr.nodes_list_size != c->nodeCount
+        || my->uniInitData.mgr.routes_list_size != c->routeCount)
+    {
+        memset(c, 0, sizeof(UCSI_TopologyCache_t));
+        c->magic = TOPO_CACHE_MAGIC;
+        c->configId = configId;
+        c->nodeCount = my->uniInitData.mgr.nodes_list_size;
+        c->routeCount = my->uniInitData.mgr.routes_list_size;
+        CommitCache(my);
+        UCSI_CB_OnUserMessage(my->tag, false, "Topology cache empty or outdated, cold start", 0);
+        return;
+    }
+    c->warmStarts++;
+    for (i = 0; i < my->uniInitData.mgr.nodes_list_size && i < MAX_NODES; i++)
+    {
+        if (0 == (c->node[i].flags & CACHE_NODE_SCRIPT_OK) || NULL == pNodes[i].signature_ptr)
             continue;
-        entry.cmd = UnicensCmd_RmSetRoute;
-        entry.val.RmSetRoute.routePtr = route;
-        entry.val.RmSetRoute.isActive = isActive;
-        return EnqueueCommand(my, &entry);
+        if (0 != memcmp(c->node[i].fingerprint, my->nodeFingerprint[i], UCSI_FINGERPRINT_LEN))
+        {
+            c->node[i].flags &= ~CACHE_NODE_SCRIPT_OK;
+            UCSI_CB_OnUserMessage(my->tag, false, "Node=%X: Configuration changed since last start", 1,
+                pNodes[i].signature_ptr->node_address);
+            continue;
+        }
+        unchanged++;
     }
-    return false;
+    CommitCache(my);
+    UCSI_CB_OnUserMessage(my->tag, false, "Warm start %d, %d node configurations unchanged since last start", 2,
+        c->warmStarts, unchanged);
 }
 
-bool UCSI_I2CWrite(UCSI_Data_t *my, uint16_t targetAddress, bool isBurst, uint8_t blockCount,
-    uint8_t slaveAddr, uint16_t timeout, uint8_t dataLen, const uint8_t *pData)
+static void VerifyCachedNode(UCSI_Data_t *my, const Ucs_Signature_t *signature)
 {
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my || my->programmingMode || NULL == pData || 0 == dataLen) return false;
-    if (dataLen > I2C_WRITE_MAX_LEN)
+    UCSI_CachedNode_t *c;
+    bool same;
+    int32_t i = GetNodeSlot(my, signature->node_address);
+    if (NULL == my->topoCache || 0 > i)
+        return;
+    c = &my->topoCache->node[i];
+    same = (0 != (c->flags & CACHE_NODE_SEEN))
+        && c->posAddr == signature->node_pos_addr
+        && c->mac[0] == signature->mac_47_32
+        && c->mac[1] == signature->mac_31_16
+        && c->mac[2] == signature->mac_15_0
+        && c->fwVersion[0] == signature->fw_major
+        && c->fwVersion[1] == signature->fw_minor
+        && c->fwVersion[2] == signature->fw_release
+        && c->fwBuild == signature->fw_build;
+    /* The signature does not tell, if the node was reset and lost its I2C and codec setup, so the manager runs its script anyway */
+    if (same && 0 != (c->flags & CACHE_NODE_SCRIPT_OK))
+        UCSI_CB_OnUserMessage(my->tag, false, "Node=%X: Unchanged since last start", 1, signature->node_address);
+    else if (!same && 0 != (c->flags & CACHE_NODE_SEEN))
+        UCSI_CB_OnUserMessage(my->tag, false, "Node=%X: Changed since last start", 1, signature->node_address);
+    if (!same)
     {
-        UCSI_CB_OnUserMessage(my->tag, true, "I2CWrite was called with payload length=%d, allowed is=%d", 2, dataLen, I2C_WRITE_MAX_LEN);
-        return false;
+        memset(c, 0, sizeof(UCSI_CachedNode_t));
+        c->posAddr = signature->node_pos_addr;
+        c->mac[0] = signature->mac_47_32;
+        c->mac[1] = signature->mac_31_16;
+        c->mac[2] = signature->mac_15_0;
+        c->fwVersion[0] = signature->fw_major;
+        c->fwVersion[1] = signature->fw_minor;
+        c->fwVersion[2] = signature->fw_release;
+        c->fwBuild = signature->fw_build;
+        c->flags = CACHE_NODE_SEEN;
     }
-    entry.cmd = UnicensCmd_I2CWrite;
-    entry.val.I2CWrite.destination = targetAddress;
-    entry.val.I2CWrite.isBurst = isBurst;
-    entry.val.I2CWrite.blockCount = blockCount;
-    entry.val.I2CWrite.slaveAddr = slaveAddr;
-    entry.val.I2CWrite.timeout = timeout;
-    entry.val.I2CWrite.dataLen = dataLen;
-    memcpy(entry.val.I2CWrite.data, pData, dataLen);
-    return EnqueueCommand(my, &entry);
-}
-
-bool UCSI_I2CRead(UCSI_Data_t *my, uint16_t targetAddress, uint8_t slaveAddr, uint16_t timeout, uint8_t dataLen)
-{
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my || my->programmingMode || 0 == dataLen) return false;
-    entry.cmd = UnicensCmd_I2CRead;
-    entry.val.I2CRead.destination = targetAddress;
-    entry.val.I2CRead.slaveAddr = slaveAddr;
-    entry.val.I2CRead.timeout = timeout;
-    entry.val.I2CRead.dataLen = dataLen;
-    return EnqueueCommand(my, &entry);
+    CommitCache(my);
 }
 
-bool UCSI_SetGpioState(UCSI_Data_t *my, uint16_t targetAddress, uint8_t gpioPinId, bool isHighState)
+static void SetCachedScriptState(UCSI_Data_t *my, uint16_t nodeAddress, bool applied)
 {
-    uint16_t mask;
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my || my->programmingMode) return false;
-    mask = 1 << gpioPinId;
-    entry.cmd = UnicensCmd_GpioWritePort;
-    entry.val.GpioWritePort.destination = targetAddress;
-    entry.val.GpioWritePort.mask = mask;
-    entry.val.GpioWritePort.data = isHighState ? mask : 0;
-    return EnqueueCommand(my, &entry);
+    UCSI_CachedNode_t *c;
+    int32_t i = GetNodeSlot(my, nodeAddress);
+    if (NULL == my->topoCache || 0 > i)
+        return;
+    c = &my->topoCache->node[i];
+    if (!applied && 0 == (c->flags & CACHE_NODE_SCRIPT_OK))
+        return;
+    if (applied)
+    {
+        c->flags |= CACHE_NODE_SCRIPT_OK;
+        memcpy(c->fingerprint, my->nodeFingerprint[i], UCSI_FINGERPRINT_LEN);
+    }
+    else
+        c->flags &= ~CACHE_NODE_SCRIPT_OK;
+    CommitCache(my);
 }
 
-bool UCSI_ProgramIdentStringRam(UCSI_Data_t *my, const Ucs_Signature_t *signature, const Ucs_IdentString_t *newIdentString)
+static bool IsNodeScript(UCSI_Data_t *my, uint16_t nodeAddress, const Ucs_Ns_Script_t *pScript)
 {
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my || !my->programmingMode || NULL == signature || NULL == newIdentString) return false;
-    entry.cmd = UnicensCmd_ProgIsRam;
-    memcpy(&entry.val.ProgIsRam.signature, signature, sizeof(Ucs_Signature_t));
-    memcpy(&entry.val.ProgIsRam.ident_string, newIdentString, sizeof(Ucs_IdentString_t));
-    return EnqueueCommand(my, &entry);
+    int32_t i = GetNodeSlot(my, nodeAddress);
+    if (0 > i || NULL == pScript)
+        return false;
+    return (pScript == my->uniInitData.mgr.nodes_list_ptr[i].script_list_ptr);
 }
 
-bool UCSI_ProgramIdentStringRom(UCSI_Data_t *my, const Ucs_Signature_t *signature, const Ucs_IdentString_t *newIdentString)
+static void CacheConnectionLabel(UCSI_Data_t *my, const Ucs_Rm_Route_t *route, uint16_t conLabel)
 {
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my  || !my->programmingMode || NULL == signature || NULL == newIdentString) return false;
-    entry.cmd = UnicensCmd_ProgIsRom;
-    memcpy(&entry.val.ProgIsRom.signature, signature, sizeof(Ucs_Signature_t));
-    memcpy(&entry.val.ProgIsRom.ident_string, newIdentString, sizeof(Ucs_IdentString_t));
-    return EnqueueCommand(my, &entry);
+    uint32_t i;
+    uint16_t *cached;
+    if (NULL == my->topoCache || NULL == my->uniInitData.mgr.routes_list_ptr
+        || route < my->uniInitData.mgr.routes_list_ptr)
+    {
+        return;
+    }
+    i = (uint32_t)(route - my->uniInitData.mgr.routes_list_ptr);
+    if (MAX_ROUTES <= i || my->uniInitData.mgr.routes_list_size <= i)
+        return;
+    cached = &my->topoCache->conLabel[i];
+    if (conLabel == *cached)
+        return;
+    if (0 != *cached)
+        UCSI_CB_OnUserMessage(my->tag, false, "Route=%X: Connection label %X differs from last start (%X)", 3,
+            route->route_id, conLabel, *cached);
+    *cached = conLabel;
+    CommitCache(my);
 }
 
-bool UCSI_EnablePromiscuousMode(UCSI_Data_t *my, uint16_t targetAddress, bool enablePromiscuous)
+static uint16_t GetNodeAddress(const Ucs_Rm_Node_t *pNode)
 {
-    UnicensCmdEntry_t entry;
-    assert(MAGIC == my->magic);
-    if (NULL == my  || my->programmingMode) return false;
-    entry.cmd = UnicensCmd_PacketFilterMode;
-    entry.val.PacketFilterMode.destination_address = targetAddress;
-    entry.val.PacketFilterMode.mode = enablePromiscuous ? 0xA : 0x0;
-    return EnqueueCommand(my, &entry);
+    if (NULL == pNode || NULL == pNode->signature_ptr)
+        return UNKNOWN_NODE_ADDR;
+    return pNode->signature_ptr->node_address;
 }
 
-/************************************************************************/
-/* Private Functions                                                    */
-/************************************************************************/
-
-static bool EnqueueCommand(UCSI_Data_t *my, UnicensCmdEntry_t *cmd)
+static bool IsSameEndpoint(const Ucs_Rm_EndPoint_t *a, const Ucs_Rm_EndPoint_t *b)
 {
-    UnicensCmdEntry_t *e;
-    if (NULL == my || NULL == cmd)
+    uint16_t i;
+    if (a == b)
+        return true;
+    if (NULL == a || NULL == b || a->endpoint_type != b->endpoint_type
+        || GetNodeAddress(a->node_obj_ptr) != GetNodeAddress(b->node_obj_ptr))
     {
-        assert(false);
         return false;
     }
-    e = RB_GetWritePtr(&my->rb);
-    if (NULL == e)
-    {
-        UCSI_CB_OnUserMessage(my->tag, true, "Could not enqueue command. Increase CMD_QUEUE_LEN define", 0);
+    if (a->jobs_list_ptr == b->jobs_list_ptr)
+        return true;
+    if (NULL == a->jobs_list_ptr || NULL == b->jobs_list_ptr)
         return false;
+    /* UNICENS keeps the state in the resource objects, so they must be the very same objects */
+    for (i = 0; NULL != a->jobs_list_ptr[i]; i++)
+    {
+        if (a->jobs_list_ptr[i] != b->jobs_list_ptr[i])
+            return false;
     }
-    memcpy(e, cmd, sizeof(UnicensCmdEntry_t));
-    RB_PopWritePtr(&my->rb);
-    UCSI_CB_OnServiceRequired(my->tag);
-    UCSIPrint_UnicensActivity();
-    return true;
+    return (NULL == b->jobs_list_ptr[i]);
 }
 
-static void OnCommandExecuted(UCSI_Data_t *my, UnicensCmd_t cmd, bool success)
+static const char *GetUpdateBlocker(UCSI_Data_t *my, uint16_t packetBw, const Ucs_Rm_Route_t *pRoutesList,
+    uint16_t routesListSize, const Ucs_Rm_Node_t *pNodesList, uint16_t nodesListSize)
 {
-    UnicensCmdEntry_t *e;
-    if (NULL == my)
-    {
-        assert(false);
-        return;
-    }
-    e = my->currentCmd;
-    if (NULL == e)
+    uint16_t i;
+    uint8_t fpOld[UCSI_FINGERPRINT_LEN];
+    uint8_t fpNew[UCSI_FINGERPRINT_LEN];
+    if (!my->initialized || !my->uniInitData.mgr.enabled || NULL == my->uniInitData.mgr.routes_list_ptr)
+        return "not running";
+    if (packetBw != my->uniInitData.mgr.packet_bw)
+        return "packet bandwidth changed";
+    if (nodesListSize != my->uniInitData.mgr.nodes_list_size || (0 != nodesListSize && NULL == pNodesList))
+        return "node list changed";
+    for (i = 0; i < nodesListSize; i++)
     {
-        UCSI_CB_OnUserMessage(my->tag, true, "OnUniCommandExecuted was called, but no "\
-            "command is in queue", 0);
-        assert(false);
-        return;
+        const Ucs_Rm_Node_t *pOld = FindNode(my, GetNodeAddress(&pNodesList[i]));
+        if (NULL == pOld)
+            return "node list changed";
+        UCSIFingerprint_Node(pOld, NULL, 0, fpOld);
+        UCSIFingerprint_Node(&pNodesList[i], NULL, 0, fpNew);
+        if (0 != memcmp(fpOld, fpNew, UCSI_FINGERPRINT_LEN))
+            return "node script changed";
     }
-    if (e->cmd != cmd)
+    if (0 != routesListSize && NULL == pRoutesList)
+        return "route list invalid";
+    /* Edited in place, the old state of routes without a tracking slot is lost */
+    if (pRoutesList == my->uniInitData.mgr.routes_list_ptr && MAX_ROUTES < my->uniInitData.mgr.routes_list_size)
+        return "running route list edited, increase MAX_ROUTES define";
+    for (i = 0; i < routesListSize; i++)
     {
-        UCSI_CB_OnUserMessage(my->tag, true, "OnUniCommandExecuted was called with "\
-            "wrong command (Expected=0x%X, Got=0x%X", 2, e->cmd, cmd);
-        assert(false);
-        return;
+        const Ucs_Rm_Route_t *pOld = FindRoute(my, pRoutesList[i].route_id);
+        if (NULL == pOld)
+            return "new route";
+        if (!IsSameEndpoint(pOld->source_endpoint_ptr, pRoutesList[i].source_endpoint_ptr)
+            || !IsSameEndpoint(pOld->sink_endpoint_ptr, pRoutesList[i].sink_endpoint_ptr))
+        {
+            return "route endpoints changed";
+        }
     }
-    UCSIPrint_UnicensActivity();
+    return NULL;
+}
+
+static uint32_t GetCmdSize(const UnicensCmdEntry_t *e)
+{
+    uint32_t hdr = offsetof(UnicensCmdEntry_t, val);
     switch (e->cmd) {
         case UnicensCmd_Init:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, LOCAL_NODE_ADDR);
-            break;
-        case UnicensCmd_Stop:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, LOCAL_NODE_ADDR);
-            break;
+            return hdr + sizeof(UnicensCmdInit_t);
+        case UnicensCmd_RmSetRoute:
+            return hdr + sizeof(UnicensCmdRmSetRoute_t);
+        case UnicensCmd_NsRun:
+            return hdr + sizeof(UnicensCmdNsRun_t);
         case UnicensCmd_GpioCreatePort:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.GpioCreatePort.destination);
-            break;
+            return hdr + sizeof(UnicensCmdGpioCreatePort_t);
         case UnicensCmd_GpioWritePort:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.GpioWritePort.destination);
-            break;
+            return hdr + sizeof(UnicensCmdGpioWritePort_t);
         case UnicensCmd_I2CWrite:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.I2CWrite.destination);
-            break;
+            return hdr + offsetof(UnicensCmdI2CWrite_t, data) + e->val.I2CWrite.dataLen;
         case UnicensCmd_I2CRead:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.I2CRead.destination);
-            break;
+            return hdr + sizeof(UnicensCmdI2CRead_t);
 #if ENABLE_AMS_LIB
         case UnicensCmd_SendAmsMessage:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.SendAms.targetAddress);
-            break;
+            return hdr + offsetof(UnicensCmdSendAmsMessage_t, pPayload) + e->val.SendAms.payloadLen;
 #endif
         case UnicensCmd_ProgIsRam:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.ProgIsRam.signature.node_address);
-            break;
+            return hdr + sizeof(UnicensCmdProgIsRam_t);
         case UnicensCmd_ProgIsRom:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.ProgIsRom.signature.node_address);
-            break;
+            return hdr + sizeof(UnicensCmdProgIsRom_t);
         case UnicensCmd_PacketFilterMode:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.PacketFilterMode.destination_address);
-            break;
-        case UnicensCmd_RmSetRoute:
-                UCSI_CB_OnCommandResult(my->tag, cmd, success, e->val.RmSetRoute.routePtr->sink_endpoint_ptr->node_obj_ptr->signature_ptr->node_address);
-            break;
+            return hdr + sizeof(UnicensCmdPacketFilterMode_t);
+        case UnicensCmd_Stop:
+        case UnicensCmd_NDStart:
+        case UnicensCmd_NDStop:
+        case UnicensCmd_NwStartup:
+        case UnicensCmd_NwShutdown:
+        case UnicensCmd_ProgInitAll:
+            return hdr;
         default:
-            UCSI_CB_OnCommandResult(my->tag, cmd, success, UNKNOWN_NODE_ADDR);
-            break;
+            return sizeof(UnicensCmdEntry_t);
     }
-    my->currentCmd = NULL;
-    RB_PopReadPtr(&my->rb);
 }
 
-static void RB_Init(RB_t *rb, uint16_t amountOfEntries, uint32_t sizeOfEntry, uint8_t *workingBuffer)
+static void RB_Init(RB_t *rb, uint32_t size, uint8_t *workingBuffer)
 {
     assert(NULL != rb);
     assert(NULL != workingBuffer);
+    assert(0 == (size % RB_ALIGN));
+    assert(0 == ((uintptr_t)workingBuffer % RB_ALIGN));
     rb->dataQueue = workingBuffer;
-    rb->pRx = rb->dataQueue;
-    rb->pTx = rb->dataQueue;
-    rb->amountOfEntries = amountOfEntries;
-    rb->sizeOfEntry = sizeOfEntry;
+    rb->size = size;
     rb->rxPos = 0;
     rb->txPos = 0;
+    rb->used = 0;
+}
+
+static uint32_t RB_RecordSize(const RB_Hdr_t *hdr)
+{
+    return sizeof(RB_Hdr_t) + ((hdr->len + RB_ALIGN - 1) & ~(RB_ALIGN - 1));
+}
+
+static RB_Hdr_t *RB_GetHdr(RB_t *rb, uint32_t pos)
+{
+    RB_Hdr_t *hdr;
+    if (pos >= rb->size)
+        pos = 0;
+    hdr = (RB_Hdr_t *)(rb->dataQueue + pos);
+    if (RB_WRAP_MARKER == hdr->len)
+        hdr = (RB_Hdr_t *)rb->dataQueue;
+    return hdr;
 }
 
 static void *RB_GetReadPtr(RB_t *rb)
 {
     assert(NULL != rb);
     assert(0 != rb->dataQueue);
-    if (rb->txPos - rb->rxPos > 0)
-    return (void *)rb->pRx;
-    return NULL;
+    if (0 == rb->used)
+        return NULL;
+    return (void *)(RB_GetHdr(rb, rb->rxPos) + 1);
+}
+
+static void *RB_GetNextPtr(RB_t *rb, const void *pRecord)
+{
+    const RB_Hdr_t *hdr = (const RB_Hdr_t *)pRecord - 1;
+    uint32_t next;
+    assert(NULL != rb);
+    assert(NULL != pRecord);
+    next = (uint32_t)((const uint8_t *)hdr - rb->dataQueue) + RB_RecordSize(hdr);
+    if (next >= rb->size)
+        next = 0;
+    if (next == rb->txPos)
+        return NULL;
+    return (void *)(RB_GetHdr(rb, next) + 1);
 }
 
 static void RB_PopReadPtr(RB_t *rb)
 {
+    RB_Hdr_t *hdr;
+    uint32_t recordSize;
     assert(NULL != rb);
     assert(0 != rb->dataQueue);
-
-    rb->pRx += rb->sizeOfEntry;
-    if (rb->pRx >= rb->dataQueue + ( rb->amountOfEntries * rb->sizeOfEntry))
-    rb->pRx = rb->dataQueue;
-    ++rb->rxPos;
-    assert(rb->txPos >= rb->rxPos);
+    assert(0 != rb->used);
+    hdr = (RB_Hdr_t *)(rb->dataQueue + rb->rxPos);
+    if (RB_WRAP_MARKER == hdr->len)
+    {
+        rb->used -= rb->size - rb->rxPos;
+        rb->rxPos = 0;
+        hdr = (RB_Hdr_t *)rb->dataQueue;
+    }
+    recordSize = RB_RecordSize(hdr);
+    assert(rb->used >= recordSize);
+    rb->used -= recordSize;
+    rb->rxPos += recordSize;
+    if (rb->rxPos >= rb->size)
+        rb->rxPos = 0;
+    if (0 != rb->used && RB_WRAP_MARKER == ((RB_Hdr_t *)(rb->dataQueue + rb->rxPos))->len)
+    {
+        rb->used -= rb->size - rb->rxPos;
+        rb->rxPos = 0;
+    }
+    if (0 == rb->used)
+    {
+        rb->rxPos = 0;
+        rb->txPos = 0;
+    }
 }
 
-static void *RB_GetWritePtr(RB_t *rb)
+static bool RB_Push(RB_t *rb, const void *pData, uint32_t len)
 {
+    RB_Hdr_t *hdr;
+    uint32_t need = sizeof(RB_Hdr_t) + ((len + RB_ALIGN - 1) & ~(RB_ALIGN - 1));
     assert(NULL != rb);
     assert(0 != rb->dataQueue);
-    if (rb->txPos - rb->rxPos < rb->amountOfEntries)
-    return (void *)rb->pTx;
-    return NULL;
+    assert(len < RB_WRAP_MARKER);
+    if (rb->used + need > rb->size)
+        return false;
+    if (rb->txPos >= rb->rxPos && need > rb->size - rb->txPos)
+    {
+        /* Records are never split, continue at the start of the buffer */
+        if (0 != rb->used && need > rb->rxPos)
+            return false;
+        if (0 != rb->used)
+        {
+            ((RB_Hdr_t *)(rb->dataQueue + rb->txPos))->len = RB_WRAP_MARKER;
+            rb->used += rb->size - rb->txPos;
+        }
+        else
+        {
+            rb->rxPos = 0;
+        }
+        rb->txPos = 0;
+    }
+    else if (rb->txPos < rb->rxPos && need > rb->rxPos - rb->txPos)
+    {
+        return false;
+    }
+    hdr = (RB_Hdr_t *)(rb->dataQueue + rb->txPos);
+    hdr->len = (uint16_t)len;
+    memcpy(hdr + 1, pData, len);
+    rb->used += need;
+    rb->txPos += need;
+    if (rb->txPos >= rb->size)
+        rb->txPos = 0;
+    return true;
 }
 
-static void RB_PopWritePtr(RB_t *rb)
+static uint32_t RB_GetFreeRecords(RB_t *rb, uint32_t len)
 {
+    uint32_t need = sizeof(RB_Hdr_t) + ((len + RB_ALIGN - 1) & ~(RB_ALIGN - 1));
+    uint32_t cnt;
     assert(NULL != rb);
-    assert(0 != rb->dataQueue);
-    rb->pTx += rb->sizeOfEntry;
-    if (rb->pTx >= rb->dataQueue + ( rb->amountOfEntries * rb->sizeOfEntry))
-    rb->pTx = rb->dataQueue;
-    ++rb->txPos;
-    assert(rb->txPos >= rb->rxPos);
+    if (0 == rb->used)
+        return rb->size / need;
+    /* Records are never split, so count what fits into each contiguous free area */
+    if (rb->txPos >= rb->rxPos)
+        cnt = (rb->size - rb->txPos) / need + rb->rxPos / need;
+    else
+        cnt = (rb->rxPos - rb->txPos) / need;
+    if (cnt > (rb->size - rb->used) / need)
+        cnt = (rb->size - rb->used) / need;
+    return cnt;
 }
 
 static uint16_t OnUnicensGetTime(void *user_ptr)
@@ -829,10 +1951,47 @@ static void OnUnicensService( void *user_ptr )
 static void OnUnicensError( Ucs_Error_t error_code, void *user_ptr )
 {
     UnicensCmdEntry_t e;
+    bool escalate;
+    uint16_t now;
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
-    error_code = error_code;
     assert(MAGIC == my->magic);
-    UCSI_CB_OnUserMessage(my->tag, true, "UNICENS general error, code=0x%X, restarting", 1, error_code);
+    now = UCSI_CB_OnGetTime(my->tag);
+    /* UNICENS terminates on every general error, so it always has to be initialized again.
+     * A hiccup on the control channel only needs the channel reset, the INIC keeps
+     * the network and its routes. Anything else, or a second error shortly after, resets the INIC */
+    escalate = my->generalErrorSeen && (uint16_t)(now - my->lastGeneralError) < RECOVERY_ESCALATE_MS;
+    if (my->recoveryRunning)
+    {
+        /* The previous recovery did not bring all routes back */
+        my->recoveryStats.failed[my->recoveryTier]++;
+        if (!escalate)
+            my->recoveryStart = now;
+    }
+    else
+    {
+        my->recoveryStart = now;
+    }
+    my->recoveryRunning = true;
+    my->recoveryTier = (UCS_GEN_ERR_COMMUNICATION == error_code && !escalate) ? UCSI_Recovery_Channel : UCSI_Recovery_Full;
+    my->generalErrorSeen = true;
+    my->lastGeneralError = now;
+    UCSI_CB_OnUserMessage(my->tag, true, "UNICENS general error, code=0x%X, recovering by %s", 2, error_code,
+        m_recoveryName[my->recoveryTier]);
+    /* Pending results are lost with the instance, do not let them block the restart */
+    FailInFlight(my);
+    /* So are the scripts the manager was running, they would hold back UCSI_ExecuteScript forever */
+    memset(my->scriptRunningMask, 0, sizeof(my->scriptRunningMask));
+    my->scriptsRunning = 0;
+    my->initialized = false;
+    my->uniTimerArmed = false;
+    ArmServiceTimer(my);
+    /* Route states are reported again by the new instance */
+    ResetRouteTracking(my);
+    my->networkAvailable = false;
+    /* A full recovery does everything the channel recovery does, and resets the INIC on top */
+    UCSI_CB_OnResetControlChannel(my->tag);
+    if (UCSI_Recovery_Full == my->recoveryTier)
+        UCSI_CB_OnResetInic(my->tag);
     e.cmd = UnicensCmd_Init;
     e.val.Init.init_ptr = &my->uniInitData;
     EnqueueCommand(my, &e);
@@ -842,7 +2001,10 @@ static void OnUnicensAppTimer( uint16_t timeout, void *user_ptr )
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    UCSI_CB_OnSetServiceTimer(my->tag, timeout);
+    my->uniTimerArmed = (0 != timeout);
+    my->uniTimerStart = UCSI_CB_OnGetTime(my->tag);
+    my->uniTimerLen = timeout;
+    ArmServiceTimer(my);
 }
 
 static void OnUnicensDebugErrorMsg(Ucs_Message_t *m, void *user_ptr)
@@ -930,29 +2092,54 @@ static void OnUnicensRoutingResult(Ucs_Rm_Route_t* route_ptr, Ucs_Rm_RouteInfos_
     uint16_t conLabel;
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    if (route_ptr == my->pendingRoutePtr)
+    if (NULL != route_ptr)
     {
-        OnCommandExecuted(my, UnicensCmd_RmSetRoute, (UCS_RM_ROUTE_INFOS_BUILT == route_infos));
-        my->pendingRoutePtr = NULL;
+        UnicensCmdEntry_t *e = FindInFlight(my, UnicensCmd_RmSetRoute, GetRouteNodeAddress(route_ptr));
+        if (NULL != e && route_ptr == e->val.RmSetRoute.routePtr)
+            OnCommandExecuted(my, UnicensCmd_RmSetRoute, GetRouteNodeAddress(route_ptr), (UCS_RM_ROUTE_INFOS_BUILT == route_infos));
     }
     if (NULL == route_ptr ||
         UCS_RM_ROUTE_INFOS_ATD_UPDATE == route_infos ||
         UCS_RM_ROUTE_INFOS_ATD_ERROR == route_infos)
         return;
     available = UCS_RM_ROUTE_INFOS_BUILT == route_infos;
+    TrackRouteBuild(my, route_ptr, available);
     conLabel = Ucs_Rm_GetConnectionLabel(my->unicens, route_ptr);
     UCSIPrint_SetRouteState(route_ptr->route_id, available, conLabel);
+    if (available)
+        CacheConnectionLabel(my, route_ptr, conLabel);
     UCSI_CB_OnRouteResult(my->tag, route_ptr->route_id, available, conLabel);
     if (UCS_RM_ROUTE_INFOS_SUSPENDED == route_infos)
     {
         /* Route has been permanently disabled due to a crucial error, enable it again */
         UnicensCmdEntry_t entry;
+        UnicensCmdEntry_t *pending = FindPendingRoute(my, route_ptr);
+        int32_t slot = GetRouteSlot(my, route_ptr);
+        if (0 <= slot && 0 == (my->routeSuspendedMask[slot / 32] & (1u << (slot % 32))))
+        {
+            /* Only this route is rebuilt, measure until it is back */
+            my->routeSuspendedMask[slot / 32] |= (1u << (slot % 32));
+            my->routeSuspendTime[slot] = UCSI_CB_OnGetTime(my->tag);
+        }
+        if (NULL != pending && !pending->val.RmSetRoute.isActive)
+        {
+            /* Already going to be deactivated, nothing to recover */
+            my->queueStats.merged++;
+            return;
+        }
+        if (NULL != pending)
+        {
+            /* Replaced by the deactivate / activate pair below */
+            pending->cmd = UnicensCmd_Unknown;
+            my->queueStats.cancelled++;
+        }
+        /* Appended without coalescing, the pair must reach UNICENS as it is */
         entry.cmd = UnicensCmd_RmSetRoute;
         entry.val.RmSetRoute.routePtr = route_ptr;
         entry.val.RmSetRoute.isActive = false;
-        EnqueueCommand(my, &entry);
+        AppendCommand(my, &entry);
         entry.val.RmSetRoute.isActive = true;
-        EnqueueCommand(my, &entry);
+        AppendCommand(my, &entry);
         UCSI_CB_OnServiceRequired(my->tag);
     }
 }
@@ -970,6 +2157,20 @@ static void OnUnicensNetworkStatus(uint16_t change_mask, uint16_t events, Ucs_Ne
         else
             UCSICollision_Init();
     }
+    if (UCS_NW_AVAILABLE == availability && !my->networkAvailable)
+    {
+        /* Routes are built by UNICENS from here on, measure until the last one is up */
+        my->networkUpTime = UCSI_CB_OnGetTime(my->tag);
+        my->measureRouteBuild = true;
+    }
+    else if (UCS_NW_AVAILABLE != availability)
+    {
+        /* All routes are destroyed with the network */
+        ResetRouteTracking(my);
+        ResetNodeTimeline(my);
+    }
+    my->networkAvailable = (UCS_NW_AVAILABLE == availability);
+    CheckRecoveryDone(my);
     UCSIPrint_SetNetworkAvailable(UCS_NW_AVAILABLE == availability, max_position);
     UCSI_CB_OnNetworkState(my->tag, UCS_NW_AVAILABLE == availability, packet_bw, max_position);
 }
@@ -1123,7 +2324,7 @@ static void OnUcsInitResult(Ucs_InitResult_t result, void *user_ptr)
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
     my->initialized = (UCS_INIT_RES_SUCCESS == result);
-    OnCommandExecuted(my, UnicensCmd_Init, (UCS_INIT_RES_SUCCESS == result));
+    OnCommandExecuted(my, UnicensCmd_Init, UNKNOWN_NODE_ADDR, (UCS_INIT_RES_SUCCESS == result));
     if (!my->initialized)
     {
         UCSI_CB_OnUserMessage(my->tag, true, "UcsInitResult reported error (0x%X), restarting...", 1, result);
@@ -1139,7 +2340,7 @@ static void OnUcsStopResult(Ucs_StdResult_t result, void *user_ptr)
     result = result; /*TODO: check error case*/
     assert(MAGIC == my->magic);
     my->initialized = false;
-    OnCommandExecuted(my, UnicensCmd_Stop, (UCS_RES_SUCCESS == result.code));
+    OnCommandExecuted(my, UnicensCmd_Stop, UNKNOWN_NODE_ADDR, (UCS_RES_SUCCESS == result.code));
     UCSI_CB_OnStop(my->tag);
 }
 
@@ -1147,14 +2348,14 @@ static void OnUcsGpioPortCreate(uint16_t node_address, uint16_t gpio_port_handle
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_GpioCreatePort, (UCS_GPIO_RES_SUCCESS == result.code));
+    OnCommandExecuted(my, UnicensCmd_GpioCreatePort, node_address, (UCS_GPIO_RES_SUCCESS == result.code));
 }
 
 static void OnUcsGpioPortWrite(uint16_t node_address, uint16_t gpio_port_handle, uint16_t current_state, uint16_t sticky_state, Ucs_Gpio_Result_t result, void *user_ptr)
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_GpioWritePort, (UCS_GPIO_RES_SUCCESS == result.code));
+    OnCommandExecuted(my, UnicensCmd_GpioWritePort, node_address, (UCS_GPIO_RES_SUCCESS == result.code));
 }
 
 static void OnUcsMgrReport(Ucs_MgrReport_t code, Ucs_Signature_t *signature_ptr, Ucs_Rm_Node_t *node_ptr, void *user_ptr)
@@ -1180,22 +2381,38 @@ static void OnUcsMgrReport(Ucs_MgrReport_t code, Ucs_Signature_t *signature_ptr,
     case UCS_MGR_REP_NOT_AVAILABLE:
         UCSIPrint_SetNodeAvailable(node_address, node_pos_addr, NodeState_NotAvailable);
         UCSI_CB_OnUserMessage(my->tag, false, "Node=%X(%X): Not available", 2, node_address, node_pos_addr);
+        OnNodeConfigured(my, node_address, false);
+        /* A script still running on the node will not report back */
+        ScriptTimingStop(my, node_address, false);
+        /* Dropped out of a running network, it may have been reset */
+        if (my->networkAvailable)
+            SetCachedScriptState(my, node_address, false);
         break;
     case UCS_MGR_REP_WELCOMED:
         UCSI_CB_OnUserMessage(my->tag, false, "Node=%X(%X): Welcomed", 2, node_address, node_pos_addr);
+        OnNodeWelcomed(my, node_address);
+        VerifyCachedNode(my, signature_ptr);
+        /* The manager runs the node scripts right after the welcome */
+        if (NULL != node_ptr && NULL != node_ptr->script_list_ptr)
+            ScriptTimingStart(my, node_address);
         break;
     case UCS_MGR_REP_SCRIPT_FAILURE:
         UCSI_CB_OnUserMessage(my->tag, true, "Node=%X(%X): Script failure", 2, node_address, node_pos_addr);
+        ScriptTimingStop(my, node_address, false);
+        SetCachedScriptState(my, node_address, false);
         break;
     case UCS_MGR_REP_IRRECOVERABLE:
         UCSI_CB_OnUserMessage(my->tag, true, "Node=%X(%X): IRRECOVERABLE ERROR!!", 2, node_address, node_pos_addr);
         break;
     case UCS_MGR_REP_SCRIPT_SUCCESS:
         UCSI_CB_OnUserMessage(my->tag, false, "Node=%X(%X): Script ok", 2, node_address, node_pos_addr);
+        ScriptTimingStop(my, node_address, true);
+        SetCachedScriptState(my, node_address, true);
         break;
     case UCS_MGR_REP_AVAILABLE:
         UCSIPrint_SetNodeAvailable(node_address, node_pos_addr, NodeState_Available);
         UCSI_CB_OnUserMessage(my->tag, false, "Node=%X(%X): Available", 2, node_address, node_pos_addr);
+        OnNodeConfigured(my, node_address, true);
         break;
     default:
         UCSI_CB_OnUserMessage(my->tag, true, "Node=%X(%X): unknown code", 2, node_address, node_pos_addr);
@@ -1205,9 +2422,19 @@ static void OnUcsMgrReport(Ucs_MgrReport_t code, Ucs_Signature_t *signature_ptr,
 
 static void OnUcsNsRun(uint16_t node_address, Ucs_Ns_ResultCode_t result, Ucs_Ns_ErrorInfo_t error_info, void *ucs_user_ptr)
 {
+    UnicensCmdEntry_t *e;
+    bool isNodeScript;
     UCSI_Data_t *my = (UCSI_Data_t *)ucs_user_ptr;
     assert(MAGIC == my->magic);
-    UCSI_CB_OnCommandResult(my->tag, UnicensCmd_NsRun, (UCS_NS_RES_SUCCESS == result), node_address);
+    /* Only the script of the node list counts as applied, not any other script run by the integrator */
+    e = FindInFlight(my, UnicensCmd_NsRun, node_address);
+    isNodeScript = (NULL != e && IsNodeScript(my, node_address, e->val.NsRun.scriptPtr));
+    /* A retried script keeps running, including its timing */
+    if (!OnCommandExecuted(my, UnicensCmd_NsRun, node_address, (UCS_NS_RES_SUCCESS == result)))
+        return;
+    if (isNodeScript)
+        SetCachedScriptState(my, node_address, (UCS_NS_RES_SUCCESS == result));
+    ScriptTimingStop(my, node_address, (UCS_NS_RES_SUCCESS == result));
 #ifdef DEBUG_XRM
     UCSI_CB_OnUserMessage(my->tag, (UCS_NS_RES_SUCCESS != result), "OnUcsNsRun (%03X): script executed %s",
         2, node_address, (UCS_NS_RES_SUCCESS == result ? "succeeded" : "false"));
@@ -1241,8 +2468,8 @@ static void OnUcsI2CWrite(uint16_t node_address, uint16_t i2c_port_handle,
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_I2CWrite, (UCS_I2C_RES_SUCCESS == result.code));
-    if (UCS_I2C_RES_SUCCESS != result.code)
+    if (OnCommandExecuted(my, UnicensCmd_I2CWrite, node_address, (UCS_I2C_RES_SUCCESS == result.code))
+        && UCS_I2C_RES_SUCCESS != result.code)
         UCSI_CB_OnUserMessage(my->tag, true, "Remote I2C Write to node=0x%X failed", 1, node_address);
 }
 
@@ -1251,8 +2478,8 @@ static void OnUcsI2CRead(uint16_t node_address, uint16_t i2c_port_handle,
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_I2CRead, (UCS_I2C_RES_SUCCESS == result.code));
-    UCSI_CB_OnI2CRead(my->tag, (UCS_I2C_RES_SUCCESS == result.code), node_address, i2c_slave_address, data_ptr, data_len);
+    if (OnCommandExecuted(my, UnicensCmd_I2CRead, node_address, (UCS_I2C_RES_SUCCESS == result.code)))
+        UCSI_CB_OnI2CRead(my->tag, (UCS_I2C_RES_SUCCESS == result.code), node_address, i2c_slave_address, data_ptr, data_len);
 }
 
 #if ENABLE_AMS_LIB
@@ -1260,7 +2487,7 @@ static void OnUcsAmsWrite(Ucs_AmsTx_Msg_t* msg_ptr, Ucs_AmsTx_Result_t result, U
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_SendAmsMessage, (UCS_AMSTX_RES_SUCCESS == result));
+    OnCommandExecuted(my, UnicensCmd_SendAmsMessage, msg_ptr->destination_address, (UCS_AMSTX_RES_SUCCESS == result));
     if (UCS_AMSTX_RES_SUCCESS != result)
         UCSI_CB_OnUserMessage(my->tag, true, "SendAms failed with result=0x%x, info=0x%X", 2, result, info);
 }
@@ -1271,12 +2498,12 @@ static void OnUcsProgRam(Ucs_Prg_ResCode_t code, Ucs_Prg_Func_t function,
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    if (my->currentCmd->cmd != UnicensCmd_ProgIsRam)
+    if (NULL == FindInFlight(my, UnicensCmd_ProgIsRam, UNKNOWN_NODE_ADDR))
     {
         /* Workaround for issue found in UCS Lib V2.2.0-3942 */
         return;
     }
-    OnCommandExecuted(my, UnicensCmd_ProgIsRam, (UCS_PRG_RES_SUCCESS == code));
+    OnCommandExecuted(my, UnicensCmd_ProgIsRam, UNKNOWN_NODE_ADDR, (UCS_PRG_RES_SUCCESS == code));
     if (UCS_PRG_RES_SUCCESS == code)
         UCSI_CB_OnUserMessage(my->tag, false, "Write to RAM was successful", 0);
     else
@@ -1295,12 +2522,12 @@ static void OnUcsProgRom(Ucs_Prg_ResCode_t code, Ucs_Prg_Func_t function,
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    if (my->currentCmd->cmd != UnicensCmd_ProgIsRom)
+    if (NULL == FindInFlight(my, UnicensCmd_ProgIsRom, UNKNOWN_NODE_ADDR))
     {
         /* Workaround for issue found in UCS Lib V2.2.0-3942 */
         return;
     }
-    OnCommandExecuted(my, UnicensCmd_ProgIsRom, (UCS_PRG_RES_SUCCESS == code));
+    OnCommandExecuted(my, UnicensCmd_ProgIsRom, UNKNOWN_NODE_ADDR, (UCS_PRG_RES_SUCCESS == code));
     if (UCS_PRG_RES_SUCCESS == code)
         UCSI_CB_OnUserMessage(my->tag, false, "Write to ROM was successful", 0);
     else
@@ -1318,8 +2545,8 @@ static void OnUcsPacketFilterMode(uint16_t node_address, Ucs_StdResult_t result,
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_PacketFilterMode, (UCS_RES_SUCCESS == result.code));
-    if (UCS_RES_SUCCESS != result.code)
+    if (OnCommandExecuted(my, UnicensCmd_PacketFilterMode, node_address, (UCS_RES_SUCCESS == result.code))
+        && UCS_RES_SUCCESS != result.code)
         UCSI_CB_OnUserMessage(my->tag, true, "Set promiscuous mode failed with error code %d", 1, result.code);
 }
 
@@ -1327,7 +2554,7 @@ static void OnUcsNetworkStartup(Ucs_StdResult_t result, void *user_ptr)
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_NwStartup, (UCS_RES_SUCCESS == result.code));
+    OnCommandExecuted(my, UnicensCmd_NwStartup, UNKNOWN_NODE_ADDR, (UCS_RES_SUCCESS == result.code));
     if (UCS_RES_SUCCESS != result.code)
         UCSI_CB_OnUserMessage(my->tag, true, "NetworkStartup failed with error code %d", 1, result.code);
 }
@@ -1336,7 +2563,7 @@ static void OnUcsNetworkShutdown(Ucs_StdResult_t result, void *user_ptr)
 {
     UCSI_Data_t *my = (UCSI_Data_t *)user_ptr;
     assert(MAGIC == my->magic);
-    OnCommandExecuted(my, UnicensCmd_NwShutdown, (UCS_RES_SUCCESS == result.code));
+    OnCommandExecuted(my, UnicensCmd_NwShutdown, UNKNOWN_NODE_ADDR, (UCS_RES_SUCCESS == result.code));
     if (0 != my->programmingJobsTotal)
     {
         UCSI_CB_OnProgrammingDone(my->tag, true);
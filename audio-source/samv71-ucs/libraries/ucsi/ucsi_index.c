@@ -0,0 +1,156 @@
+/*------------------------------------------------------------------------------------------------*/
+/* UNICENS Integration Helper Component                                                           */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "ucsi_index.h"
+
+/************************************************************************/
+/* Private Definitions and variables                                    */
+/************************************************************************/
+
+#define EMPTY_SLOT (0xFFFF)
+
+/************************************************************************/
+/* Private Function Prototypes                                          */
+/************************************************************************/
+
+static uint16_t GetHome(const UCSI_Index_t *idx, uintptr_t key);
+static uint16_t GetNext(const UCSI_Index_t *idx, uint16_t pos);
+
+/************************************************************************/
+/* Public Function Implementations                                      */
+/************************************************************************/
+
+void UCSIIndex_Init(UCSI_Index_t *idx, uintptr_t *pKeys, uint16_t *pSlots, uint16_t capacity)
+{
+    assert(NULL != idx);
+    assert(NULL != pKeys);
+    assert(NULL != pSlots);
+    assert(0 != capacity);
+    idx->keys = pKeys;
+    idx->slots = pSlots;
+    idx->capacity = capacity;
+    UCSIIndex_Clear(idx);
+}
+
+void UCSIIndex_Clear(UCSI_Index_t *idx)
+{
+    uint16_t i;
+    assert(NULL != idx);
+    for (i = 0; i < idx->capacity; i++)
+        idx->slots[i] = EMPTY_SLOT;
+    idx->count = 0;
+}
+
+bool UCSIIndex_Insert(UCSI_Index_t *idx, uintptr_t key, uint16_t slot)
+{
+    uint16_t pos;
+    assert(NULL != idx);
+    assert(EMPTY_SLOT != slot);
+    pos = GetHome(idx, key);
+    while (EMPTY_SLOT != idx->slots[pos])
+    {
+        if (key == idx->keys[pos])
+            return true;
+        pos = GetNext(idx, pos);
+    }
+    /* Always keep one free position, it terminates the probe loops */
+    if (idx->count + 1 >= idx->capacity)
+        return false;
+    idx->keys[pos] = key;
+    idx->slots[pos] = slot;
+    ++idx->count;
+    return true;
+}
+
+bool UCSIIndex_Find(const UCSI_Index_t *idx, uintptr_t key, uint16_t *pSlot)
+{
+    uint16_t pos;
+    assert(NULL != idx);
+    pos = GetHome(idx, key);
+    while (EMPTY_SLOT != idx->slots[pos])
+    {
+        if (key == idx->keys[pos])
+        {
+            if (NULL != pSlot)
+                *pSlot = idx->slots[pos];
+            return true;
+        }
+        pos = GetNext(idx, pos);
+    }
+    return false;
+}
+
+void UCSIIndex_Remove(UCSI_Index_t *idx, uintptr_t key)
+{
+    uint16_t pos, next;
+    assert(NULL != idx);
+    pos = GetHome(idx, key);
+    while (EMPTY_SLOT != idx->slots[pos] && key != idx->keys[pos])
+        pos = GetNext(idx, pos);
+    if (EMPTY_SLOT == idx->slots[pos])
+        return;
+    /* Shift the following entries of the probe sequence back, so no tombstones are needed */
+    next = GetNext(idx, pos);
+    while (EMPTY_SLOT != idx->slots[next])
+    {
+        uint16_t home = GetHome(idx, idx->keys[next]);
+        bool movable = (pos <= next) ? (home <= pos || home > next) : (home <= pos && home > next);
+        if (movable)
+        {
+            idx->keys[pos] = idx->keys[next];
+            idx->slots[pos] = idx->slots[next];
+            pos = next;
+        }
+        next = GetNext(idx, next);
+    }
+    idx->slots[pos] = EMPTY_SLOT;
+    --idx->count;
+}
+
+/************************************************************************/
+/* Private Functions                                                    */
+/************************************************************************/
+
+static uint16_t GetHome(const UCSI_Index_t *idx, uintptr_t key)
+{
+    /* Fibonacci hashing spreads consecutive route IDs and aligned pointers */
+    uint32_t h = (uint32_t)key ^ (uint32_t)((uint64_t)key >> 32);
+    h *= 2654435761u;
+    return (uint16_t)((h >> 16) % idx->capacity);
+}
+
+static uint16_t GetNext(const UCSI_Index_t *idx, uint16_t pos)
+{
+    return (pos + 1 < idx->capacity) ? (pos + 1) : 0;
+}
@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------------------------------*/
+/* UNICENS Integration Helper Component                                                           */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+#ifndef UCSI_INDEX_H_
+#define UCSI_INDEX_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/**
+ * \brief Table size needed to index the given amount of entries.
+ * \note Keeps the load factor at or below 50%, so lookups stay at one or two probes.
+ */
+#define UCSI_INDEX_CAPACITY(entries) ((2 * (entries)) + 1)
+
+/**
+ * \brief Open addressing index, mapping a key (route ID, node address or object pointer) to a slot in a caller owned table.
+ * \note Never touch any of this fields!
+ */
+typedef struct
+{
+    uintptr_t *keys;
+    uint16_t *slots;
+    uint16_t capacity;
+    uint16_t count;
+} UCSI_Index_t;
+
+/**
+ * \brief Initializes an empty index on the given storage.
+ *
+ * \param idx - the index instance
+ * \param pKeys - storage for the keys, must hold capacity elements
+ * \param pSlots - storage for the slots, must hold capacity elements
+ * \param capacity - table size, use UCSI_INDEX_CAPACITY() to calculate it
+ */
+void UCSIIndex_Init(UCSI_Index_t *idx, uintptr_t *pKeys, uint16_t *pSlots, uint16_t capacity);
+
+/**
+ * \brief Removes all entries from the index.
+ *
+ * \param idx - the index instance
+ */
+void UCSIIndex_Clear(UCSI_Index_t *idx);
+
+/**
+ * \brief Adds a key to the index.
+ * \note If the key is already stored, the existing mapping is kept.
+ *
+ * \param idx - the index instance
+ * \param key - the key
+ * \param slot - the slot the key shall map to
+ * \return true, if the key is stored in the index afterwards. false, the index is full.
+ */
+bool UCSIIndex_Insert(UCSI_Index_t *idx, uintptr_t key, uint16_t slot);
+
+/**
+ * \brief Looks up a key.
+ *
+ * \param idx - the index instance
+ * \param key - the key
+ * \param pSlot - receives the slot, if the key was found. May be NULL.
+ * \return true, if the key was found. false, otherwise.
+ */
+bool UCSIIndex_Find(const UCSI_Index_t *idx, uintptr_t key, uint16_t *pSlot);
+
+/**
+ * \brief Removes a key from the index. Does nothing, if the key is not stored.
+ *
+ * \param idx - the index instance
+ * \param key - the key
+ */
+void UCSIIndex_Remove(UCSI_Index_t *idx, uintptr_t key);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCSI_INDEX_H_ */
@@ -36,6 +36,7 @@
 #include <assert.h>
 #include "ucsi_cfg.h"
 #include "ucsi_print.h"
+#include "ucsi_index.h"
 
 #ifdef ENABLE_RESOURCE_PRINT
 
@@ -52,6 +53,11 @@
 
 #define STR_BUF_LEN (200)
 #define STR_RES_LEN (60)
+#define NODE_POS_ADDR_BASE (0x400)
+#define NODE_MASK_WORDS ((UCSI_PRINT_MAX_NODES + 31) / 32)
+#define MASK_GET(mask, pos) (0 != ((mask)[(pos) / 32] & (1u << ((pos) % 32))))
+#define MASK_SET(mask, pos) ((mask)[(pos) / 32] |= (1u << ((pos) % 32)))
+#define MASK_CLR(mask, pos) ((mask)[(pos) / 32] &= ~(1u << ((pos) % 32)))
 
 struct ResourceList
 {
@@ -67,14 +73,6 @@ struct ConnectionList
     uint16_t connectionLabel;
 };
 
-struct NodeList
-{
-    bool isValid;
-    UCSIPrint_NodeState_t nodeState;
-    uint16_t node;
-    uint16_t pos;
-};
-
 struct LocalVar
 {
     bool initialized;
@@ -89,7 +87,21 @@ struct LocalVar
     uint8_t waitForMprRetries;
     struct ResourceList rList[UCSI_PRINT_MAX_RESOURCES];
     struct ConnectionList cList[UCSI_PRINT_MAX_RESOURCES];
-    struct NodeList nList[UCSI_PRINT_MAX_NODES];
+    uint16_t nodeAddr[UCSI_PRINT_MAX_NODES]; /* Indexed by node position */
+    uint32_t nodeValid[NODE_MASK_WORDS];
+    uint32_t nodeAvailable[NODE_MASK_WORDS];
+    uint32_t nodeIgnored[NODE_MASK_WORDS];
+    uint16_t rCount;
+    uint16_t cCount;
+    UCSI_Index_t rIndex;
+    uintptr_t rIndexKeys[UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_RESOURCES)];
+    uint16_t rIndexSlots[UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_RESOURCES)];
+    UCSI_Index_t cIndex;
+    uintptr_t cIndexKeys[UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_RESOURCES)];
+    uint16_t cIndexSlots[UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_RESOURCES)];
+    UCSI_Index_t nAddrIndex;
+    uintptr_t nAddrIndexKeys[UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_NODES)];
+    uint16_t nAddrIndexSlots[UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_NODES)];
 };
 
 static struct LocalVar m = { 0 };
@@ -100,17 +112,24 @@ static bool GetIgnoredNodeString(char *pBuf, uint32_t bufLen);
 static UCSIPrint_NodeState_t GetNodeState(uint16_t nodeAddress);
 static uint8_t GetNodeCount(void);
 static bool GetRouteState(uint16_t routeId, bool *pIsActive, uint16_t *pConLabel);
+static UCSIPrint_NodeState_t GetPosState(uint16_t pos);
+static void SetNodeAddress(uint16_t pos, uint16_t nodeAddress);
+static void ReserveEntries(void);
 static void RequestTrigger(void);
 
 void UCSIPrint_Init(Ucs_Rm_Route_t *pRoutes, uint16_t routesSize, void *tag)
 {
     memset(&m, 0, sizeof(struct LocalVar));
+    UCSIIndex_Init(&m.rIndex, m.rIndexKeys, m.rIndexSlots, UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_RESOURCES));
+    UCSIIndex_Init(&m.cIndex, m.cIndexKeys, m.cIndexSlots, UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_RESOURCES));
+    UCSIIndex_Init(&m.nAddrIndex, m.nAddrIndexKeys, m.nAddrIndexSlots, UCSI_INDEX_CAPACITY(UCSI_PRINT_MAX_NODES));
     if (NULL == pRoutes || 0 == routesSize)
         return;
     m.tag = tag;
     m.pRoutes = pRoutes;
     m.routesSize = routesSize;
     m.initialized = true;
+    ReserveEntries();
 }
 
 void UCSIPrint_Service(uint32_t timestamp)
@@ -173,37 +192,33 @@ void UCSIPrint_SetNetworkAvailable(bool available, uint8_t maxPos)
 
 void UCSIPrint_SetNodeAvailable(uint16_t nodeAddress, uint16_t nodePosAddr, UCSIPrint_NodeState_t nodeState)
 {
-    uint16_t i;
+    uint16_t pos = nodePosAddr - NODE_POS_ADDR_BASE;
     if (!m.initialized)
         return;
-    /* Find existing entry */
-    for (i = 0; i < UCSI_PRINT_MAX_NODES; i++)
+    if (nodePosAddr < NODE_POS_ADDR_BASE || UCSI_PRINT_MAX_NODES <= pos)
     {
-        if (m.nList[i].isValid && nodePosAddr == m.nList[i].pos)
-        {
-            if (m.nList[i].nodeState != nodeState || m.nList[i].node != nodeAddress)
-            {
-                m.nList[i].node = nodeAddress;
-                m.nList[i].nodeState = nodeState;
-                RequestTrigger();
-            }
-            return;
-        }
+        UCSIPrint_CB_OnUserMessage(m.tag, RED "UCSI-Watchdog:Could not store node availability, position address out of range" RESETCOLOR);
+        return;
     }
-    /* Find empty entry and store it there */
-    for (i = 0; i < UCSI_PRINT_MAX_NODES; i++)
+    if (MASK_GET(m.nodeValid, pos) && GetPosState(pos) == nodeState && m.nodeAddr[pos] == nodeAddress)
+        return;
+    if (!MASK_GET(m.nodeValid, pos))
     {
-        if (!m.nList[i].isValid)
-        {
-            m.nList[i].node = nodeAddress;
-            m.nList[i].pos = nodePosAddr;
-            m.nList[i].nodeState = nodeState;
-            m.nList[i].isValid = true;
-            RequestTrigger();
-            return;
-        }
+        MASK_SET(m.nodeValid, pos);
+        m.nodeAddr[pos] = nodeAddress;
+        UCSIIndex_Insert(&m.nAddrIndex, nodeAddress, pos);
     }
-    UCSIPrint_CB_OnUserMessage(m.tag, RED "UCSI-Watchdog:Could not store node availability, increase UCSI_PRINT_MAX_NODES" RESETCOLOR);
+    else
+    {
+        SetNodeAddress(pos, nodeAddress);
+    }
+    MASK_CLR(m.nodeAvailable, pos);
+    MASK_CLR(m.nodeIgnored, pos);
+    if (NodeState_Available == nodeState)
+        MASK_SET(m.nodeAvailable, pos);
+    else if (NodeState_Ignored == nodeState)
+        MASK_SET(m.nodeIgnored, pos);
+    RequestTrigger();
 }
 
 void UCSIPrint_SetRouteState(uint16_t routeId, bool isActive, uint16_t connectionLabel)
@@ -213,26 +228,22 @@ void UCSIPrint_SetRouteState(uint16_t routeId, bool isActive, uint16_t connectio
         return;
     RequestTrigger();
     /* Find existing entry */
-    for (i = 0; i < UCSI_PRINT_MAX_RESOURCES; i++)
+    if (UCSIIndex_Find(&m.cIndex, routeId, &i))
     {
-        if (m.cList[i].isValid && routeId == m.cList[i].routeId)
-        {
-            m.cList[i].connectionLabel = connectionLabel;
-            m.cList[i].isActive = isActive;
-            return;
-        }
+        m.cList[i].connectionLabel = connectionLabel;
+        m.cList[i].isActive = isActive;
+        return;
     }
-    /* Find empty entry and store it there */
-    for (i = 0; i < UCSI_PRINT_MAX_RESOURCES; i++)
+    /* Store it in the next empty entry */
+    if (m.cCount < UCSI_PRINT_MAX_RESOURCES)
     {
-        if (!m.cList[i].isValid)
-        {
-            m.cList[i].routeId = routeId;
-            m.cList[i].isActive = isActive;
-            m.cList[i].connectionLabel = connectionLabel;
-            m.cList[i].isValid = true;
-            return;
-        }
+        i = m.cCount++;
+        m.cList[i].routeId = routeId;
+        m.cList[i].isActive = isActive;
+        m.cList[i].connectionLabel = connectionLabel;
+        m.cList[i].isValid = true;
+        UCSIIndex_Insert(&m.cIndex, routeId, i);
+        return;
     }
     UCSIPrint_CB_OnUserMessage(m.tag, RED "UCSI-Watchdog:Could not store connection label, increase UCSI_PRINT_MAX_RESOURCES" RESETCOLOR);
 }
@@ -243,28 +254,24 @@ void UCSIPrint_SetObjectState(Ucs_Xrm_ResObject_t *element, UCSIPrint_ObjectStat
     if (!m.initialized)
         return;
     /* Find existing entry */
-    for (i = 0; i < UCSI_PRINT_MAX_RESOURCES; i++)
-    {
-        if (element == m.rList[i].element)
-        {
-            if (m.rList[i].state != state)
-            {
-                m.rList[i].state = state;
-                RequestTrigger();
-            }
-            return;
-        }
-    }
-    /* Find empty entry and store it there */
-    for (i = 0; i < UCSI_PRINT_MAX_RESOURCES; i++)
+    if (UCSIIndex_Find(&m.rIndex, (uintptr_t)element, &i))
     {
-        if (NULL == m.rList[i].element)
+        if (m.rList[i].state != state)
         {
-            m.rList[i].element = element;
             m.rList[i].state = state;
             RequestTrigger();
-            return;
         }
+        return;
+    }
+    /* Store it in the next empty entry */
+    if (m.rCount < UCSI_PRINT_MAX_RESOURCES)
+    {
+        i = m.rCount++;
+        m.rList[i].element = element;
+        m.rList[i].state = state;
+        UCSIIndex_Insert(&m.rIndex, (uintptr_t)element, i);
+        RequestTrigger();
+        return;
     }
     UCSIPrint_CB_OnUserMessage(m.tag, RED "UCSI-Watchdog:Could not store object state, increase UCSI_PRINT_MAX_RESOURCES" RESETCOLOR);
 }
@@ -368,17 +375,9 @@ static void ParseResources(Ucs_Xrm_ResObject_t **ppJobList, char *pBuf, uint32_t
         /* Silently ignore default created port */
         if (UCS_XRM_RC_TYPE_DC_PORT == typ)
             continue;
-        for (j = 0; j < UCSI_PRINT_MAX_RESOURCES; j++)
-        {
-            if (NULL == m.rList[j].element)
-                break;
-            newState = ObjState_Unused;
-            if (job == m.rList[j].element)
-            {
-                newState = m.rList[j].state;
-                break;
-            }
-        }
+        newState = ObjState_Unused;
+        if (UCSIIndex_Find(&m.rIndex, (uintptr_t)job, &j))
+            newState = m.rList[j].state;
         if (oldState != newState)
         {
             oldState = newState;
@@ -442,18 +441,20 @@ static void ParseResources(Ucs_Xrm_ResObject_t **ppJobList, char *pBuf, uint32_t
 
 static bool GetIgnoredNodeString(char *pBuf, uint32_t bufLen)
 {
-    uint16_t i;
+    uint16_t pos;
     char pTmp[8];
     bool foundNodes = false;
     assert(NULL != pBuf && 0 != bufLen);
     pBuf[0] = '\0';
-    /* Find existing entry */
-    for (i = 0; i < UCSI_PRINT_MAX_NODES; i++)
+    for (pos = 0; pos < UCSI_PRINT_MAX_NODES; pos++)
     {
-        if (m.nList[i].isValid && NodeState_Ignored == m.nList[i].nodeState)
+        if (MASK_GET(m.nodeIgnored, pos))
         {
             foundNodes = true;
-            snprintf(pTmp, sizeof(pTmp), "0x%X ", m.nList[i].node);
+            snprintf(pTmp, sizeof(pTmp), "0x%X ", m.nodeAddr[pos]);
+            /* With a full ring not all addresses may fit, skip the rest */
+            if (strlen(pBuf) + strlen(pTmp) >= bufLen)
+                break;
             strcat(pBuf, pTmp);
         }
     }
@@ -463,15 +464,9 @@ static bool GetIgnoredNodeString(char *pBuf, uint32_t bufLen)
 
 static UCSIPrint_NodeState_t GetNodeState(uint16_t nodeAddress)
 {
-    uint16_t i;
-    /* Find existing entry */
-    for (i = 0; i < UCSI_PRINT_MAX_NODES; i++)
-    {
-        if (m.nList[i].isValid && nodeAddress == m.nList[i].node)
-        {
-            return m.nList[i].nodeState;
-        }
-    }
+    uint16_t pos;
+    if (UCSIIndex_Find(&m.nAddrIndex, nodeAddress, &pos))
+        return GetPosState(pos);
     return NodeState_NotAvailable;
 }
 
@@ -479,9 +474,10 @@ static uint8_t GetNodeCount(void)
 {
     uint16_t i;
     uint8_t cnt = 0;
-    for (i = 0; i < UCSI_PRINT_MAX_NODES; i++)
+    for (i = 0; i < NODE_MASK_WORDS; i++)
     {
-        if (m.nList[i].isValid && NodeState_NotAvailable != m.nList[i].nodeState)
+        uint32_t bits = m.nodeAvailable[i] | m.nodeIgnored[i];
+        for (; 0 != bits; bits &= bits - 1)
             ++cnt;
     }
     return cnt;
@@ -492,17 +488,92 @@ static bool GetRouteState(uint16_t routeId, bool *pIsActive, uint16_t *pConLabel
     uint16_t i;
     assert(NULL != pIsActive);
     assert(NULL != pConLabel);
-    /* Find existing entry */
-    for (i = 0; i < UCSI_PRINT_MAX_NODES; i++)
+    if (!UCSIIndex_Find(&m.cIndex, routeId, &i))
+        return false;
+    *pIsActive = m.cList[i].isActive;
+    *pConLabel = m.cList[i].connectionLabel;
+    return true;
+}
+
+static UCSIPrint_NodeState_t GetPosState(uint16_t pos)
+{
+    if (MASK_GET(m.nodeAvailable, pos))
+        return NodeState_Available;
+    if (MASK_GET(m.nodeIgnored, pos))
+        return NodeState_Ignored;
+    return NodeState_NotAvailable;
+}
+
+static void SetNodeAddress(uint16_t pos, uint16_t nodeAddress)
+{
+    uint16_t i, indexed, oldAddress = m.nodeAddr[pos];
+    if (oldAddress == nodeAddress)
+        return;
+    if (UCSIIndex_Find(&m.nAddrIndex, oldAddress, &indexed) && indexed == pos)
+    {
+        UCSIIndex_Remove(&m.nAddrIndex, oldAddress);
+        /* Another position may still report the old address */
+        for (i = 0; i < UCSI_PRINT_MAX_NODES; i++)
+        {
+            if (i != pos && MASK_GET(m.nodeValid, i) && oldAddress == m.nodeAddr[i])
+            {
+                UCSIIndex_Insert(&m.nAddrIndex, oldAddress, i);
+                break;
+            }
+        }
+    }
+    m.nodeAddr[pos] = nodeAddress;
+    /* Like the former linear search, the lowest position with this address wins */
+    if (UCSIIndex_Find(&m.nAddrIndex, nodeAddress, &indexed) && indexed > pos)
+        UCSIIndex_Remove(&m.nAddrIndex, nodeAddress);
+    UCSIIndex_Insert(&m.nAddrIndex, nodeAddress, pos);
+}
+
+static void ReserveEntries(void)
+{
+    uint16_t i, j, k;
+    uint16_t routesNeeded = 0, resourcesNeeded = 0;
+    /* Take the table entries for the whole configuration now, so the UNICENS callbacks only do lookups */
+    for (i = 0; i < m.routesSize; i++)
     {
-        if (m.cList[i].isValid && routeId == m.cList[i].routeId)
+        Ucs_Rm_EndPoint_t *endpoints[2];
+        if (!UCSIIndex_Find(&m.cIndex, m.pRoutes[i].route_id, NULL))
         {
-            *pIsActive = m.cList[i].isActive;
-            *pConLabel = m.cList[i].connectionLabel;
-            return true;
+            ++routesNeeded;
+            if (m.cCount < UCSI_PRINT_MAX_RESOURCES)
+            {
+                k = m.cCount++;
+                m.cList[k].routeId = m.pRoutes[i].route_id;
+                m.cList[k].connectionLabel = INVALID_CON_LABEL;
+                m.cList[k].isValid = true;
+                UCSIIndex_Insert(&m.cIndex, m.pRoutes[i].route_id, k);
+            }
         }
+        endpoints[0] = m.pRoutes[i].source_endpoint_ptr;
+        endpoints[1] = m.pRoutes[i].sink_endpoint_ptr;
+        for (j = 0; j < 2; j++)
+        {
+            Ucs_Xrm_ResObject_t **ppJobList = (NULL != endpoints[j]) ? endpoints[j]->jobs_list_ptr : NULL;
+            for (k = 0; NULL != ppJobList && NULL != ppJobList[k]; k++)
+            {
+                if (UCSIIndex_Find(&m.rIndex, (uintptr_t)ppJobList[k], NULL))
+                    continue;
+                ++resourcesNeeded;
+                if (m.rCount < UCSI_PRINT_MAX_RESOURCES)
+                {
+                    m.rList[m.rCount].element = ppJobList[k];
+                    UCSIIndex_Insert(&m.rIndex, (uintptr_t)ppJobList[k], m.rCount);
+                    m.rCount++;
+                }
+            }
+        }
+    }
+    if (UCSI_PRINT_MAX_RESOURCES < routesNeeded || UCSI_PRINT_MAX_RESOURCES < resourcesNeeded)
+    {
+        snprintf(strBuf, STR_BUF_LEN, RED "UCSI-Watchdog:Configuration needs %u routes and %u resources, increase UCSI_PRINT_MAX_RESOURCES" RESETCOLOR,
+            routesNeeded, resourcesNeeded);
+        UCSIPrint_CB_OnUserMessage(m.tag, strBuf);
     }
-    return false;
 }
 
 static void RequestTrigger(void)
@@ -40,7 +40,7 @@ extern "C" {
 #include "ucs_cfg.h"
 #include "ucs_xrm_cfg.h"
 
-#define UCSI_PRINT_MAX_NODES (UCS_NUM_REMOTE_DEVICES + 1)
+#define UCSI_PRINT_MAX_NODES (64) /* Positions in a MOST ring */
 #define UCSI_PRINT_MAX_RESOURCES (UCS_XRM_NUM_RESOURCES)
 
 typedef enum
@@ -58,8 +58,11 @@ extern "C"
 /*------------------------------------------------------------------------------------------------*/
 /* Maximum number of remote devices used by Resources Management modules.
  * Valid range: 0..63. Default value: 0.
+ * Sized for a full ring of 64 nodes, matching MAX_NODES of UCSI. UNICENS reserves its per device state
+ * statically for every remote device, look up the size of the UNICENS instance in the .map file when
+ * changing this value. UCSI and UCSIPrint grow by about 3.1 KB of RAM from 8 to 64 nodes (32-bit build).
  */
-#define UCS_NUM_REMOTE_DEVICES            5
+#define UCS_NUM_REMOTE_DEVICES            63
 
 /*------------------------------------------------------------------------------------------------*/
 /* Application Messages                                                                           */
@@ -0,0 +1,227 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Synchronous Channel Scheduler                                                                  */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include "audio_sched.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define NO_DEADLINE             (0xFFFFFFFF)
+/* RX stream with data, but without a first buffer its length and so the deadline is unknown */
+#define UNKNOWN_DEADLINE        (NO_DEADLINE - 1)
+
+typedef struct
+{
+    DIM2LLD_ChannelDirection_t dir;
+    uint8_t instance;
+    uint16_t bytesPerFrame;
+    uint16_t numberOfBuffers;
+    uint16_t bufferLen;
+    bool blocked;
+    AudioSched_TxSource_t source;
+    AudioSched_RxSink_t sink;
+    void *pTag;
+    AudioSched_Stats_t stats;
+    LevelMeter_t meter;
+} Stream_t;
+
+typedef struct
+{
+    Stream_t streams[AUDIOSCHED_MAX_STREAMS];
+    uint8_t streamCount;
+    uint32_t meterPeriodFrames;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static int8_t AddStream(DIM2LLD_ChannelDirection_t dir, uint8_t instance, uint16_t bytesPerFrame, uint16_t numberOfBuffers, void *pTag);
+static uint32_t GetSlackFrames(Stream_t *pStream);
+static void ServiceStream(Stream_t *pStream, uint32_t slack);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void AudioSched_Init(uint32_t meterPeriodFrames)
+{
+    memset(&m, 0, sizeof(m));
+    m.meterPeriodFrames = meterPeriodFrames;
+}
+
+int8_t AudioSched_AddTxStream(uint8_t instance, uint16_t bytesPerFrame, AudioSched_TxSource_t source, void *pTag)
+{
+    int8_t idx;
+    assert(NULL != source);
+    idx = AddStream(DIM2LLD_ChannelDirection_TX, instance, bytesPerFrame, 0, pTag);
+    if (0 <= idx)
+        m.streams[idx].source = source;
+    return idx;
+}
+
+int8_t AudioSched_AddRxStream(uint8_t instance, uint16_t bytesPerFrame, uint16_t numberOfBuffers, AudioSched_RxSink_t sink, void *pTag)
+{
+    int8_t idx;
+    assert(NULL != sink);
+    idx = AddStream(DIM2LLD_ChannelDirection_RX, instance, bytesPerFrame, numberOfBuffers, pTag);
+    if (0 <= idx)
+        m.streams[idx].sink = sink;
+    return idx;
+}
+
+void AudioSched_Service(void)
+{
+    uint8_t i;
+    for (i = 0; i < m.streamCount; i++)
+        m.streams[i].blocked = false;
+    while (true)
+    {
+        Stream_t *pNext = NULL;
+        uint32_t nextSlack = NO_DEADLINE;
+        for (i = 0; i < m.streamCount; i++)
+        {
+            uint32_t slack;
+            if (m.streams[i].blocked)
+                continue;
+            slack = GetSlackFrames(&m.streams[i]);
+            if (NO_DEADLINE == slack)
+                continue;
+            if (NULL == pNext || slack < nextSlack)
+            {
+                pNext = &m.streams[i];
+                nextSlack = slack;
+            }
+        }
+        if (NULL == pNext)
+            break;
+        ServiceStream(pNext, nextSlack);
+    }
+}
+
+const AudioSched_Stats_t *AudioSched_GetStats(int8_t stream)
+{
+    if (0 > stream || m.streamCount <= stream)
+        return NULL;
+    return &m.streams[stream].stats;
+}
+
+const LevelMeter_t *AudioSched_GetLevels(int8_t stream)
+{
+    if (0 > stream || m.streamCount <= stream)
+        return NULL;
+    return &m.streams[stream].meter;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static int8_t AddStream(DIM2LLD_ChannelDirection_t dir, uint8_t instance, uint16_t bytesPerFrame, uint16_t numberOfBuffers, void *pTag)
+{
+    Stream_t *pStream;
+    assert(0 != bytesPerFrame);
+    if (AUDIOSCHED_MAX_STREAMS <= m.streamCount || 0 == bytesPerFrame)
+        return -1;
+    pStream = &m.streams[m.streamCount];
+    memset(pStream, 0, sizeof(Stream_t));
+    pStream->dir = dir;
+    pStream->instance = instance;
+    pStream->bytesPerFrame = bytesPerFrame;
+    pStream->numberOfBuffers = numberOfBuffers;
+    pStream->pTag = pTag;
+    pStream->stats.minSlackFrames = NO_DEADLINE;
+    LevelMeter_Init(&pStream->meter, bytesPerFrame, m.meterPeriodFrames);
+    return (int8_t)m.streamCount++;
+}
+
+/* Frames until the stream runs dry (TX) or overflows (RX), NO_DEADLINE if there is nothing to do */
+static uint32_t GetSlackFrames(Stream_t *pStream)
+{
+    uint32_t queued = DIM2LLD_GetQueueElementCount(DIM2LLD_ChannelType_Sync, pStream->dir, pStream->instance);
+    if (DIM2LLD_ChannelDirection_TX == pStream->dir)
+    {
+        uint8_t *pBuf = NULL;
+        uint16_t len = DIM2LLD_GetTxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_TX, pStream->instance, &pBuf);
+        if (0 == len || NULL == pBuf)
+            return NO_DEADLINE;
+        pStream->bufferLen = len;
+        return queued * (len / pStream->bytesPerFrame);
+    }
+    if (0 == queued)
+        return NO_DEADLINE;
+    if (0 == pStream->bufferLen)
+        return UNKNOWN_DEADLINE;
+    if (queued >= pStream->numberOfBuffers)
+        return 0;
+    return (pStream->numberOfBuffers - queued) * (pStream->bufferLen / pStream->bytesPerFrame);
+}
+
+static void ServiceStream(Stream_t *pStream, uint32_t slack)
+{
+    if (UNKNOWN_DEADLINE != slack && slack < pStream->stats.minSlackFrames)
+        pStream->stats.minSlackFrames = slack;
+    if (0 == slack)
+        pStream->stats.queueEmpty++;
+    if (DIM2LLD_ChannelDirection_TX == pStream->dir)
+    {
+        uint8_t *pBuf = NULL;
+        uint16_t len = DIM2LLD_GetTxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_TX, pStream->instance, &pBuf);
+        len -= len % pStream->bytesPerFrame;
+        if (0 == len || NULL == pBuf || !pStream->source(pStream->pTag, pBuf, len))
+        {
+            pStream->stats.stalls++;
+            pStream->blocked = true;
+            return;
+        }
+        LevelMeter_Process(&pStream->meter, pBuf, len);
+        DIM2LLD_SendTxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_TX, pStream->instance, len);
+    }
+    else
+    {
+        const uint8_t *pBuf = NULL;
+        uint16_t len = DIM2LLD_GetRxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_RX, pStream->instance, 0, &pBuf, NULL, NULL);
+        if (0 == len || NULL == pBuf)
+        {
+            pStream->blocked = true;
+            return;
+        }
+        pStream->bufferLen = len;
+        LevelMeter_Process(&pStream->meter, pBuf, len);
+        pStream->sink(pStream->pTag, pBuf, len);
+        DIM2LLD_ReleaseRxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_RX, pStream->instance);
+    }
+    pStream->stats.buffers++;
+}
@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Synchronous Channel Scheduler                                                                  */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Services all synchronous DIM2 channels in earliest deadline
+ *         order. The deadline of a TX stream is the audio still queued
+ *         in the LLD, the deadline of a RX stream is the free space left
+ *         in its queue. A RX stream is serviced last until its first
+ *         buffer tells the buffer length. Each stream has its own source
+ *         or sink callback.
+ *         All audio passing the scheduler is level metered.
+ */
+/*----------------------------------------------------------*/
+#ifndef AUDIO_SCHED_H_
+#define AUDIO_SCHED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "dim2_lld.h"
+#include "level_meter.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define AUDIOSCHED_MAX_STREAMS      (8)
+
+/**
+ * \brief Fills a TX buffer with audio.
+ * \param pTag - The tag given with AudioSched_AddTxStream
+ * \param pBuf - The LLD buffer to fill
+ * \param len - Bytes to write, a multiple of the bytes per frame
+ * \return true, if the buffer was filled and shall be sent. false, if the source has no data yet, the stream is skipped until the next AudioSched_Service call.
+ */
+typedef bool (*AudioSched_TxSource_t)(void *pTag, uint8_t *pBuf, uint32_t len);
+
+/**
+ * \brief Consumes a received sync buffer.
+ * \param pTag - The tag given with AudioSched_AddRxStream
+ * \param pBuf - The received data, valid during the call only
+ * \param len - Length of the received data
+ */
+typedef void (*AudioSched_RxSink_t)(void *pTag, const uint8_t *pBuf, uint32_t len);
+
+typedef struct
+{
+    uint32_t buffers;       /**< Buffers sent to or taken from the LLD */
+    uint32_t stalls;        /**< TX source had no data */
+    uint32_t queueEmpty;    /**< TX queue was empty or RX queue was full when the stream got serviced */
+    uint32_t minSlackFrames;/**< Lowest deadline seen when the stream got serviced */
+} AudioSched_Stats_t;
+
+/**
+ * \brief Removes all streams.
+ * \param meterPeriodFrames - Frames over which the level meters collect peak and RMS, 0 disables metering
+ */
+void AudioSched_Init(uint32_t meterPeriodFrames);
+
+/**
+ * \brief Registers a sync TX instance.
+ * \param instance - The sync TX instance, as used with DIM2LLD_SetupChannel
+ * \param bytesPerFrame - The subSize of the channel
+ * \param source - Callback filling the buffers
+ * \param pTag - Passed to the callback
+ * \return Stream index for AudioSched_GetStats, -1 if the stream table is full.
+ */
+int8_t AudioSched_AddTxStream(uint8_t instance, uint16_t bytesPerFrame, AudioSched_TxSource_t source, void *pTag);
+
+/**
+ * \brief Registers a sync RX instance.
+ * \param instance - The sync RX instance, as used with DIM2LLD_SetupChannel
+ * \param bytesPerFrame - The subSize of the channel
+ * \param numberOfBuffers - The numberOfBuffers of the channel
+ * \param sink - Callback consuming the buffers
+ * \param pTag - Passed to the callback
+ * \return Stream index for AudioSched_GetStats, -1 if the stream table is full.
+ */
+int8_t AudioSched_AddRxStream(uint8_t instance, uint16_t bytesPerFrame, uint16_t numberOfBuffers, AudioSched_RxSink_t sink, void *pTag);
+
+/**
+ * \brief Moves buffers between the LLD and the streams, most urgent stream first, until no stream can make progress.
+ */
+void AudioSched_Service(void);
+
+/**
+ * \brief Returns the statistics of a stream.
+ * \param stream - Index returned by AudioSched_AddTxStream or AudioSched_AddRxStream
+ * \return Pointer to the statistics or NULL, if the index is invalid.
+ */
+const AudioSched_Stats_t *AudioSched_GetStats(int8_t stream);
+
+/**
+ * \brief Returns the level meter of a stream.
+ * \note LevelMeter_t::periods changes whenever new levels were published.
+ * \param stream - Index returned by AudioSched_AddTxStream or AudioSched_AddRxStream
+ * \return Pointer to the meter or NULL, if the index is invalid.
+ */
+const LevelMeter_t *AudioSched_GetLevels(int8_t stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_SCHED_H_ */
@@ -0,0 +1,430 @@
+/*------------------------------------------------------------------------------------------------*/
+/* AVB / AVTP Audio Bridge                                                                        */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include "board.h"
+#include "gmac_init.h"
+#include "timetick.h"
+#include "Console.h"
+#include "jitter_buffer.h"
+#include "sample_conv.h"
+#include "avb_bridge.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* Stream the listener accepts, 0 locks to the first AVTP audio stream seen */
+#define AVB_LISTENER_STREAM_ID          (0ull)
+/* Latency bounds of the listener jitter buffer, it adapts to the measured network jitter in between */
+#define AVB_LISTENER_MIN_LATENCY_MS     (2)
+#define AVB_LISTENER_MAX_LATENCY_MS     (20)
+/* Stream is considered lost, if no packet was received for this time */
+#define AVB_LISTENER_TIMEOUT_MS         (100)
+#define AVB_JITTER_BUFFER_SIZE          (8192)
+/* Class A: 8000 packets per second at 48kHz */
+#define AVB_TALKER_FRAMES_PER_PACKET    (6)
+#define AVB_TALKER_BUFFERS              (4)
+#define AVB_TALKER_UNIQUE_ID            (0x0001)
+/* Largest supported sync channel, 16 channels with 16 bit */
+#define AVB_MAX_BYTES_PER_FRAME         (32)
+
+static const uint8_t talkerDestMac[6] = { 0x91, 0xE0, 0xF0, 0x00, 0xFE, 0x00 };
+/* Same source address as used by the console */
+static const uint8_t talkerSrcMac[6] = { 0x02, 0x00, 0x00, 0x01, 0x01, 0x01 };
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define MOST_FRAME_RATE         (48000)
+#define ETH_HEADER_LEN          (14)
+#define VLAN_TAG_LEN            (4)
+#define ETH_TYPE_VLAN           (0x8100)
+#define ETH_TYPE_AVTP           (0x22F0)
+#define AVTP_HEADER_LEN         (24)
+#define AVTP_SUBTYPE_61883      (0x00)
+#define AVTP_SUBTYPE_AAF        (0x02)
+#define AVTP_SV                 (0x80)
+#define AAF_FORMAT_INT_32BIT    (0x02)
+#define AAF_FORMAT_INT_24BIT    (0x03)
+#define AAF_FORMAT_INT_16BIT    (0x04)
+#define AAF_NSR_48KHZ           (0x05)
+#define CIP_HEADER_LEN          (8)
+#define CIP_FMT_AM824           (0x10)
+#define STAGING_FRAMES          (64)
+#define TALKER_FRAME_LEN        (ETH_HEADER_LEN + AVTP_HEADER_LEN + AVB_TALKER_FRAMES_PER_PACKET * AVB_MAX_BYTES_PER_FRAME)
+
+#define BE16(p)                 ((uint16_t)(((p)[0] << 8) | (p)[1]))
+#define HB(value)               ((uint8_t)((uint16_t)(value) >> 8) & 0xFF)
+#define LB(value)               ((uint8_t)(value) & 0xFF)
+
+#define AVBBUFFER COMPILER_SECTION(".ram_nocache") COMPILER_ALIGNED(DEFAULT_CACHELINE)
+
+typedef struct
+{
+    sGmacd *pGmacd;
+    /* Listener */
+    uint16_t listenerBytesPerFrame;
+    bool locked;
+    uint64_t streamId;
+    uint8_t lastSeq;
+    uint32_t lastRxTime;
+    JitterBuffer_t jb;
+    /* Talker */
+    uint16_t talkerBytesPerFrame;
+    uint16_t talkerPayloadLen;
+    uint16_t talkerFill;
+    uint8_t talkerSeq;
+    uint8_t talkerIdx;
+    volatile bool talkerBusy[AVB_TALKER_BUFFERS];
+    AvbBridge_Stats_t stats;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+static uint8_t jitterMem[AVB_JITTER_BUFFER_SIZE];
+AVBBUFFER static uint8_t talkerFrames[AVB_TALKER_BUFFERS][TALKER_FRAME_LEN];
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void ProcessFrame(const uint8_t *pFrame, uint32_t len);
+static bool AcceptStream(const uint8_t *pAvtp);
+static void Depacketize(const uint8_t *pSamples, uint32_t frames, uint16_t channels, uint8_t sampleBytes, uint8_t msbOffset);
+static void InitTalkerFrame(uint8_t *pFrame);
+static void SendTalkerFrame(void);
+static void OnTalkerFrameSent(uint32_t status, void *pTag);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool AvbBridge_Init(sGmacd *pGmacd, uint16_t listenerBytesPerFrame, uint16_t talkerBytesPerFrame)
+{
+    uint8_t i;
+    assert(NULL != pGmacd);
+    memset(&m, 0, sizeof(m));
+    if (AVB_MAX_BYTES_PER_FRAME < listenerBytesPerFrame || AVB_MAX_BYTES_PER_FRAME < talkerBytesPerFrame || 0 != (listenerBytesPerFrame % 2) || 0 != (talkerBytesPerFrame % 2))
+        return false;
+    m.pGmacd = pGmacd;
+    m.listenerBytesPerFrame = listenerBytesPerFrame;
+    m.talkerBytesPerFrame = talkerBytesPerFrame;
+    if (0 != listenerBytesPerFrame)
+    {
+        JitterBuffer_Init(&m.jb, jitterMem, sizeof(jitterMem), listenerBytesPerFrame,
+            MOST_FRAME_RATE / 1000 * AVB_LISTENER_MIN_LATENCY_MS, MOST_FRAME_RATE / 1000 * AVB_LISTENER_MAX_LATENCY_MS);
+    }
+    if (0 != talkerBytesPerFrame)
+    {
+        m.talkerPayloadLen = AVB_TALKER_FRAMES_PER_PACKET * talkerBytesPerFrame;
+        for (i = 0; i < AVB_TALKER_BUFFERS; i++)
+            InitTalkerFrame(talkerFrames[i]);
+    }
+    return true;
+}
+
+void AvbBridge_Service(void)
+{
+    uint32_t idx;
+    uint32_t size;
+    if (NULL == m.pGmacd)
+        return;
+    while (GMACD_OK == GMACD_GetRxDIdx(m.pGmacd, &idx, &size, GMAC_QUE_1))
+    {
+        if (size > AVB_BUFF_SIZE)
+            size = AVB_BUFF_SIZE;
+        ProcessFrame(&gRxAvbBuffer[idx * AVB_BUFF_SIZE], size);
+        GMACD_FreeRxDTail(m.pGmacd, GMAC_QUE_1);
+    }
+    if (m.locked && AVB_LISTENER_TIMEOUT_MS < (GetTicks() - m.lastRxTime))
+    {
+        ConsolePrintf(PRIO_HIGH, YELLOW "AVB listener: stream lost, latency target was %lu us" RESETCOLOR "\r\n",
+            JitterBuffer_GetStats(&m.jb)->targetFrames * 1000 / (MOST_FRAME_RATE / 1000));
+        m.locked = false;
+        JitterBuffer_Reset(&m.jb);
+    }
+}
+
+bool AvbBridge_IsListening(void)
+{
+    return m.locked;
+}
+
+uint32_t AvbBridge_ListenerRead(uint8_t *pBuf, uint32_t len)
+{
+    assert(NULL != pBuf);
+    if (!m.locked)
+    {
+        memset(pBuf, 0, len);
+        return 0;
+    }
+    return JitterBuffer_Read(&m.jb, pBuf, len);
+}
+
+void AvbBridge_TalkerWrite(const uint8_t *pBuf, uint32_t len)
+{
+    assert(NULL != pBuf);
+    if (NULL == m.pGmacd || 0 == m.talkerBytesPerFrame)
+        return;
+    while (0 != len)
+    {
+        uint8_t *pPayload = &talkerFrames[m.talkerIdx][ETH_HEADER_LEN + AVTP_HEADER_LEN];
+        uint32_t chunk = m.talkerPayloadLen - m.talkerFill;
+        if (chunk > len)
+            chunk = len;
+        if (m.talkerBusy[m.talkerIdx])
+        {
+            /* All frames are still owned by the GMAC, drop instead of blocking the audio path */
+            m.stats.sendErrors++;
+            return;
+        }
+        memcpy(&pPayload[m.talkerFill], pBuf, chunk);
+        m.talkerFill += chunk;
+        pBuf += chunk;
+        len -= chunk;
+        if (m.talkerFill == m.talkerPayloadLen)
+            SendTalkerFrame();
+    }
+}
+
+const AvbBridge_Stats_t *AvbBridge_GetStats(void)
+{
+    return &m.stats;
+}
+
+uint32_t AvbBridge_GetListenerLatency(void)
+{
+    if (0 == m.listenerBytesPerFrame)
+        return 0;
+    return JitterBuffer_GetLatency(&m.jb) * 1000 / (MOST_FRAME_RATE / 1000);
+}
+
+const JitterBuffer_Stats_t *AvbBridge_GetListenerStats(void)
+{
+    return JitterBuffer_GetStats(&m.jb);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void ProcessFrame(const uint8_t *pFrame, uint32_t len)
+{
+    uint32_t offset = ETH_HEADER_LEN - 2;
+    const uint8_t *pAvtp;
+    uint16_t dataLen;
+    if (0 == m.listenerBytesPerFrame || len < ETH_HEADER_LEN + VLAN_TAG_LEN + AVTP_HEADER_LEN)
+        return;
+    if (ETH_TYPE_VLAN == BE16(&pFrame[offset]))
+        offset += VLAN_TAG_LEN;
+    if (ETH_TYPE_AVTP != BE16(&pFrame[offset]))
+    {
+        m.stats.packetsIgnored++;
+        return;
+    }
+    pAvtp = &pFrame[offset + 2];
+    len -= offset + 2;
+    if (!AcceptStream(pAvtp))
+    {
+        m.stats.packetsIgnored++;
+        return;
+    }
+    dataLen = BE16(&pAvtp[20]);
+    if ((uint32_t)AVTP_HEADER_LEN + dataLen > len)
+    {
+        m.stats.formatErrors++;
+        return;
+    }
+    m.stats.packetsReceived++;
+    if (AVTP_SUBTYPE_AAF == pAvtp[0])
+    {
+        uint16_t channels = ((pAvtp[17] & 0x03) << 8) | pAvtp[18];
+        uint8_t sampleBytes;
+        switch (pAvtp[16])
+        {
+        case AAF_FORMAT_INT_32BIT: sampleBytes = 4; break;
+        case AAF_FORMAT_INT_24BIT: sampleBytes = 3; break;
+        case AAF_FORMAT_INT_16BIT: sampleBytes = 2; break;
+        default: sampleBytes = 0; break;
+        }
+        if (0 == sampleBytes || 0 == channels || AAF_NSR_48KHZ != (pAvtp[17] >> 4))
+        {
+            m.stats.formatErrors++;
+            return;
+        }
+        Depacketize(&pAvtp[AVTP_HEADER_LEN], dataLen / (channels * sampleBytes), channels, sampleBytes, 0);
+    }
+    else
+    {
+        /* IEC 61883-6: CIP header followed by AM824 quadlets, label byte first, then 24 bit sample */
+        const uint8_t *pCip = &pAvtp[AVTP_HEADER_LEN];
+        uint8_t dbs = pCip[1];
+        if (CIP_HEADER_LEN > dataLen || 0 == dbs || CIP_FMT_AM824 != (pCip[4] & 0x3F))
+        {
+            m.stats.formatErrors++;
+            return;
+        }
+        Depacketize(&pCip[CIP_HEADER_LEN], (dataLen - CIP_HEADER_LEN) / (dbs * 4), dbs, 4, 1);
+    }
+}
+
+static bool AcceptStream(const uint8_t *pAvtp)
+{
+    uint64_t streamId = 0;
+    uint8_t i;
+    if (AVTP_SUBTYPE_AAF != pAvtp[0] && AVTP_SUBTYPE_61883 != pAvtp[0])
+        return false;
+    if (0 == (pAvtp[1] & AVTP_SV))
+        return false;
+    for (i = 0; i < 8; i++)
+        streamId = (streamId << 8) | pAvtp[4 + i];
+    if (!m.locked)
+    {
+        if (0 != AVB_LISTENER_STREAM_ID && AVB_LISTENER_STREAM_ID != streamId)
+            return false;
+        m.locked = true;
+        m.streamId = streamId;
+        m.lastSeq = pAvtp[2] - 1;
+        JitterBuffer_Reset(&m.jb);
+        ConsolePrintf(PRIO_HIGH, GREEN "AVB listener: locked to stream %08lX%08lX (%s)" RESETCOLOR "\r\n",
+            (uint32_t)(streamId >> 32), (uint32_t)streamId, (AVTP_SUBTYPE_AAF == pAvtp[0]) ? "AAF" : "IEC 61883-6");
+    }
+    else if (streamId != m.streamId)
+    {
+        return false;
+    }
+    if ((uint8_t)(m.lastSeq + 1) != pAvtp[2])
+        m.stats.sequenceErrors++;
+    m.lastSeq = pAvtp[2];
+    m.lastRxTime = GetTicks();
+    return true;
+}
+
+static void Depacketize(const uint8_t *pSamples, uint32_t frames, uint16_t channels, uint8_t sampleBytes, uint8_t msbOffset)
+{
+    uint8_t staging[STAGING_FRAMES * AVB_MAX_BYTES_PER_FRAME];
+    uint16_t sinkChannels = m.listenerBytesPerFrame / 2;
+    uint32_t stagingFrames = sizeof(staging) / m.listenerBytesPerFrame;
+    SampleConv_Format_t srcFormat = (2 == sampleBytes) ? SampleConv_S16BE : ((3 == sampleBytes) ? SampleConv_S24BE : SampleConv_S32BE);
+    while (0 != frames)
+    {
+        uint32_t count = (frames < stagingFrames) ? frames : stagingFrames;
+        uint8_t *pOut = staging;
+        uint32_t f;
+        if (channels == sinkChannels && 0 == msbOffset)
+        {
+            /* Channel layout matches, only the sample width has to be converted */
+            SampleConv_Convert(staging, SampleConv_S16BE, pSamples, srcFormat, count * channels);
+            pSamples += count * channels * sampleBytes;
+        }
+        else
+        {
+            for (f = 0; f < count; f++)
+            {
+                uint16_t ch;
+                /* Network samples are big endian like MOST, keep the upper 16 bit of each sample */
+                for (ch = 0; ch < sinkChannels; ch++)
+                {
+                    if (ch < channels)
+                    {
+                        const uint8_t *pSample = &pSamples[ch * sampleBytes + msbOffset];
+                        *pOut++ = pSample[0];
+                        *pOut++ = pSample[1];
+                    }
+                    else
+                    {
+                        *pOut++ = 0;
+                        *pOut++ = 0;
+                    }
+                }
+                pSamples += channels * sampleBytes;
+            }
+        }
+        JitterBuffer_Write(&m.jb, staging, count * m.listenerBytesPerFrame);
+        frames -= count;
+    }
+}
+
+static void InitTalkerFrame(uint8_t *pFrame)
+{
+    uint16_t channels = m.talkerBytesPerFrame / 2;
+    uint8_t *pAvtp = &pFrame[ETH_HEADER_LEN];
+    memset(pFrame, 0, TALKER_FRAME_LEN);
+    memcpy(&pFrame[0], talkerDestMac, sizeof(talkerDestMac));
+    memcpy(&pFrame[6], talkerSrcMac, sizeof(talkerSrcMac));
+    pFrame[12] = HB(ETH_TYPE_AVTP);
+    pFrame[13] = LB(ETH_TYPE_AVTP);
+    pAvtp[0] = AVTP_SUBTYPE_AAF;
+    pAvtp[1] = AVTP_SV;
+    /* Stream ID: source MAC followed by the unique ID */
+    memcpy(&pAvtp[4], talkerSrcMac, sizeof(talkerSrcMac));
+    pAvtp[10] = HB(AVB_TALKER_UNIQUE_ID);
+    pAvtp[11] = LB(AVB_TALKER_UNIQUE_ID);
+    /* There is no gPTP time base, timestamps are marked invalid (tv = 0) */
+    pAvtp[16] = AAF_FORMAT_INT_16BIT;
+    pAvtp[17] = (AAF_NSR_48KHZ << 4) | ((channels >> 8) & 0x03);
+    pAvtp[18] = LB(channels);
+    pAvtp[19] = 16;
+    pAvtp[20] = HB(m.talkerPayloadLen);
+    pAvtp[21] = LB(m.talkerPayloadLen);
+}
+
+static void SendTalkerFrame(void)
+{
+    uint8_t idx = m.talkerIdx;
+    uint8_t *pFrame = talkerFrames[idx];
+    pFrame[ETH_HEADER_LEN + 2] = m.talkerSeq++;
+    m.talkerBusy[idx] = true;
+    if (GMACD_OK == GMACD_Send(m.pGmacd, pFrame, ETH_HEADER_LEN + AVTP_HEADER_LEN + m.talkerPayloadLen,
+        OnTalkerFrameSent, (void *)&m.talkerBusy[idx], GMAC_QUE_1))
+    {
+        m.stats.packetsSent++;
+    }
+    else
+    {
+        m.talkerBusy[idx] = false;
+        m.stats.sendErrors++;
+    }
+    m.talkerFill = 0;
+    m.talkerIdx = (idx + 1) % AVB_TALKER_BUFFERS;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                  CALLBACK FUNCTIONS FROM GMAC                        */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void OnTalkerFrameSent(uint32_t status, void *pTag)
+{
+    volatile bool *pBusy = (volatile bool *)pTag;
+    assert(NULL != pBusy);
+    *pBusy = false;
+}
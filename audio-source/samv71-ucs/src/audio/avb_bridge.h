@@ -0,0 +1,124 @@
+/*------------------------------------------------------------------------------------------------*/
+/* AVB / AVTP Audio Bridge                                                                        */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Ethernet AVB to MOST audio gateway.
+ *         The listener depacketizes AVTP audio streams (AAF PCM or
+ *         IEC 61883-6 AM824) from the GMAC AVB queue into a jitter
+ *         buffer, which is drained by a sync TX channel.
+ *         The talker packetizes sync RX data into an AAF stream.
+ */
+/*----------------------------------------------------------*/
+#ifndef AVB_BRIDGE_H_
+#define AVB_BRIDGE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gmacd.h"
+#include "jitter_buffer.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+typedef struct
+{
+    uint32_t packetsReceived;
+    uint32_t packetsIgnored;
+    uint32_t sequenceErrors;
+    uint32_t formatErrors;
+    uint32_t packetsSent;
+    uint32_t sendErrors;
+} AvbBridge_Stats_t;
+
+/**
+ * \brief Initializes the AVB bridge.
+ * \note init_gmac must have been called before.
+ * \param pGmacd - The GMAC driver instance
+ * \param listenerBytesPerFrame - subSize of the sync TX channel fed by the listener (16 bit big endian samples), 0 disables the listener
+ * \param talkerBytesPerFrame - subSize of the sync RX channel fed into the talker (16 bit big endian samples), 0 disables the talker
+ * \return true, if initialization was successful. false, otherwise.
+ */
+bool AvbBridge_Init(sGmacd *pGmacd, uint16_t listenerBytesPerFrame, uint16_t talkerBytesPerFrame);
+
+/**
+ * \brief Processes received AVB frames. Must be called cyclic from task context.
+ */
+void AvbBridge_Service(void);
+
+/**
+ * \brief Checks if the listener is locked to an AVTP stream.
+ * \return true, if AvbBridge_ListenerRead delivers network audio.
+ */
+bool AvbBridge_IsListening(void);
+
+/**
+ * \brief Fills a sync TX buffer with audio received from the network.
+ * \param pBuf - The buffer retrieved by DIM2LLD_GetTxData
+ * \param len - Length of pBuf, it is always filled completely (silence on underrun)
+ * \return Amount of bytes, which were network audio.
+ */
+uint32_t AvbBridge_ListenerRead(uint8_t *pBuf, uint32_t len);
+
+/**
+ * \brief Passes sync RX data to the talker.
+ * \param pBuf - The buffer retrieved by DIM2LLD_GetRxData
+ * \param len - Length of pBuf
+ */
+void AvbBridge_TalkerWrite(const uint8_t *pBuf, uint32_t len);
+
+/**
+ * \brief Returns the statistics since AvbBridge_Init.
+ * \return Pointer to the statistic counters.
+ */
+const AvbBridge_Stats_t *AvbBridge_GetStats(void);
+
+/**
+ * \brief Returns the audio currently buffered between network and sync channel.
+ * \return Latency in microseconds.
+ */
+uint32_t AvbBridge_GetListenerLatency(void);
+
+/**
+ * \brief Returns the statistics of the listener jitter buffer (jitter, latency target, dropped and repeated frames).
+ * \return Pointer to the statistics.
+ */
+const JitterBuffer_Stats_t *AvbBridge_GetListenerStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVB_BRIDGE_H_ */
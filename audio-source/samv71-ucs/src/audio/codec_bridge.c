@@ -0,0 +1,396 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Local Codec Bridge Implementation                                                              */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include "board.h"
+#include "board_init.h"
+#include "wm8904.h"
+#include "sample_conv.h"
+#include "codec_bridge.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* Frames of one ping-pong half, also the latency target of both paths. Sync buffers (bufferSize / subSize) must be smaller. */
+#define CODEC_BLOCK_FRAMES          (256)
+/* Deviation of the filtered ring fill from its target, before a frame is dropped or repeated */
+#define CODEC_DRIFT_TOLERANCE       (16)
+/* Minimum number of buffers between two drift corrections */
+#define CODEC_ADJUST_SPACING        (8)
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* The codec interface is always 16 bit stereo, stored little endian by the DMA */
+#define FRAME_BYTES             (4)
+#define RING_FRAMES             (2 * CODEC_BLOCK_FRAMES)
+#define TARGET_FRAMES           (CODEC_BLOCK_FRAMES)
+/* Minimum distance between the CPU and the DMA position */
+#define GUARD_FRAMES            (16)
+#define FILL_FILTER_SHIFT       (4)
+
+#define CODECBUFFER COMPILER_SECTION(".ram_nocache") COMPILER_ALIGNED(DEFAULT_CACHELINE)
+
+typedef struct
+{
+    uint32_t dmaChannel;
+    uint16_t bytesPerFrame;
+    bool synced;
+    uint16_t holdOff;
+    uint32_t cpuPos;
+    uint32_t filteredFill;
+    uint8_t *pRing;
+    LinkedListDescriporView1 *pDesc;
+    CodecBridge_PathStats_t *pStats;
+} Path_t;
+
+typedef struct
+{
+    Path_t sink;
+    Path_t source;
+    CodecBridge_Stats_t stats;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+CODECBUFFER static uint8_t sinkRing[RING_FRAMES * FRAME_BYTES];
+CODECBUFFER static uint8_t sourceRing[RING_FRAMES * FRAME_BYTES];
+CODECBUFFER static LinkedListDescriporView1 sinkDesc[2];
+CODECBUFFER static LinkedListDescriporView1 sourceDesc[2];
+static const Pin sscPins[] = PINS_SSC_CODEC;
+static const Pin mclkPin = PIN_PCK2;
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool StartPath(Path_t *pPath, bool sink);
+static uint32_t GetDmaPos(const Path_t *pPath, bool sink);
+static void Resync(Path_t *pPath, uint32_t cpuPos);
+static int8_t TrackDrift(Path_t *pPath, uint32_t fill);
+static void WriteRing(Path_t *pPath, const uint8_t *pSrc, uint32_t frames);
+static void ReadRing(Path_t *pPath, uint8_t *pDst, uint32_t frames);
+static void ToCodec(uint8_t *pDst, const uint8_t *pSrc, uint32_t frames, uint16_t bytesPerFrame);
+static void FromCodec(uint8_t *pDst, const uint8_t *pSrc, uint32_t frames, uint16_t bytesPerFrame);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool CodecBridge_Init(uint16_t sinkBytesPerFrame, uint16_t sourceBytesPerFrame)
+{
+    memset(&m, 0, sizeof(m));
+    m.sink.pRing = sinkRing;
+    m.sink.pDesc = sinkDesc;
+    m.sink.pStats = &m.stats.sink;
+    m.source.pRing = sourceRing;
+    m.source.pDesc = sourceDesc;
+    m.source.pStats = &m.stats.source;
+    if (0 == sinkBytesPerFrame && 0 == sourceBytesPerFrame)
+        return true;
+    if (0 != (sinkBytesPerFrame % 2) || 0 != (sourceBytesPerFrame % 2))
+        return false;
+    PIO_Configure(&mclkPin, 1);
+    PIO_Configure(sscPins, PIO_LISTSIZE(sscPins));
+    /* The codec is the clock master, it must be running before SSC gets enabled */
+    if (!WM8904_Init(&twid))
+        return false;
+    /* I2S slave: each LRCLK falling edge starts a frame with two 16 bit words, left channel first */
+    SSC_Configure(SSC, 0, BOARD_MCK);
+    SSC_ConfigureTransmitter(SSC,
+        SSC_TCMR_CKS_TK | SSC_TCMR_CKO_NONE | SSC_TCMR_START_TF_FALLING | SSC_TCMR_STTDLY(1),
+        SSC_TFMR_DATLEN(15) | SSC_TFMR_MSBF | SSC_TFMR_DATNB(1));
+    SSC_ConfigureReceiver(SSC,
+        SSC_RCMR_CKS_RK | SSC_RCMR_CKO_NONE | SSC_RCMR_CKI | SSC_RCMR_START_RF_FALLING | SSC_RCMR_STTDLY(1),
+        SSC_RFMR_DATLEN(15) | SSC_RFMR_MSBF | SSC_RFMR_DATNB(1));
+    if (0 != sinkBytesPerFrame)
+    {
+        if (!StartPath(&m.sink, true))
+            return false;
+        m.sink.bytesPerFrame = sinkBytesPerFrame;
+        SSC_EnableTransmitter(SSC);
+    }
+    if (0 != sourceBytesPerFrame)
+    {
+        if (!StartPath(&m.source, false))
+            return false;
+        m.source.bytesPerFrame = sourceBytesPerFrame;
+        SSC_EnableReceiver(SSC);
+    }
+    return true;
+}
+
+void CodecBridge_SinkWrite(const uint8_t *pBuf, uint32_t len)
+{
+    Path_t *pPath = &m.sink;
+    uint32_t frames, dmaPos, fill;
+    int8_t correction;
+    assert(NULL != pBuf);
+    if (0 == pPath->bytesPerFrame)
+        return;
+    frames = len / pPath->bytesPerFrame;
+    if (RING_FRAMES - TARGET_FRAMES - GUARD_FRAMES < frames)
+        frames = RING_FRAMES - TARGET_FRAMES - GUARD_FRAMES;
+    if (0 == frames)
+        return;
+    dmaPos = GetDmaPos(pPath, true);
+    fill = (pPath->cpuPos + RING_FRAMES - dmaPos) % RING_FRAMES;
+    /* DMA caught up with the written data, or there is no room left for this buffer */
+    if (!pPath->synced || GUARD_FRAMES > fill || RING_FRAMES < fill + frames + GUARD_FRAMES)
+    {
+        Resync(pPath, (dmaPos + TARGET_FRAMES) % RING_FRAMES);
+        fill = TARGET_FRAMES;
+    }
+    correction = TrackDrift(pPath, fill);
+    if (0 < correction && 1 < frames)
+    {
+        frames--;
+        pPath->pStats->framesDropped++;
+    }
+    WriteRing(pPath, pBuf, frames);
+    if (0 > correction)
+    {
+        WriteRing(pPath, &pBuf[(frames - 1) * pPath->bytesPerFrame], 1);
+        pPath->pStats->framesInserted++;
+    }
+}
+
+void CodecBridge_SourceRead(uint8_t *pBuf, uint32_t len)
+{
+    Path_t *pPath = &m.source;
+    uint32_t frames, dmaPos, fill;
+    int8_t correction;
+    assert(NULL != pBuf);
+    if (0 == pPath->bytesPerFrame)
+        return;
+    frames = len / pPath->bytesPerFrame;
+    if (TARGET_FRAMES - GUARD_FRAMES < frames)
+        frames = TARGET_FRAMES - GUARD_FRAMES;
+    if (0 == frames)
+        return;
+    dmaPos = GetDmaPos(pPath, false);
+    fill = (dmaPos + RING_FRAMES - pPath->cpuPos) % RING_FRAMES;
+    /* Not enough captured data for this buffer, or DMA is about to overwrite unread data */
+    if (!pPath->synced || fill < frames + GUARD_FRAMES || RING_FRAMES < fill + GUARD_FRAMES)
+    {
+        Resync(pPath, (dmaPos + RING_FRAMES - TARGET_FRAMES) % RING_FRAMES);
+        fill = TARGET_FRAMES;
+    }
+    correction = TrackDrift(pPath, fill);
+    if (0 < correction)
+    {
+        pPath->cpuPos = (pPath->cpuPos + 1) % RING_FRAMES;
+        pPath->pStats->framesDropped++;
+    }
+    if (0 > correction && 1 < frames)
+    {
+        ReadRing(pPath, pBuf, frames - 1);
+        memcpy(&pBuf[(frames - 1) * pPath->bytesPerFrame], &pBuf[(frames - 2) * pPath->bytesPerFrame], pPath->bytesPerFrame);
+        pPath->pStats->framesInserted++;
+    }
+    else
+    {
+        ReadRing(pPath, pBuf, frames);
+    }
+    /* Buffers larger than supported are filled up with silence */
+    if (frames * pPath->bytesPerFrame < len)
+        memset(&pBuf[frames * pPath->bytesPerFrame], 0, len - frames * pPath->bytesPerFrame);
+}
+
+bool CodecBridge_IsSourceActive(void)
+{
+    return (0 != m.source.bytesPerFrame);
+}
+
+const CodecBridge_Stats_t *CodecBridge_GetStats(void)
+{
+    return &m.stats;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool StartPath(Path_t *pPath, bool sink)
+{
+    sXdmadCfg cfg;
+    uint8_t i;
+    if (sink)
+        pPath->dmaChannel = XDMAD_AllocateChannel(&xdma, XDMAD_TRANSFER_MEMORY, ID_SSC);
+    else
+        pPath->dmaChannel = XDMAD_AllocateChannel(&xdma, ID_SSC, XDMAD_TRANSFER_MEMORY);
+    if (XDMAD_ALLOC_FAILED == pPath->dmaChannel)
+        return false;
+    XDMAD_PrepareChannel(&xdma, pPath->dmaChannel);
+    memset(pPath->pRing, 0, RING_FRAMES * FRAME_BYTES);
+    /* Two descriptors pointing to each other, the DMA runs endlessly over the ring */
+    for (i = 0; i < 2; i++)
+    {
+        uint32_t block = (uint32_t)&pPath->pRing[i * CODEC_BLOCK_FRAMES * FRAME_BYTES];
+        pPath->pDesc[i].mbr_nda = (uint32_t)&pPath->pDesc[1 - i];
+        pPath->pDesc[i].mbr_ubc = XDMA_UBC_NVIEW_NDV1 | XDMA_UBC_NDE_FETCH_EN | XDMA_UBC_NSEN_UPDATED
+            | XDMA_UBC_NDEN_UPDATED | (CODEC_BLOCK_FRAMES * FRAME_BYTES / 2);
+        pPath->pDesc[i].mbr_sa = sink ? block : (uint32_t)&SSC->SSC_RHR;
+        pPath->pDesc[i].mbr_da = sink ? (uint32_t)&SSC->SSC_THR : block;
+    }
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.mbr_cfg = XDMAC_CC_TYPE_PER_TRAN
+        | XDMAC_CC_MBSIZE_SINGLE
+        | XDMAC_CC_CSIZE_CHK_1
+        | XDMAC_CC_DWIDTH_HALFWORD
+        | XDMAC_CC_SIF_AHB_IF1
+        | XDMAC_CC_DIF_AHB_IF1;
+    if (sink)
+        cfg.mbr_cfg |= XDMAC_CC_DSYNC_MEM2PER | XDMAC_CC_SAM_INCREMENTED_AM | XDMAC_CC_DAM_FIXED_AM
+            | XDMAC_CC_PERID(XDMAIF_Get_ChannelNumber(ID_SSC, XDMAD_TRANSFER_TX));
+    else
+        cfg.mbr_cfg |= XDMAC_CC_DSYNC_PER2MEM | XDMAC_CC_SAM_FIXED_AM | XDMAC_CC_DAM_INCREMENTED_AM
+            | XDMAC_CC_PERID(XDMAIF_Get_ChannelNumber(ID_SSC, XDMAD_TRANSFER_RX));
+    if (XDMAD_OK != XDMAD_ConfigureTransfer(&xdma, pPath->dmaChannel, &cfg,
+        XDMAC_CNDC_NDVIEW_NDV1 | XDMAC_CNDC_NDE_DSCR_FETCH_EN | XDMAC_CNDC_NDSUP_SRC_PARAMS_UPDATED | XDMAC_CNDC_NDDUP_DST_PARAMS_UPDATED,
+        (uint32_t)&pPath->pDesc[0], 0))
+    {
+        return false;
+    }
+    return (XDMAD_OK == XDMAD_StartTransfer(&xdma, pPath->dmaChannel));
+}
+
+static uint32_t GetDmaPos(const Path_t *pPath, bool sink)
+{
+    Xdmac *pXdmac = xdma.pXdmacs;
+    uint8_t ch = pPath->dmaChannel & 0xFF;
+    uint32_t addr = sink ? pXdmac->XDMAC_CHID[ch].XDMAC_CSA : pXdmac->XDMAC_CHID[ch].XDMAC_CDA;
+    return ((addr - (uint32_t)pPath->pRing) / FRAME_BYTES) % RING_FRAMES;
+}
+
+static void Resync(Path_t *pPath, uint32_t cpuPos)
+{
+    if (pPath->synced)
+        pPath->pStats->resyncs++;
+    pPath->synced = true;
+    pPath->cpuPos = cpuPos;
+    pPath->filteredFill = (uint32_t)TARGET_FRAMES << FILL_FILTER_SHIFT;
+    pPath->holdOff = CODEC_ADJUST_SPACING;
+}
+
+/* Returns 1, if a frame shall be skipped, -1 if a frame shall be repeated, 0 otherwise */
+static int8_t TrackDrift(Path_t *pPath, uint32_t fill)
+{
+    uint32_t avg;
+    /* The fill is sampled once per buffer, the filter removes the scheduling jitter */
+    pPath->filteredFill += fill - (pPath->filteredFill >> FILL_FILTER_SHIFT);
+    avg = pPath->filteredFill >> FILL_FILTER_SHIFT;
+    pPath->pStats->fillFrames = avg;
+    if (0 != pPath->holdOff)
+    {
+        pPath->holdOff--;
+        return 0;
+    }
+    if (TARGET_FRAMES + CODEC_DRIFT_TOLERANCE < avg)
+    {
+        pPath->holdOff = CODEC_ADJUST_SPACING;
+        return 1;
+    }
+    if (avg + CODEC_DRIFT_TOLERANCE < TARGET_FRAMES)
+    {
+        pPath->holdOff = CODEC_ADJUST_SPACING;
+        return -1;
+    }
+    return 0;
+}
+
+static void WriteRing(Path_t *pPath, const uint8_t *pSrc, uint32_t frames)
+{
+    while (0 != frames)
+    {
+        uint32_t chunk = RING_FRAMES - pPath->cpuPos;
+        if (chunk > frames)
+            chunk = frames;
+        ToCodec(&pPath->pRing[pPath->cpuPos * FRAME_BYTES], pSrc, chunk, pPath->bytesPerFrame);
+        pPath->cpuPos = (pPath->cpuPos + chunk) % RING_FRAMES;
+        pSrc += chunk * pPath->bytesPerFrame;
+        frames -= chunk;
+    }
+}
+
+static void ReadRing(Path_t *pPath, uint8_t *pDst, uint32_t frames)
+{
+    while (0 != frames)
+    {
+        uint32_t chunk = RING_FRAMES - pPath->cpuPos;
+        if (chunk > frames)
+            chunk = frames;
+        FromCodec(pDst, &pPath->pRing[pPath->cpuPos * FRAME_BYTES], chunk, pPath->bytesPerFrame);
+        pPath->cpuPos = (pPath->cpuPos + chunk) % RING_FRAMES;
+        pDst += chunk * pPath->bytesPerFrame;
+        frames -= chunk;
+    }
+}
+
+/* MOST carries big endian samples, the DMA moves little endian half words */
+static void ToCodec(uint8_t *pDst, const uint8_t *pSrc, uint32_t frames, uint16_t bytesPerFrame)
+{
+    if (FRAME_BYTES == bytesPerFrame)
+    {
+        SampleConv_Swap16(pDst, pSrc, frames * 2);
+        return;
+    }
+    if (2 == bytesPerFrame)
+    {
+        SampleConv_MonoToStereo16(pDst, pSrc, frames);
+        SampleConv_Swap16(pDst, pDst, frames * 2);
+        return;
+    }
+    for (; 0 != frames; frames--)
+    {
+        SampleConv_Swap16(pDst, pSrc, 2);
+        pDst += FRAME_BYTES;
+        pSrc += bytesPerFrame;
+    }
+}
+
+static void FromCodec(uint8_t *pDst, const uint8_t *pSrc, uint32_t frames, uint16_t bytesPerFrame)
+{
+    if (FRAME_BYTES == bytesPerFrame)
+    {
+        SampleConv_Swap16(pDst, pSrc, frames * 2);
+        return;
+    }
+    if (FRAME_BYTES < bytesPerFrame)
+        memset(pDst, 0, frames * bytesPerFrame);
+    for (; 0 != frames; frames--)
+    {
+        SampleConv_Swap16(pDst, pSrc, (2 == bytesPerFrame) ? 1 : 2);
+        pDst += bytesPerFrame;
+        pSrc += FRAME_BYTES;
+    }
+}
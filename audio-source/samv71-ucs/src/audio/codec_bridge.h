@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Local Codec Bridge                                                                             */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Connects sync channels to the WM8904 codec of the board.
+ *         The sink plays a sync stream on the headphone output, the
+ *         source captures the line input into a sync TX stream.
+ *         SSC is served by XDMAC linked lists running in circles
+ *         over ping-pong buffers, no interrupts are involved.
+ *         The codec runs on its own clock. The drift against the
+ *         MOST frame clock is compensated by dropping or repeating
+ *         single frames whenever the ring fill leaves its target.
+ */
+/*----------------------------------------------------------*/
+#ifndef CODEC_BRIDGE_H_
+#define CODEC_BRIDGE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+typedef struct
+{
+    uint32_t framesDropped;     /**< Drift compensation, codec clock slower than MOST */
+    uint32_t framesInserted;    /**< Drift compensation, codec clock faster than MOST */
+    uint32_t resyncs;           /**< Ring ran empty or full, the read and write position were set apart again */
+    uint32_t fillFrames;        /**< Filtered ring fill, the latency of the path */
+} CodecBridge_PathStats_t;
+
+typedef struct
+{
+    CodecBridge_PathStats_t sink;
+    CodecBridge_PathStats_t source;
+} CodecBridge_Stats_t;
+
+/**
+ * \brief Initializes the codec, SSC and the DMA rings.
+ * \note The TWI and XDMAC drivers must be initialized (Board_Init). Blocks during the codec power up.
+ * \param sinkBytesPerFrame - subSize of the sync channel played on the headphone (16 bit big endian samples), 0 disables the sink
+ * \param sourceBytesPerFrame - subSize of the sync TX channel fed by the line input (16 bit big endian samples), 0 disables the source
+ * \return true, if initialization was successful. false, otherwise.
+ */
+bool CodecBridge_Init(uint16_t sinkBytesPerFrame, uint16_t sourceBytesPerFrame);
+
+/**
+ * \brief Passes sync data to the headphone output.
+ * \note Mono channels are played on both sides, of wider channels the first two are played.
+ * \param pBuf - Sync data as sent to or received from the LLD
+ * \param len - Length of pBuf, a multiple of the bytes per frame
+ */
+void CodecBridge_SinkWrite(const uint8_t *pBuf, uint32_t len);
+
+/**
+ * \brief Fills a sync TX buffer with audio from the line input.
+ * \note Mono channels get the left input, wider channels get the input on the first two channels.
+ * \param pBuf - The buffer retrieved by DIM2LLD_GetTxData
+ * \param len - Length of pBuf, a multiple of the bytes per frame
+ */
+void CodecBridge_SourceRead(uint8_t *pBuf, uint32_t len);
+
+/**
+ * \brief Checks if the source delivers audio.
+ * \return true, if CodecBridge_SourceRead may be used.
+ */
+bool CodecBridge_IsSourceActive(void);
+
+/**
+ * \brief Returns the statistics of the bridge.
+ * \return Pointer to the statistics.
+ */
+const CodecBridge_Stats_t *CodecBridge_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CODEC_BRIDGE_H_ */
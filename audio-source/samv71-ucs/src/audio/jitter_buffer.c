@@ -0,0 +1,273 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Audio Jitter Buffer                                                                            */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include "jitter_buffer.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void CopyIn(JitterBuffer_t *pJb, const uint8_t *pData, uint32_t len);
+static void CopyOut(JitterBuffer_t *pJb, uint8_t *pData, uint32_t len);
+static uint32_t ReadFrames(JitterBuffer_t *pJb, uint8_t *pData, uint32_t len);
+static void TrackLevel(JitterBuffer_t *pJb);
+static void UpdateWindow(JitterBuffer_t *pJb, uint32_t readLen);
+static void SetTarget(JitterBuffer_t *pJb, uint32_t target);
+static void StartWindow(JitterBuffer_t *pJb);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void JitterBuffer_Init(JitterBuffer_t *pJb, uint8_t *pMem, uint32_t size, uint16_t bytesPerFrame, uint32_t minLatencyFrames, uint32_t maxLatencyFrames)
+{
+    assert(NULL != pJb && NULL != pMem);
+    assert(0 != bytesPerFrame && bytesPerFrame <= size);
+    assert(minLatencyFrames <= maxLatencyFrames);
+    memset(pJb, 0, sizeof(JitterBuffer_t));
+    pJb->pMem = pMem;
+    pJb->bytesPerFrame = bytesPerFrame;
+    pJb->size = size - (size % bytesPerFrame);
+    pJb->maxLatency = maxLatencyFrames * bytesPerFrame;
+    if (pJb->maxLatency > pJb->size)
+        pJb->maxLatency = pJb->size;
+    pJb->minLatency = minLatencyFrames * bytesPerFrame;
+    if (pJb->minLatency > pJb->maxLatency)
+        pJb->minLatency = pJb->maxLatency;
+    /* Start safe, the measurement lowers the latency afterwards */
+    SetTarget(pJb, pJb->maxLatency);
+    StartWindow(pJb);
+}
+
+void JitterBuffer_Reset(JitterBuffer_t *pJb)
+{
+    assert(NULL != pJb);
+    pJb->rdPos = 0;
+    pJb->wrPos = 0;
+    pJb->level = 0;
+    pJb->running = false;
+    pJb->adjustFrames = 0;
+    StartWindow(pJb);
+}
+
+uint32_t JitterBuffer_Write(JitterBuffer_t *pJb, const uint8_t *pData, uint32_t len)
+{
+    uint32_t space;
+    assert(NULL != pJb && NULL != pData);
+    len -= len % pJb->bytesPerFrame;
+    space = pJb->size - pJb->level;
+    if (len > space)
+    {
+        len = space;
+        pJb->stats.overflows++;
+    }
+    CopyIn(pJb, pData, len);
+    pJb->level += len;
+    pJb->stats.bytesWritten += len;
+    if (pJb->running)
+        TrackLevel(pJb);
+    if (!pJb->running && pJb->level >= pJb->target)
+    {
+        pJb->running = true;
+        StartWindow(pJb);
+    }
+    return len;
+}
+
+uint32_t JitterBuffer_Read(JitterBuffer_t *pJb, uint8_t *pData, uint32_t len)
+{
+    uint32_t avail = 0;
+    assert(NULL != pJb && NULL != pData);
+    len -= len % pJb->bytesPerFrame;
+    if (pJb->running)
+    {
+        avail = ReadFrames(pJb, pData, len);
+        TrackLevel(pJb);
+        UpdateWindow(pJb, len);
+        if (avail < len)
+        {
+            pJb->stats.underruns++;
+            /* The jitter was underestimated: raise the latency by one read and build it up again,
+             * otherwise every following buffer would underrun as well */
+            SetTarget(pJb, pJb->target + len);
+            pJb->adjustFrames = 0;
+            pJb->running = false;
+        }
+    }
+    if (avail < len)
+        memset(&pData[avail], 0, len - avail);
+    return avail;
+}
+
+uint32_t JitterBuffer_GetLevel(const JitterBuffer_t *pJb)
+{
+    assert(NULL != pJb);
+    return pJb->level;
+}
+
+uint32_t JitterBuffer_GetLatency(const JitterBuffer_t *pJb)
+{
+    assert(NULL != pJb);
+    return pJb->level / pJb->bytesPerFrame;
+}
+
+const JitterBuffer_Stats_t *JitterBuffer_GetStats(const JitterBuffer_t *pJb)
+{
+    assert(NULL != pJb);
+    return &pJb->stats;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void CopyIn(JitterBuffer_t *pJb, const uint8_t *pData, uint32_t len)
+{
+    uint32_t first = pJb->size - pJb->wrPos;
+    if (first > len)
+        first = len;
+    memcpy(&pJb->pMem[pJb->wrPos], pData, first);
+    memcpy(pJb->pMem, &pData[first], len - first);
+    pJb->wrPos = (pJb->wrPos + len) % pJb->size;
+}
+
+static void CopyOut(JitterBuffer_t *pJb, uint8_t *pData, uint32_t len)
+{
+    uint32_t first = pJb->size - pJb->rdPos;
+    if (first > len)
+        first = len;
+    memcpy(pData, &pJb->pMem[pJb->rdPos], first);
+    memcpy(&pData[first], pJb->pMem, len - first);
+    pJb->rdPos = (pJb->rdPos + len) % pJb->size;
+    pJb->level -= len;
+    pJb->stats.bytesRead += len;
+}
+
+/* Copies len bytes, dropping or repeating one frame every JITTERBUFFER_ADJUST_SPACING frames while a correction is pending */
+static uint32_t ReadFrames(JitterBuffer_t *pJb, uint8_t *pData, uint32_t len)
+{
+    uint32_t bytesPerFrame = pJb->bytesPerFrame;
+    uint32_t spacing = JITTERBUFFER_ADJUST_SPACING * bytesPerFrame;
+    uint32_t done = 0;
+    while (done < len)
+    {
+        uint32_t chunk = len - done;
+        if (0 != pJb->adjustFrames && pJb->sinceAdjust >= spacing)
+        {
+            pJb->sinceAdjust = 0;
+            if (0 > pJb->adjustFrames)
+            {
+                /* Repeat the frame read last, it is still in the ring as the level is low */
+                uint32_t last = (pJb->rdPos + pJb->size - bytesPerFrame) % pJb->size;
+                memcpy(&pData[done], &pJb->pMem[last], bytesPerFrame);
+                done += bytesPerFrame;
+                pJb->adjustFrames++;
+                pJb->stats.framesInserted++;
+                continue;
+            }
+            if (pJb->level > bytesPerFrame)
+            {
+                pJb->rdPos = (pJb->rdPos + bytesPerFrame) % pJb->size;
+                pJb->level -= bytesPerFrame;
+                pJb->adjustFrames--;
+                pJb->stats.framesDropped++;
+            }
+        }
+        if (0 != pJb->adjustFrames && chunk > spacing - pJb->sinceAdjust)
+            chunk = spacing - pJb->sinceAdjust;
+        if (chunk > pJb->level)
+            chunk = pJb->level;
+        if (0 == chunk)
+            break;
+        CopyOut(pJb, &pData[done], chunk);
+        pJb->sinceAdjust += chunk;
+        done += chunk;
+    }
+    return done;
+}
+
+/* Called after every write and read, so the window sees the peaks left by write bursts as well as the
+ * lows left by the reader */
+static void TrackLevel(JitterBuffer_t *pJb)
+{
+    if (pJb->level < pJb->winMin)
+        pJb->winMin = pJb->level;
+    if (pJb->level > pJb->winMax)
+        pJb->winMax = pJb->level;
+}
+
+/* At the end of each window the target latency is derived from the level variation, and the drift of the
+ * lowest level from where it should be is scheduled as correction. */
+static void UpdateWindow(JitterBuffer_t *pJb, uint32_t readLen)
+{
+    uint32_t jitter;
+    int32_t error;
+    int32_t limit = JITTERBUFFER_WINDOW_FRAMES / JITTERBUFFER_ADJUST_SPACING;
+    pJb->winRead += readLen;
+    if (pJb->winRead < JITTERBUFFER_WINDOW_FRAMES * pJb->bytesPerFrame)
+        return;
+    jitter = pJb->winMax - pJb->winMin;
+    pJb->stats.jitterFrames = jitter / pJb->bytesPerFrame;
+    /* The variation between the highest level after a write and the lowest after a read already includes the
+     * read size, a quarter of it is added as safety margin */
+    SetTarget(pJb, jitter + jitter / 4 + pJb->bytesPerFrame);
+    /* Lowest level should be target - jitter, positive error means too much latency */
+    error = ((int32_t)pJb->winMin - ((int32_t)pJb->target - (int32_t)jitter)) / (int32_t)pJb->bytesPerFrame;
+    /* Correct half of the error per window and ignore small errors, the measurement itself is noisy */
+    if (error * 8 < (int32_t)pJb->stats.jitterFrames && error * 8 > -(int32_t)pJb->stats.jitterFrames)
+        error = 0;
+    error /= 2;
+    if (error > limit)
+        error = limit;
+    else if (error < -limit)
+        error = -limit;
+    StartWindow(pJb);
+    pJb->adjustFrames = error;
+}
+
+static void SetTarget(JitterBuffer_t *pJb, uint32_t target)
+{
+    if (target < pJb->minLatency)
+        target = pJb->minLatency;
+    if (target > pJb->maxLatency)
+        target = pJb->maxLatency;
+    pJb->target = target - (target % pJb->bytesPerFrame);
+    pJb->stats.targetFrames = pJb->target / pJb->bytesPerFrame;
+}
+
+static void StartWindow(JitterBuffer_t *pJb)
+{
+    pJb->winMin = 0xFFFFFFFF;
+    pJb->winMax = 0;
+    pJb->winRead = 0;
+    pJb->sinceAdjust = 0;
+}
@@ -0,0 +1,153 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Audio Jitter Buffer                                                                            */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Byte FIFO between a bursty audio source and a synchronous
+ *         sink. The buffer measures how much its fill level varies
+ *         between reads (arrival jitter) and adapts its latency between
+ *         a minimum and a maximum, by dropping or repeating single
+ *         frames spread over time.
+ */
+/*----------------------------------------------------------*/
+#ifndef JITTER_BUFFER_H_
+#define JITTER_BUFFER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/** Frames read between two jitter measurements, 250ms at 48kHz */
+#define JITTERBUFFER_WINDOW_FRAMES      (12000)
+/** At most one frame is dropped or repeated within this amount of frames, 0.5% speed change */
+#define JITTERBUFFER_ADJUST_SPACING     (200)
+
+typedef struct
+{
+    uint32_t overflows;
+    uint32_t underruns;
+    uint32_t bytesWritten;
+    uint32_t bytesRead;
+    uint32_t framesDropped;     /**< Frames skipped to reduce the latency */
+    uint32_t framesInserted;    /**< Frames repeated to raise the latency */
+    uint32_t jitterFrames;      /**< Fill level variation measured in the last window */
+    uint32_t targetFrames;      /**< Latency the buffer currently converges to */
+} JitterBuffer_Stats_t;
+
+typedef struct
+{
+    uint8_t *pMem;
+    uint32_t size;
+    uint32_t rdPos;
+    uint32_t wrPos;
+    uint32_t level;
+    uint32_t minLatency;
+    uint32_t maxLatency;
+    uint32_t target;
+    uint32_t winMin;
+    uint32_t winMax;
+    uint32_t winRead;
+    uint32_t sinceAdjust;
+    int32_t adjustFrames;
+    uint16_t bytesPerFrame;
+    bool running;
+    JitterBuffer_Stats_t stats;
+} JitterBuffer_t;
+
+/**
+ * \brief Initializes a jitter buffer on the given memory.
+ * \note The buffer starts with the maximum latency and converges down to what the measured jitter requires.
+ * \param pJb - The jitter buffer instance
+ * \param pMem - Storage, it must stay valid as long as the instance is used
+ * \param size - Size of pMem in bytes, will be rounded down to whole frames
+ * \param bytesPerFrame - Size of one audio frame (all channels), reads and writes are done in whole frames
+ * \param minLatencyFrames - Lowest latency the buffer converges to
+ * \param maxLatencyFrames - Highest latency, limited to the buffer size
+ */
+void JitterBuffer_Init(JitterBuffer_t *pJb, uint8_t *pMem, uint32_t size, uint16_t bytesPerFrame, uint32_t minLatencyFrames, uint32_t maxLatencyFrames);
+
+/**
+ * \brief Drops all buffered data and restarts the prefill phase.
+ * \note The measured jitter and latency target are kept.
+ * \param pJb - The jitter buffer instance
+ */
+void JitterBuffer_Reset(JitterBuffer_t *pJb);
+
+/**
+ * \brief Stores audio data from the source side.
+ * \param pJb - The jitter buffer instance
+ * \param pData - Audio data
+ * \param len - Length in bytes, should be a multiple of bytesPerFrame
+ * \return Amount of bytes stored. Less than len, if the buffer overflowed (the newest data is dropped).
+ */
+uint32_t JitterBuffer_Write(JitterBuffer_t *pJb, const uint8_t *pData, uint32_t len);
+
+/**
+ * \brief Fills the sink buffer, padding with silence if not enough audio is available.
+ * \param pJb - The jitter buffer instance
+ * \param pData - Destination, always filled completely
+ * \param len - Length in bytes
+ * \return Amount of audio bytes in pData, the rest of pData is silence.
+ */
+uint32_t JitterBuffer_Read(JitterBuffer_t *pJb, uint8_t *pData, uint32_t len);
+
+/**
+ * \brief Returns the current fill level.
+ * \param pJb - The jitter buffer instance
+ * \return Buffered bytes.
+ */
+uint32_t JitterBuffer_GetLevel(const JitterBuffer_t *pJb);
+
+/**
+ * \brief Returns the current latency.
+ * \param pJb - The jitter buffer instance
+ * \return Buffered frames.
+ */
+uint32_t JitterBuffer_GetLatency(const JitterBuffer_t *pJb);
+
+/**
+ * \brief Returns the statistics since JitterBuffer_Init.
+ * \param pJb - The jitter buffer instance
+ * \return Pointer to the statistics.
+ */
+const JitterBuffer_Stats_t *JitterBuffer_GetStats(const JitterBuffer_t *pJb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JITTER_BUFFER_H_ */
@@ -0,0 +1,329 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Audio Level Meter                                                                              */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include "level_meter.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* Two samples are processed per instruction with the M7 SIMD instructions (CMSIS intrinsics), equivalent C on the host */
+#ifdef __ARM_ARCH_7EM__
+#include "board.h"
+#define REV16(x)            __REV16(x)
+#define PKHBT(a, b, s)      __PKHBT(a, b, s)
+#define PKHTB(a, b, s)      __PKHTB(a, b, s)
+#define SMLALD(a, b, acc)   __SMLALD(a, b, acc)
+/* SEL picks the halfwords by the GE flags of SSUB16, so both must be in one asm statement (the compiler may reorder intrinsics) */
+static inline uint32_t Max16x2(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+    __ASM ("ssub16 %0, %1, %2\n\tsel %0, %1, %2" : "=&r" (r) : "r" (a), "r" (b) : "cc");
+    return r;
+}
+static inline uint32_t Min16x2(uint32_t a, uint32_t b)
+{
+    uint32_t r;
+    __ASM ("ssub16 %0, %1, %2\n\tsel %0, %2, %1" : "=&r" (r) : "r" (a), "r" (b) : "cc");
+    return r;
+}
+#else
+#define REV16(x)            ((((x) & 0x00FF00FF) << 8) | (((x) >> 8) & 0x00FF00FF))
+#define PKHBT(a, b, s)      (((uint32_t)(a) & 0x0000FFFF) | (((uint32_t)(b) << (s)) & 0xFFFF0000))
+#define PKHTB(a, b, s)      (((uint32_t)(a) & 0xFFFF0000) | (((uint32_t)(b) >> (s)) & 0x0000FFFF))
+#define LO(x)               ((int16_t)((x) & 0xFFFF))
+#define HI(x)               ((int16_t)((x) >> 16))
+#define SMLALD(a, b, acc)   ((acc) + (uint64_t)((int64_t)LO(a) * LO(b) + (int64_t)HI(a) * HI(b)))
+static inline uint32_t Max16x2(uint32_t a, uint32_t b)
+{
+    return ((LO(a) >= LO(b) ? a : b) & 0xFFFF) | ((HI(a) >= HI(b) ? a : b) & 0xFFFF0000);
+}
+static inline uint32_t Min16x2(uint32_t a, uint32_t b)
+{
+    return ((LO(a) < LO(b) ? a : b) & 0xFFFF) | ((HI(a) < HI(b) ? a : b) & 0xFFFF0000);
+}
+#endif
+
+#define SAMPLE(p)           ((int16_t)(((p)[0] << 8) | (p)[1]))
+#define MAGNITUDE(s)        ((uint16_t)((0 > (s)) ? -(int32_t)(s) : (s)))
+#define SILENCE_DB          (-960)
+/* 20 * log10(2) in 1/256 tenths of dB, the level of one octave */
+#define OCTAVE_DB           (15413)
+
+/* 200 * log10(1 + i / 32) in 1/256 tenths of dB, interpolated linearly between the entries (error < 0.01 dB) */
+static const uint16_t m_mantissaDb[33] =
+{
+        0,   684,  1348,  1993,  2619,  3228,  3821,  4399,  4962,  5511,  6047,
+     6570,  7081,  7581,  8070,  8548,  9016,  9474,  9924, 10364, 10796, 11219,
+    11635, 12043, 12444, 12837, 13224, 13604, 13978, 14345, 14707, 15063, 15413
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static inline uint32_t Load32(const uint8_t *p);
+static uint16_t PackedPeak(uint32_t max, uint32_t min);
+static void ProcessMono(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t frames, uint16_t *pPeak);
+static void ProcessStereo(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t frames, uint16_t *pPeak);
+static void ProcessGeneric(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t frames, uint16_t stride, uint16_t *pPeak);
+static uint32_t CountClips(const uint8_t *pData, uint32_t frames, uint16_t stride);
+static void Publish(LevelMeter_t *pMeter);
+static uint32_t SquareRoot(uint64_t value);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void LevelMeter_Init(LevelMeter_t *pMeter, uint16_t bytesPerFrame, uint32_t periodFrames)
+{
+    assert(NULL != pMeter);
+    memset(pMeter, 0, sizeof(LevelMeter_t));
+    pMeter->bytesPerFrame = bytesPerFrame;
+    pMeter->channels = bytesPerFrame / 2;
+    if (LEVELMETER_MAX_CHANNELS < pMeter->channels)
+        pMeter->channels = LEVELMETER_MAX_CHANNELS;
+    pMeter->periodFrames = periodFrames;
+}
+
+void LevelMeter_Process(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t len)
+{
+    uint16_t peak[LEVELMETER_MAX_CHANNELS];
+    uint16_t stride;
+    uint32_t frames;
+    uint16_t ch;
+    assert(NULL != pMeter && NULL != pData);
+    if (0 == pMeter->periodFrames || 0 == pMeter->channels)
+        return;
+    stride = pMeter->bytesPerFrame;
+    frames = len / stride;
+    if (2 == stride)
+        ProcessMono(pMeter, pData, frames, peak);
+    else if (4 == stride)
+        ProcessStereo(pMeter, pData, frames, peak);
+    else
+        ProcessGeneric(pMeter, pData, frames, stride, peak);
+    for (ch = 0; ch < pMeter->channels; ch++)
+    {
+        /* Clipping is rare, so samples are only counted once the buffer peak reached the clip level */
+        if (LEVELMETER_CLIP_LEVEL <= peak[ch])
+            pMeter->levels[ch].clips += CountClips(&pData[ch * 2], frames, stride);
+        if (peak[ch] > pMeter->peak[ch])
+            pMeter->peak[ch] = peak[ch];
+    }
+    pMeter->frames += frames;
+    if (pMeter->frames >= pMeter->periodFrames)
+        Publish(pMeter);
+}
+
+int16_t LevelMeter_ToDecibel(uint16_t level)
+{
+    /* No floating point library here: log2 from the octave of the level plus a table for the remaining mantissa */
+    uint32_t m = level;
+    uint32_t i;
+    int32_t db;
+    int32_t octaves = 0;
+    if (0 == level)
+        return SILENCE_DB;
+    while (m < 0x8000)
+    {
+        m <<= 1;
+        octaves++;
+    }
+    i = (m - 0x8000) >> 10;
+    db = m_mantissaDb[i] + (int32_t)(((m_mantissaDb[i + 1] - m_mantissaDb[i]) * (m & 0x3FF)) >> 10);
+    db -= octaves * OCTAVE_DB;
+    return (int16_t)(0 > db ? -((-db + 128) >> 8) : (db + 128) >> 8);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static inline uint32_t Load32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/* Largest magnitude of the packed maximum and minimum lanes, both start at 0 */
+static uint16_t PackedPeak(uint32_t max, uint32_t min)
+{
+    uint16_t peak = MAGNITUDE((int16_t)(max & 0xFFFF));
+    uint16_t tmp = MAGNITUDE((int16_t)(max >> 16));
+    if (tmp > peak)
+        peak = tmp;
+    tmp = MAGNITUDE((int16_t)(min & 0xFFFF));
+    if (tmp > peak)
+        peak = tmp;
+    tmp = MAGNITUDE((int16_t)(min >> 16));
+    if (tmp > peak)
+        peak = tmp;
+    return peak;
+}
+
+static void ProcessMono(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t frames, uint16_t *pPeak)
+{
+    uint64_t acc = 0;
+    uint32_t max = 0;
+    uint32_t min = 0;
+    uint32_t w;
+    for (; frames >= 2; frames -= 2)
+    {
+        w = REV16(Load32(pData));
+        acc = SMLALD(w, w, acc);
+        max = Max16x2(max, w);
+        min = Min16x2(min, w);
+        pData += 4;
+    }
+    pPeak[0] = PackedPeak(max, min);
+    if (0 != frames)
+    {
+        int32_t sample = SAMPLE(pData);
+        acc += (uint32_t)(sample * sample);
+        if (MAGNITUDE(sample) > pPeak[0])
+            pPeak[0] = MAGNITUDE(sample);
+    }
+    pMeter->sumSquares[0] += acc;
+}
+
+static void ProcessStereo(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t frames, uint16_t *pPeak)
+{
+    uint64_t accL = 0;
+    uint64_t accR = 0;
+    uint32_t maxL = 0, minL = 0;
+    uint32_t maxR = 0, minR = 0;
+    uint32_t w0, w1, l, r;
+    for (; frames >= 2; frames -= 2)
+    {
+        /* Swap to host order, then sort the two frames into a left and a right pair */
+        w0 = REV16(Load32(pData));
+        w1 = REV16(Load32(pData + 4));
+        l = PKHBT(w0, w1, 16);
+        r = PKHTB(w1, w0, 16);
+        accL = SMLALD(l, l, accL);
+        accR = SMLALD(r, r, accR);
+        maxL = Max16x2(maxL, l);
+        minL = Min16x2(minL, l);
+        maxR = Max16x2(maxR, r);
+        minR = Min16x2(minR, r);
+        pData += 8;
+    }
+    pMeter->sumSquares[0] += accL;
+    pMeter->sumSquares[1] += accR;
+    pPeak[0] = PackedPeak(maxL, minL);
+    pPeak[1] = PackedPeak(maxR, minR);
+    if (0 != frames)
+    {
+        /* Odd frame count: meter the last frame with the generic loop and merge */
+        uint16_t tailPeak[2];
+        ProcessGeneric(pMeter, pData, 1, 4, tailPeak);
+        if (tailPeak[0] > pPeak[0])
+            pPeak[0] = tailPeak[0];
+        if (tailPeak[1] > pPeak[1])
+            pPeak[1] = tailPeak[1];
+    }
+}
+
+static void ProcessGeneric(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t frames, uint16_t stride, uint16_t *pPeak)
+{
+    uint16_t ch;
+    for (ch = 0; ch < pMeter->channels; ch++)
+    {
+        const uint8_t *p = &pData[ch * 2];
+        uint64_t acc = 0;
+        uint16_t peak = 0;
+        uint32_t f;
+        for (f = 0; f < frames; f++)
+        {
+            int32_t s = SAMPLE(p);
+            uint16_t mag = MAGNITUDE(s);
+            acc += (uint32_t)(s * s);
+            if (mag > peak)
+                peak = mag;
+            p += stride;
+        }
+        pMeter->sumSquares[ch] += acc;
+        pPeak[ch] = peak;
+    }
+}
+
+static uint32_t CountClips(const uint8_t *pData, uint32_t frames, uint16_t stride)
+{
+    uint32_t clips = 0;
+    for (; 0 != frames; frames--)
+    {
+        int16_t s = SAMPLE(pData);
+        if (LEVELMETER_CLIP_LEVEL <= MAGNITUDE(s))
+            clips++;
+        pData += stride;
+    }
+    return clips;
+}
+
+static void Publish(LevelMeter_t *pMeter)
+{
+    uint16_t ch;
+    for (ch = 0; ch < pMeter->channels; ch++)
+    {
+        pMeter->levels[ch].peak = pMeter->peak[ch];
+        pMeter->levels[ch].rms = (uint16_t)SquareRoot(pMeter->sumSquares[ch] / pMeter->frames);
+        pMeter->peak[ch] = 0;
+        pMeter->sumSquares[ch] = 0;
+    }
+    pMeter->frames = 0;
+    pMeter->periods++;
+}
+
+/* Integer square root, called once per channel and period only */
+static uint32_t SquareRoot(uint64_t value)
+{
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > value)
+        bit >>= 2;
+    while (0 != bit)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
@@ -0,0 +1,104 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Audio Level Meter                                                                              */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Peak, RMS and clip metering of big endian 16 bit sync
+ *         channel data, per channel slot. Levels are collected over a
+ *         configurable period and then published in one go, so they can
+ *         be read at any time without tearing.
+ */
+/*----------------------------------------------------------*/
+#ifndef LEVEL_METER_H_
+#define LEVEL_METER_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/** Channel slots metered per stream, further slots are ignored */
+#define LEVELMETER_MAX_CHANNELS     (8)
+/** Samples with this magnitude or above are counted as clipped */
+#define LEVELMETER_CLIP_LEVEL       (32767)
+
+typedef struct
+{
+    uint16_t peak;              /**< Highest magnitude in the last period, 32768 is full scale */
+    uint16_t rms;               /**< RMS of the last period, 32768 is full scale */
+    uint32_t clips;             /**< Clipped samples since LevelMeter_Init */
+} LevelMeter_Level_t;
+
+typedef struct
+{
+    uint16_t bytesPerFrame;
+    uint16_t channels;
+    uint32_t periodFrames;
+    uint32_t frames;
+    uint64_t sumSquares[LEVELMETER_MAX_CHANNELS];
+    uint16_t peak[LEVELMETER_MAX_CHANNELS];
+    LevelMeter_Level_t levels[LEVELMETER_MAX_CHANNELS];
+    uint32_t periods;           /**< Incremented whenever new levels were published */
+} LevelMeter_t;
+
+/**
+ * \brief Initializes a level meter.
+ * \param pMeter - The meter instance
+ * \param bytesPerFrame - Bytes of one frame, each 2 bytes are one channel slot
+ * \param periodFrames - Frames over which peak and RMS are collected before they are published, 0 disables the meter
+ */
+void LevelMeter_Init(LevelMeter_t *pMeter, uint16_t bytesPerFrame, uint32_t periodFrames);
+
+/**
+ * \brief Meters a buffer of interleaved big endian 16 bit samples.
+ * \param pMeter - The meter instance
+ * \param pData - Audio data, must start at a frame boundary
+ * \param len - Length in bytes
+ */
+void LevelMeter_Process(LevelMeter_t *pMeter, const uint8_t *pData, uint32_t len);
+
+/**
+ * \brief Converts a peak or RMS level into dBFS.
+ * \param level - Level as published in LevelMeter_Level_t
+ * \return Level in tenths of dB relative to full scale, -960 for silence.
+ */
+int16_t LevelMeter_ToDecibel(uint16_t level);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LEVEL_METER_H_ */
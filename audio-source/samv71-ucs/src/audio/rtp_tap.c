@@ -0,0 +1,267 @@
+/*------------------------------------------------------------------------------------------------*/
+/* RTP Monitoring Tap Implementation                                                              */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include "board.h"
+#include "gmac_init.h"
+#include "sample_conv.h"
+#include "rtp_tap.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* 1ms of audio per packet at 48kHz, reduced for wide channels to stay below RTP_TAP_MAX_PAYLOAD */
+#define RTP_TAP_FRAMES_PER_PACKET   (48)
+#define RTP_TAP_MAX_PAYLOAD         (1152)
+/* Packets which may be queued in the GMAC at the same time, ETH queue has 8 TX descriptors shared with the console */
+#define RTP_TAP_BUFFERS             (4)
+#define RTP_TAP_SOURCE_PORT         (5004)
+#define RTP_TAP_SSRC                (0x4D4F5354ul)
+/* Largest supported sync channel, 16 channels with 16 bit */
+#define RTP_TAP_MAX_BYTES_PER_FRAME (32)
+
+/* Same source address as used by the console */
+static const uint8_t tapSrcMac[6] = { 0x02, 0x00, 0x00, 0x01, 0x01, 0x01 };
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define ETH_HEADER_LEN          (14)
+#define IP_HEADER_LEN           (20)
+#define UDP_HEADER_LEN          (8)
+#define RTP_HEADER_LEN          (12)
+#define HEADERS_LEN             (ETH_HEADER_LEN + IP_HEADER_LEN + UDP_HEADER_LEN + RTP_HEADER_LEN)
+#define RTP_VERSION             (0x80)
+#define RTP_PAYLOAD_TYPE        (96)
+#define IP_OFFSET               (ETH_HEADER_LEN)
+#define UDP_OFFSET              (IP_OFFSET + IP_HEADER_LEN)
+#define RTP_OFFSET              (UDP_OFFSET + UDP_HEADER_LEN)
+
+#define HB(value)               ((uint8_t)((uint16_t)(value) >> 8) & 0xFF)
+#define LB(value)               ((uint8_t)(value) & 0xFF)
+
+#define TAPBUFFER COMPILER_SECTION(".ram_nocache") COMPILER_ALIGNED(DEFAULT_CACHELINE)
+
+typedef struct
+{
+    sGmacd *pGmacd;
+    RtpTap_Format_t format;
+    uint16_t udpPort;
+    uint16_t bytesPerFrame;
+    uint16_t payloadBytesPerFrame;
+    uint16_t framesPerPacket;
+    uint16_t fill;
+    uint16_t seq;
+    uint16_t ipId;
+    uint32_t timestamp;
+    uint8_t idx;
+    bool dropping;
+    bool gapPending;
+    volatile bool busy[RTP_TAP_BUFFERS];
+    RtpTap_Stats_t stats;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+TAPBUFFER static uint8_t tapFrames[RTP_TAP_BUFFERS][HEADERS_LEN + RTP_TAP_MAX_PAYLOAD];
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void InitTapFrame(uint8_t *pFrame);
+static void CompletePacket(void);
+static bool SendTapFrame(uint8_t *pFrame);
+static void OnTapFrameSent(uint32_t status, void *pTag);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool RtpTap_Init(sGmacd *pGmacd, uint16_t bytesPerFrame, RtpTap_Format_t format, uint16_t udpPort)
+{
+    uint8_t i;
+    assert(NULL != pGmacd);
+    memset(&m, 0, sizeof(m));
+    if (0 == bytesPerFrame || RTP_TAP_MAX_BYTES_PER_FRAME < bytesPerFrame || 0 != (bytesPerFrame % 2))
+        return false;
+    m.format = format;
+    m.udpPort = udpPort;
+    m.bytesPerFrame = bytesPerFrame;
+    m.payloadBytesPerFrame = (RtpTap_Format_L24 == format) ? (bytesPerFrame / 2 * 3) : bytesPerFrame;
+    m.framesPerPacket = RTP_TAP_MAX_PAYLOAD / m.payloadBytesPerFrame;
+    if (m.framesPerPacket > RTP_TAP_FRAMES_PER_PACKET)
+        m.framesPerPacket = RTP_TAP_FRAMES_PER_PACKET;
+    for (i = 0; i < RTP_TAP_BUFFERS; i++)
+        InitTapFrame(tapFrames[i]);
+    m.pGmacd = pGmacd;
+    return true;
+}
+
+void RtpTap_Write(const uint8_t *pBuf, uint32_t len)
+{
+    assert(NULL != pBuf);
+    if (NULL == m.pGmacd)
+        return;
+    while (len >= m.bytesPerFrame)
+    {
+        uint32_t frames = len / m.bytesPerFrame;
+        if (frames > (uint32_t)(m.framesPerPacket - m.fill))
+            frames = m.framesPerPacket - m.fill;
+        /* Decide at the packet start, a buffer released meanwhile must not get a partial packet */
+        if (0 == m.fill)
+            m.dropping = m.busy[m.idx];
+        if (!m.dropping)
+        {
+            uint8_t *pPayload = &tapFrames[m.idx][HEADERS_LEN + m.fill * m.payloadBytesPerFrame];
+            if (RtpTap_Format_L24 == m.format)
+                SampleConv_Convert(pPayload, SampleConv_S24BE, pBuf, SampleConv_S16BE, frames * m.bytesPerFrame / 2);
+            else
+                memcpy(pPayload, pBuf, frames * m.bytesPerFrame);
+        }
+        m.fill += frames;
+        pBuf += frames * m.bytesPerFrame;
+        len -= frames * m.bytesPerFrame;
+        if (m.fill == m.framesPerPacket)
+            CompletePacket();
+    }
+}
+
+const RtpTap_Stats_t *RtpTap_GetStats(void)
+{
+    return &m.stats;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void InitTapFrame(uint8_t *pFrame)
+{
+    uint8_t *pIp = &pFrame[IP_OFFSET];
+    uint8_t *pUdp = &pFrame[UDP_OFFSET];
+    uint8_t *pRtp = &pFrame[RTP_OFFSET];
+    uint16_t udpLen = UDP_HEADER_LEN + RTP_HEADER_LEN + m.framesPerPacket * m.payloadBytesPerFrame;
+    memset(pFrame, 0, HEADERS_LEN);
+    /* Ethernet: broadcast, IPv4 */
+    memset(&pFrame[0], 0xFF, 6);
+    memcpy(&pFrame[6], tapSrcMac, sizeof(tapSrcMac));
+    pFrame[12] = 0x08;
+    /* IP: checksum and identification are filled per packet, source 0.0.0.0, destination broadcast */
+    pIp[0] = 0x45;
+    pIp[2] = HB(IP_HEADER_LEN + udpLen);
+    pIp[3] = LB(IP_HEADER_LEN + udpLen);
+    pIp[8] = 0x40;
+    pIp[9] = 0x11;
+    memset(&pIp[16], 0xFF, 4);
+    /* UDP: checksum is optional */
+    pUdp[0] = HB(RTP_TAP_SOURCE_PORT);
+    pUdp[1] = LB(RTP_TAP_SOURCE_PORT);
+    pUdp[2] = HB(m.udpPort);
+    pUdp[3] = LB(m.udpPort);
+    pUdp[4] = HB(udpLen);
+    pUdp[5] = LB(udpLen);
+    /* RTP: sequence and timestamp are filled per packet */
+    pRtp[0] = RTP_VERSION;
+    pRtp[1] = RTP_PAYLOAD_TYPE;
+    pRtp[8] = (uint8_t)(RTP_TAP_SSRC >> 24);
+    pRtp[9] = (uint8_t)(RTP_TAP_SSRC >> 16);
+    pRtp[10] = (uint8_t)(RTP_TAP_SSRC >> 8);
+    pRtp[11] = (uint8_t)RTP_TAP_SSRC;
+}
+
+static void CompletePacket(void)
+{
+    if (m.dropping || !SendTapFrame(tapFrames[m.idx]))
+    {
+        /* Skip the sequence number, so the receiver detects the gap and keeps the timing */
+        if (!m.gapPending)
+            m.stats.sequenceGaps++;
+        m.gapPending = true;
+    }
+    else
+    {
+        m.gapPending = false;
+        m.idx = (m.idx + 1) % RTP_TAP_BUFFERS;
+    }
+    if (m.dropping)
+        m.stats.packetsDropped++;
+    m.seq++;
+    m.timestamp += m.framesPerPacket;
+    m.fill = 0;
+}
+
+static bool SendTapFrame(uint8_t *pFrame)
+{
+    uint8_t *pIp = &pFrame[IP_OFFSET];
+    uint8_t *pRtp = &pFrame[RTP_OFFSET];
+    uint32_t crcSum = 0ul;
+    uint8_t i;
+    pIp[4] = HB(m.ipId);
+    pIp[5] = LB(m.ipId);
+    m.ipId++;
+    pIp[10] = 0;
+    pIp[11] = 0;
+    for (i = 0; i < IP_HEADER_LEN; i += 2)
+        crcSum += (uint16_t)((pIp[i] << 8) | pIp[i + 1]);
+    crcSum = (crcSum & 0xFFFFul) + (crcSum >> 16);
+    crcSum = ~((crcSum & 0xFFFFul) + (crcSum >> 16));
+    pIp[10] = HB(crcSum);
+    pIp[11] = LB(crcSum);
+    pRtp[2] = HB(m.seq);
+    pRtp[3] = LB(m.seq);
+    pRtp[4] = (uint8_t)(m.timestamp >> 24);
+    pRtp[5] = (uint8_t)(m.timestamp >> 16);
+    pRtp[6] = (uint8_t)(m.timestamp >> 8);
+    pRtp[7] = (uint8_t)m.timestamp;
+    m.busy[m.idx] = true;
+    if (GMACD_OK != GMACD_Send(m.pGmacd, pFrame, HEADERS_LEN + m.framesPerPacket * m.payloadBytesPerFrame,
+        OnTapFrameSent, (void *)&m.busy[m.idx], GMAC_QUE_0))
+    {
+        m.busy[m.idx] = false;
+        m.stats.sendErrors++;
+        return false;
+    }
+    m.stats.packetsSent++;
+    return true;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                  CALLBACK FUNCTIONS FROM GMAC                        */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void OnTapFrameSent(uint32_t status, void *pTag)
+{
+    volatile bool *pBusy = (volatile bool *)pTag;
+    assert(NULL != pBusy);
+    *pBusy = false;
+}
@@ -0,0 +1,96 @@
+/*------------------------------------------------------------------------------------------------*/
+/* RTP Monitoring Tap                                                                             */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Streams a sync channel as RTP over UDP for remote
+ *         monitoring. The samples are sent as L16 or L24 (RFC 3551)
+ *         to the broadcast address via the GMAC ETH queue, several
+ *         packets may be in flight at the same time.
+ */
+/*----------------------------------------------------------*/
+#ifndef RTP_TAP_H_
+#define RTP_TAP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "gmacd.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+typedef enum
+{
+    RtpTap_Format_L16,      /**< 16 bit big endian, the samples are sent as found on MOST */
+    RtpTap_Format_L24       /**< 24 bit big endian, the samples are widened */
+} RtpTap_Format_t;
+
+typedef struct
+{
+    uint32_t packetsSent;
+    uint32_t sendErrors;    /**< GMAC did not accept a packet */
+    uint32_t packetsDropped;/**< All packet buffers were in flight */
+    uint32_t sequenceGaps;  /**< Times the RTP sequence had to skip numbers, a receiver sees the same count of gaps */
+} RtpTap_Stats_t;
+
+/**
+ * \brief Initializes the monitoring tap.
+ * \note init_gmac must have been called before.
+ * \param pGmacd - The GMAC driver instance
+ * \param bytesPerFrame - subSize of the tapped sync channel (16 bit big endian samples)
+ * \param format - Sample format of the RTP payload
+ * \param udpPort - Destination UDP port, the RTP payload type is always 96 (dynamic)
+ * \return true, if initialization was successful. false, otherwise.
+ */
+bool RtpTap_Init(sGmacd *pGmacd, uint16_t bytesPerFrame, RtpTap_Format_t format, uint16_t udpPort);
+
+/**
+ * \brief Passes audio of the tapped sync channel.
+ * \param pBuf - Sync data as sent to or received from the LLD
+ * \param len - Length of pBuf, a multiple of the bytes per frame
+ */
+void RtpTap_Write(const uint8_t *pBuf, uint32_t len);
+
+/**
+ * \brief Returns the statistics of the tap.
+ * \return Pointer to the statistics.
+ */
+const RtpTap_Stats_t *RtpTap_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RTP_TAP_H_ */
@@ -0,0 +1,361 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Sample Format Conversion                                                                       */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "sample_conv.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* The word kernels load samples little endian, like the Cortex-M7 and the x86 hosts do */
+#ifdef __ARM_ARCH_7EM__
+#include "board.h"
+#define REV32(x)            __REV(x)
+#define REV16(x)            __REV16(x)
+#define PKHBT(a, b, s)      __PKHBT(a, b, s)
+#define PKHTB(a, b, s)      __PKHTB(a, b, s)
+#else
+#define REV32(x)            ((((x) & 0xFF) << 24) | (((x) & 0xFF00) << 8) | (((x) >> 8) & 0xFF00) | ((x) >> 24))
+#define REV16(x)            ((((x) & 0x00FF00FF) << 8) | (((x) >> 8) & 0x00FF00FF))
+#define PKHBT(a, b, s)      (((uint32_t)(a) & 0x0000FFFF) | (((uint32_t)(b) << (s)) & 0xFFFF0000))
+#define PKHTB(a, b, s)      (((uint32_t)(a) & 0xFFFF0000) | (((uint32_t)(b) >> (s)) & 0x0000FFFF))
+#endif
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static inline uint32_t Load32(const uint8_t *p);
+static inline void Store32(uint8_t *p, uint32_t value);
+static void S32ToS16BE(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples, bool srcLittleEndian);
+static void S24ToS16BE(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples, bool srcLittleEndian);
+static void S16BEToS32(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples, bool dstLittleEndian);
+static void ConvertGeneric(uint8_t *pDst, SampleConv_Format_t dstFormat, const uint8_t *pSrc, SampleConv_Format_t srcFormat, uint32_t samples);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+uint8_t SampleConv_GetSampleSize(SampleConv_Format_t format)
+{
+    switch (format)
+    {
+    case SampleConv_S16LE:
+    case SampleConv_S16BE:
+        return 2;
+    case SampleConv_S24LE:
+    case SampleConv_S24BE:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+uint32_t SampleConv_Convert(uint8_t *pDst, SampleConv_Format_t dstFormat, const uint8_t *pSrc, SampleConv_Format_t srcFormat, uint32_t samples)
+{
+    assert(NULL != pDst && NULL != pSrc);
+    if (dstFormat == srcFormat)
+    {
+        if (pDst != pSrc)
+            memmove(pDst, pSrc, samples * SampleConv_GetSampleSize(srcFormat));
+    }
+    else if (SampleConv_S16BE == dstFormat)
+    {
+        switch (srcFormat)
+        {
+        case SampleConv_S16LE: SampleConv_Swap16(pDst, pSrc, samples); break;
+        case SampleConv_S24LE: S24ToS16BE(pDst, pSrc, samples, true); break;
+        case SampleConv_S24BE: S24ToS16BE(pDst, pSrc, samples, false); break;
+        case SampleConv_S32LE: S32ToS16BE(pDst, pSrc, samples, true); break;
+        default: S32ToS16BE(pDst, pSrc, samples, false); break;
+        }
+    }
+    else if (SampleConv_S16BE == srcFormat && SampleConv_S16LE == dstFormat)
+    {
+        SampleConv_Swap16(pDst, pSrc, samples);
+    }
+    else if (SampleConv_S16BE == srcFormat && SampleConv_S32LE == dstFormat)
+    {
+        S16BEToS32(pDst, pSrc, samples, true);
+    }
+    else if (SampleConv_S16BE == srcFormat && SampleConv_S32BE == dstFormat)
+    {
+        S16BEToS32(pDst, pSrc, samples, false);
+    }
+    else if ((SampleConv_S24LE == srcFormat && SampleConv_S24BE == dstFormat)
+        || (SampleConv_S24BE == srcFormat && SampleConv_S24LE == dstFormat))
+    {
+        SampleConv_Swap24(pDst, pSrc, samples);
+    }
+    else if ((SampleConv_S32LE == srcFormat && SampleConv_S32BE == dstFormat)
+        || (SampleConv_S32BE == srcFormat && SampleConv_S32LE == dstFormat))
+    {
+        SampleConv_Swap32(pDst, pSrc, samples);
+    }
+    else
+    {
+        ConvertGeneric(pDst, dstFormat, pSrc, srcFormat, samples);
+    }
+    return samples * SampleConv_GetSampleSize(dstFormat);
+}
+
+void SampleConv_Swap16(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples)
+{
+    uint32_t w0, w1;
+    for (; samples >= 4; samples -= 4)
+    {
+        w0 = Load32(pSrc);
+        w1 = Load32(pSrc + 4);
+        Store32(pDst, REV16(w0));
+        Store32(pDst + 4, REV16(w1));
+        pSrc += 8;
+        pDst += 8;
+    }
+    for (; 0 != samples; samples--)
+    {
+        uint8_t tmp = pSrc[0];
+        pDst[0] = pSrc[1];
+        pDst[1] = tmp;
+        pSrc += 2;
+        pDst += 2;
+    }
+}
+
+void SampleConv_Swap24(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples)
+{
+    for (; 0 != samples; samples--)
+    {
+        uint8_t tmp = pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[0] = pSrc[2];
+        pDst[2] = tmp;
+        pSrc += 3;
+        pDst += 3;
+    }
+}
+
+void SampleConv_Swap32(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples)
+{
+    uint32_t w0, w1;
+    for (; samples >= 2; samples -= 2)
+    {
+        w0 = Load32(pSrc);
+        w1 = Load32(pSrc + 4);
+        Store32(pDst, REV32(w0));
+        Store32(pDst + 4, REV32(w1));
+        pSrc += 8;
+        pDst += 8;
+    }
+    if (0 != samples)
+        Store32(pDst, REV32(Load32(pSrc)));
+}
+
+void SampleConv_MonoToStereo16(uint8_t *pDst, const uint8_t *pSrc, uint32_t frames)
+{
+    uint32_t w;
+    for (; frames >= 2; frames -= 2)
+    {
+        w = Load32(pSrc);
+        Store32(pDst, PKHBT(w, w, 16));
+        Store32(pDst + 4, PKHTB(w, w, 16));
+        pSrc += 4;
+        pDst += 8;
+    }
+    if (0 != frames)
+    {
+        pDst[0] = pDst[2] = pSrc[0];
+        pDst[1] = pDst[3] = pSrc[1];
+    }
+}
+
+void SampleConv_Interleave16(uint8_t *pDst, const uint8_t *pLeft, const uint8_t *pRight, uint32_t frames)
+{
+    uint32_t l, r;
+    for (; frames >= 2; frames -= 2)
+    {
+        l = Load32(pLeft);
+        r = Load32(pRight);
+        Store32(pDst, PKHBT(l, r, 16));
+        Store32(pDst + 4, PKHTB(r, l, 16));
+        pLeft += 4;
+        pRight += 4;
+        pDst += 8;
+    }
+    if (0 != frames)
+    {
+        pDst[0] = pLeft[0];
+        pDst[1] = pLeft[1];
+        pDst[2] = pRight[0];
+        pDst[3] = pRight[1];
+    }
+}
+
+void SampleConv_Deinterleave16(uint8_t *pLeft, uint8_t *pRight, const uint8_t *pSrc, uint32_t frames)
+{
+    uint32_t w0, w1;
+    for (; frames >= 2; frames -= 2)
+    {
+        w0 = Load32(pSrc);
+        w1 = Load32(pSrc + 4);
+        Store32(pLeft, PKHBT(w0, w1, 16));
+        Store32(pRight, PKHTB(w1, w0, 16));
+        pSrc += 8;
+        pLeft += 4;
+        pRight += 4;
+    }
+    if (0 != frames)
+    {
+        pLeft[0] = pSrc[0];
+        pLeft[1] = pSrc[1];
+        pRight[0] = pSrc[2];
+        pRight[1] = pSrc[3];
+    }
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* memcpy compiles to a single LDR/STR, which the M7 executes on unaligned addresses as well */
+static inline uint32_t Load32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline void Store32(uint8_t *p, uint32_t value)
+{
+    memcpy(p, &value, sizeof(value));
+}
+
+static void S32ToS16BE(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples, bool srcLittleEndian)
+{
+    uint32_t w0, w1;
+    for (; samples >= 2; samples -= 2)
+    {
+        w0 = Load32(pSrc);
+        w1 = Load32(pSrc + 4);
+        if (srcLittleEndian)
+            Store32(pDst, REV16(PKHTB(w1, w0, 16)));
+        else
+            Store32(pDst, PKHBT(w0, w1, 16));
+        pSrc += 8;
+        pDst += 4;
+    }
+    if (0 != samples)
+    {
+        pDst[0] = srcLittleEndian ? pSrc[3] : pSrc[0];
+        pDst[1] = srcLittleEndian ? pSrc[2] : pSrc[1];
+    }
+}
+
+static void S24ToS16BE(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples, bool srcLittleEndian)
+{
+    uint32_t w0, w1, w2;
+    /* 4 packed samples occupy 3 words and result in 2 words */
+    for (; samples >= 4; samples -= 4)
+    {
+        w0 = Load32(pSrc);
+        w1 = Load32(pSrc + 4);
+        w2 = Load32(pSrc + 8);
+        if (srcLittleEndian)
+        {
+            Store32(pDst, REV16(((w0 >> 8) & 0xFFFF) | (w1 << 16)));
+            Store32(pDst + 4, REV16((w1 >> 24) | ((w2 & 0xFF) << 8) | (w2 & 0xFFFF0000)));
+        }
+        else
+        {
+            Store32(pDst, (w0 & 0xFFFF) | ((w0 >> 24) << 16) | (w1 << 24));
+            Store32(pDst + 4, (w1 >> 16) | ((w2 >> 8) << 16));
+        }
+        pSrc += 12;
+        pDst += 8;
+    }
+    for (; 0 != samples; samples--)
+    {
+        uint8_t msb = srcLittleEndian ? pSrc[2] : pSrc[0];
+        pDst[1] = pSrc[1];
+        pDst[0] = msb;
+        pSrc += 3;
+        pDst += 2;
+    }
+}
+
+static void S16BEToS32(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples, bool dstLittleEndian)
+{
+    uint32_t w;
+    for (; samples >= 2; samples -= 2)
+    {
+        w = Load32(pSrc);
+        if (dstLittleEndian)
+        {
+            w = REV16(w);
+            Store32(pDst, w << 16);
+            Store32(pDst + 4, w & 0xFFFF0000);
+        }
+        else
+        {
+            Store32(pDst, w & 0xFFFF);
+            Store32(pDst + 4, w >> 16);
+        }
+        pSrc += 4;
+        pDst += 8;
+    }
+    if (0 != samples)
+    {
+        w = dstLittleEndian ? ((uint32_t)pSrc[0] << 24) | ((uint32_t)pSrc[1] << 16) : ((uint32_t)pSrc[1] << 8) | pSrc[0];
+        Store32(pDst, w);
+    }
+}
+
+static void ConvertGeneric(uint8_t *pDst, SampleConv_Format_t dstFormat, const uint8_t *pSrc, SampleConv_Format_t srcFormat, uint32_t samples)
+{
+    uint8_t srcSize = SampleConv_GetSampleSize(srcFormat);
+    uint8_t dstSize = SampleConv_GetSampleSize(dstFormat);
+    bool srcLittleEndian = (SampleConv_S16LE == srcFormat || SampleConv_S24LE == srcFormat || SampleConv_S32LE == srcFormat);
+    bool dstLittleEndian = (SampleConv_S16LE == dstFormat || SampleConv_S24LE == dstFormat || SampleConv_S32LE == dstFormat);
+    assert(pDst == pSrc ? dstSize <= srcSize : true);
+    for (; 0 != samples; samples--)
+    {
+        /* Left justify the sample into 32 bit, then take the upper dstSize bytes */
+        uint32_t value = 0;
+        uint8_t i;
+        for (i = 0; i < srcSize; i++)
+            value |= (uint32_t)pSrc[srcLittleEndian ? (srcSize - 1 - i) : i] << (24 - 8 * i);
+        for (i = 0; i < dstSize; i++)
+            pDst[dstLittleEndian ? (dstSize - 1 - i) : i] = (uint8_t)(value >> (24 - 8 * i));
+        pSrc += srcSize;
+        pDst += dstSize;
+    }
+}
@@ -0,0 +1,144 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Sample Format Conversion                                                                       */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Conversion kernels between the PCM sample formats used by the
+ *         audio sources (WAV, AVB, codec) and the big endian 16 bit
+ *         format of the MOST sync channels. All functions work on a
+ *         number of samples (frames * channels) and accept unaligned
+ *         buffers.
+ */
+/*----------------------------------------------------------*/
+#ifndef SAMPLE_CONV_H_
+#define SAMPLE_CONV_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/** PCM sample formats, 24 bit samples are packed into 3 bytes */
+typedef enum
+{
+    SampleConv_S16LE,
+    SampleConv_S16BE,
+    SampleConv_S24LE,
+    SampleConv_S24BE,
+    SampleConv_S32LE,
+    SampleConv_S32BE
+} SampleConv_Format_t;
+
+/**
+ * \brief Returns the size of one sample in bytes.
+ * \param format - The sample format
+ * \return 2, 3 or 4
+ */
+uint8_t SampleConv_GetSampleSize(SampleConv_Format_t format);
+
+/**
+ * \brief Converts samples between any two formats.
+ * \note Narrower samples are taken from the most significant bits, wider samples are zero padded.
+ *       pDst may be equal to pSrc, if the destination format is not wider than the source format.
+ * \param pDst - Destination buffer, must hold samples * SampleConv_GetSampleSize(dstFormat) bytes
+ * \param dstFormat - Format of the destination samples
+ * \param pSrc - Source buffer
+ * \param srcFormat - Format of the source samples
+ * \param samples - Number of samples to convert
+ * \return Number of bytes written to pDst
+ */
+uint32_t SampleConv_Convert(uint8_t *pDst, SampleConv_Format_t dstFormat, const uint8_t *pSrc, SampleConv_Format_t srcFormat, uint32_t samples);
+
+/**
+ * \brief Swaps the byte order of 16 bit samples.
+ * \note pDst may be equal to pSrc.
+ * \param pDst - Destination buffer
+ * \param pSrc - Source buffer
+ * \param samples - Number of samples
+ */
+void SampleConv_Swap16(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples);
+
+/**
+ * \brief Swaps the byte order of packed 24 bit samples.
+ * \note pDst may be equal to pSrc.
+ * \param pDst - Destination buffer
+ * \param pSrc - Source buffer
+ * \param samples - Number of samples
+ */
+void SampleConv_Swap24(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples);
+
+/**
+ * \brief Swaps the byte order of 32 bit samples.
+ * \note pDst may be equal to pSrc.
+ * \param pDst - Destination buffer
+ * \param pSrc - Source buffer
+ * \param samples - Number of samples
+ */
+void SampleConv_Swap32(uint8_t *pDst, const uint8_t *pSrc, uint32_t samples);
+
+/**
+ * \brief Duplicates 16 bit mono samples into both channels of a stereo stream.
+ * \note The byte order is kept.
+ * \param pDst - Destination buffer, must hold frames * 4 bytes
+ * \param pSrc - Mono source samples
+ * \param frames - Number of frames
+ */
+void SampleConv_MonoToStereo16(uint8_t *pDst, const uint8_t *pSrc, uint32_t frames);
+
+/**
+ * \brief Interleaves two 16 bit mono streams into one stereo stream.
+ * \note The byte order is kept.
+ * \param pDst - Destination buffer, must hold frames * 4 bytes
+ * \param pLeft - Left channel samples
+ * \param pRight - Right channel samples
+ * \param frames - Number of frames
+ */
+void SampleConv_Interleave16(uint8_t *pDst, const uint8_t *pLeft, const uint8_t *pRight, uint32_t frames);
+
+/**
+ * \brief Splits a 16 bit stereo stream into two mono streams.
+ * \note The byte order is kept.
+ * \param pLeft - Destination of the left channel, must hold frames * 2 bytes
+ * \param pRight - Destination of the right channel, must hold frames * 2 bytes
+ * \param pSrc - Interleaved stereo samples
+ * \param frames - Number of frames
+ */
+void SampleConv_Deinterleave16(uint8_t *pLeft, uint8_t *pRight, const uint8_t *pSrc, uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAMPLE_CONV_H_ */
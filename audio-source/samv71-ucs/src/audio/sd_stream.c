@@ -0,0 +1,444 @@
+/*------------------------------------------------------------------------------------------------*/
+/* SD Card Audio Streaming Source                                                                 */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+#include "Console.h"
+#include "timetick.h"
+#include "sd_card.h"
+#include "fat32.h"
+#include "sd_stream.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* Amount of audio kept in the ring, must cover the worst case card latency (block erase, wear leveling) */
+#define SDSTREAM_READAHEAD_MS   (150)
+/* Blocks fetched with one multi-block read, must be <= SDCARD_MAX_MULTI_BLOCK */
+#define SDSTREAM_READ_BLOCKS    (8)
+/* Static ring memory in blocks, the used part is computed from the channel rate. It lives in the DTCM next to
+ * the GMAC buffers, so it only covers the read-ahead of a 4 byte per frame channel, the widest one in task-audio.c */
+#define SDSTREAM_POOL_BLOCKS    (64)
+/* Consecutive failed reads before the stream is given up */
+#define SDSTREAM_MAX_RETRIES    (3)
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#if (SDSTREAM_READ_BLOCKS > SDCARD_MAX_MULTI_BLOCK) || (0 != (SDSTREAM_POOL_BLOCKS % SDSTREAM_READ_BLOCKS))
+#error SDSTREAM_READ_BLOCKS must not exceed SDCARD_MAX_MULTI_BLOCK and must divide SDSTREAM_POOL_BLOCKS
+#endif
+
+#define FILE_NAME_LEN       (13)
+#define BLOCK_MASK          ((uint32_t)(SDCARD_BLOCK_SIZE - 1))
+
+typedef struct
+{
+    char name[FILE_NAME_LEN];
+    uint8_t instance;
+    uint16_t bytesPerFrame;
+    bool loop;
+} QueueEntry_t;
+
+typedef struct
+{
+    bool cardReady;
+    QueueEntry_t queue[SDSTREAM_QUEUE_LEN];
+    uint8_t queueHead;
+    uint8_t queueCount;
+    /* Current file */
+    bool active;
+    bool loop;
+    uint8_t instance;
+    Fat32_File_t file;
+    SDStream_Format_t format;
+    uint32_t dataStart;
+    uint32_t dataEnd;
+    /* Consumer position in the file (bytes) */
+    uint32_t readPos;
+    /* Producer position in the file (block aligned bytes) */
+    uint32_t fetchPos;
+    /* Ring of blocks */
+    uint16_t depth;
+    uint16_t wrIdx;
+    uint16_t rdIdx;
+    uint16_t fill;
+    bool xferPending;
+    uint16_t xferBlocks;
+    uint32_t xferStart;
+    uint8_t retries;
+    SDStream_Stats_t stats;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+static SDCARD_BUFFER uint8_t ring[SDSTREAM_POOL_BLOCKS][SDCARD_BLOCK_SIZE];
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool OpenFile(const QueueEntry_t *pEntry);
+static bool ParseWaveHeader(const uint8_t *pHdr, uint32_t hdrLen);
+static bool HasWaveExtension(const char *pName);
+static uint16_t ComputeDepth(uint16_t bytesPerFrame);
+static void CheckTransfer(void);
+static void StartNextRead(void);
+static void FinishFile(void);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool SDStream_Init(void)
+{
+    memset(&m, 0, sizeof(m));
+    if (!SDCard_Init())
+        return false;
+    if (!Fat32_Mount())
+    {
+        ConsolePrintf(PRIO_ERROR, RED "SD card has no FAT32 volume" RESETCOLOR "\r\n");
+        return false;
+    }
+    ConsolePrintf(PRIO_HIGH, "SD card mounted, %lu MByte\r\n", SDCard_GetBlockCount() / (1024 * 1024 / SDCARD_BLOCK_SIZE));
+    m.cardReady = true;
+    return true;
+}
+
+bool SDStream_Queue(uint8_t instance, const char *pFileName, uint16_t bytesPerFrame, bool loop)
+{
+    QueueEntry_t *pEntry;
+    assert(NULL != pFileName);
+    if (!m.cardReady || SDSTREAM_QUEUE_LEN <= m.queueCount || 0 == bytesPerFrame)
+        return false;
+    if (FILE_NAME_LEN <= strlen(pFileName))
+        return false;
+    pEntry = &m.queue[(m.queueHead + m.queueCount) % SDSTREAM_QUEUE_LEN];
+    strcpy(pEntry->name, pFileName);
+    pEntry->instance = instance;
+    pEntry->bytesPerFrame = bytesPerFrame;
+    pEntry->loop = loop;
+    m.queueCount++;
+    return true;
+}
+
+void SDStream_Stop(uint8_t instance)
+{
+    uint8_t i;
+    uint8_t kept = 0;
+    QueueEntry_t remaining[SDSTREAM_QUEUE_LEN];
+    for (i = 0; i < m.queueCount; i++)
+    {
+        const QueueEntry_t *pEntry = &m.queue[(m.queueHead + i) % SDSTREAM_QUEUE_LEN];
+        if (instance != pEntry->instance)
+            remaining[kept++] = *pEntry;
+    }
+    memcpy(m.queue, remaining, kept * sizeof(QueueEntry_t));
+    m.queueHead = 0;
+    m.queueCount = kept;
+    if (m.active && instance == m.instance)
+        m.active = false;
+}
+
+bool SDStream_IsActive(uint8_t instance)
+{
+    return (m.active && instance == m.instance);
+}
+
+const SDStream_Format_t *SDStream_GetFormat(uint8_t instance)
+{
+    return SDStream_IsActive(instance) ? &m.format : NULL;
+}
+
+uint32_t SDStream_Read(uint8_t instance, uint8_t *pBuf, uint32_t len)
+{
+    uint32_t copied = 0;
+    assert(NULL != pBuf);
+    if (!SDStream_IsActive(instance))
+        return 0;
+    while (copied < len && 0 != m.fill)
+    {
+        uint32_t limit = (m.readPos & ~BLOCK_MASK) + SDCARD_BLOCK_SIZE;
+        uint32_t chunk;
+        if (limit > m.dataEnd)
+            limit = m.dataEnd;
+        chunk = limit - m.readPos;
+        if (chunk > len - copied)
+            chunk = len - copied;
+        memcpy(&pBuf[copied], &ring[m.rdIdx][m.readPos & BLOCK_MASK], chunk);
+        copied += chunk;
+        m.readPos += chunk;
+        if (m.readPos != limit)
+            continue;
+        m.rdIdx = (m.rdIdx + 1) % m.depth;
+        m.fill--;
+        if (m.readPos == m.dataEnd)
+        {
+            if (!m.loop)
+            {
+                FinishFile();
+                return copied;
+            }
+            m.readPos = m.dataStart;
+        }
+    }
+    if (copied < len)
+        m.stats.underruns++;
+    return copied;
+}
+
+void SDStream_Service(void)
+{
+    if (!m.cardReady)
+        return;
+    if (m.xferPending)
+        CheckTransfer();
+    if (m.xferPending)
+        return;
+    if (!m.active && 0 != m.queueCount)
+    {
+        QueueEntry_t entry = m.queue[m.queueHead];
+        m.queueHead = (m.queueHead + 1) % SDSTREAM_QUEUE_LEN;
+        m.queueCount--;
+        if (!OpenFile(&entry))
+            ConsolePrintf(PRIO_ERROR, RED "SD stream: could not play '%s'" RESETCOLOR "\r\n", entry.name);
+    }
+    if (m.active)
+        StartNextRead();
+}
+
+const SDStream_Stats_t *SDStream_GetStats(void)
+{
+    return &m.stats;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool OpenFile(const QueueEntry_t *pEntry)
+{
+    uint32_t lba;
+    uint32_t blocks;
+    m.active = false;
+    if (!Fat32_Open(&m.file, pEntry->name))
+        return false;
+    m.dataStart = 0;
+    m.dataEnd = m.file.size;
+    m.format.sampleRate = SDSTREAM_FRAME_RATE;
+    m.format.channels = pEntry->bytesPerFrame / 2;
+    m.format.bitsPerSample = 16;
+    m.format.littleEndian = false;
+    if (HasWaveExtension(pEntry->name))
+    {
+        /* Header is read with the ring memory, it is not in use while no file is active */
+        blocks = Fat32_MapBlocks(&m.file, 0, &lba);
+        if (blocks > SDSTREAM_READ_BLOCKS)
+            blocks = SDSTREAM_READ_BLOCKS;
+        if (0 == blocks || !SDCard_ReadBlocks(lba, blocks, ring[0]))
+            return false;
+        if (!ParseWaveHeader(ring[0], blocks * SDCARD_BLOCK_SIZE))
+            return false;
+        if (pEntry->bytesPerFrame != m.format.channels * (m.format.bitsPerSample / 8))
+        {
+            ConsolePrintf(PRIO_ERROR, RED "SD stream: '%s' has %u ch/%u bit, channel expects %u bytes per frame" RESETCOLOR "\r\n",
+                pEntry->name, m.format.channels, m.format.bitsPerSample, pEntry->bytesPerFrame);
+            return false;
+        }
+        if (SDSTREAM_FRAME_RATE != m.format.sampleRate)
+            ConsolePrintf(PRIO_HIGH, YELLOW "SD stream: '%s' is sampled with %lu Hz, it will be played with %u Hz" RESETCOLOR "\r\n",
+                pEntry->name, m.format.sampleRate, SDSTREAM_FRAME_RATE);
+    }
+    if (m.dataStart >= m.dataEnd)
+        return false;
+    m.depth = ComputeDepth(pEntry->bytesPerFrame);
+    m.wrIdx = 0;
+    m.rdIdx = 0;
+    m.fill = 0;
+    m.retries = 0;
+    m.readPos = m.dataStart;
+    m.fetchPos = m.dataStart & ~BLOCK_MASK;
+    m.instance = pEntry->instance;
+    m.loop = pEntry->loop;
+    m.active = true;
+    ConsolePrintf(PRIO_HIGH, GREEN "SD stream: playing '%s' on sync instance %u, %lu bytes, read-ahead %u blocks" RESETCOLOR "\r\n",
+        pEntry->name, pEntry->instance, m.dataEnd - m.dataStart, m.depth);
+    return true;
+}
+
+static bool ParseWaveHeader(const uint8_t *pHdr, uint32_t hdrLen)
+{
+    uint32_t pos = 12;
+    bool fmtFound = false;
+    if (12 > hdrLen || 0 != memcmp(pHdr, "RIFF", 4) || 0 != memcmp(&pHdr[8], "WAVE", 4))
+        return false;
+    while (pos + 8 <= hdrLen)
+    {
+        const uint8_t *pChunk = &pHdr[pos];
+        uint32_t size = pChunk[4] | (pChunk[5] << 8) | (pChunk[6] << 16) | ((uint32_t)pChunk[7] << 24);
+        if (0 == memcmp(pChunk, "fmt ", 4))
+        {
+            /* Only uncompressed PCM (format tag 1) */
+            if (16 > size || pos + 8 + 16 > hdrLen || 1 != (pChunk[8] | (pChunk[9] << 8)))
+                return false;
+            m.format.channels = pChunk[10] | (pChunk[11] << 8);
+            m.format.sampleRate = pChunk[12] | (pChunk[13] << 8) | (pChunk[14] << 16) | ((uint32_t)pChunk[15] << 24);
+            m.format.bitsPerSample = pChunk[22] | (pChunk[23] << 8);
+            m.format.littleEndian = true;
+            /* The byte order is swapped for the network, which is only done for these sample sizes */
+            if (16 != m.format.bitsPerSample && 24 != m.format.bitsPerSample && 32 != m.format.bitsPerSample)
+            {
+                ConsolePrintf(PRIO_ERROR, RED "SD stream: %u bit samples are not supported" RESETCOLOR "\r\n", m.format.bitsPerSample);
+                return false;
+            }
+            fmtFound = true;
+        }
+        else if (0 == memcmp(pChunk, "data", 4))
+        {
+            if (!fmtFound)
+                return false;
+            m.dataStart = pos + 8;
+            if (m.dataStart > m.file.size)
+                return false;
+            if (size < m.file.size - m.dataStart)
+                m.dataEnd = m.dataStart + size;
+            return true;
+        }
+        /* Chunks before the samples must fit into the header block, this also keeps pos from wrapping */
+        if (size > hdrLen - pos - 8)
+            return false;
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
+
+static bool HasWaveExtension(const char *pName)
+{
+    const char *pExt = strrchr(pName, '.');
+    return (NULL != pExt
+        && 'W' == toupper((unsigned char)pExt[1])
+        && 'A' == toupper((unsigned char)pExt[2])
+        && 'V' == toupper((unsigned char)pExt[3])
+        && '\0' == pExt[4]);
+}
+
+static uint16_t ComputeDepth(uint16_t bytesPerFrame)
+{
+    uint32_t bytes = (uint32_t)bytesPerFrame * SDSTREAM_FRAME_RATE / 1000 * SDSTREAM_READAHEAD_MS;
+    uint32_t blocks = (bytes + SDCARD_BLOCK_SIZE - 1) / SDCARD_BLOCK_SIZE;
+    /* Round up to whole reads, keep at least one read in flight while another one is consumed */
+    blocks = ((blocks + SDSTREAM_READ_BLOCKS - 1) / SDSTREAM_READ_BLOCKS) * SDSTREAM_READ_BLOCKS;
+    if (blocks < 2 * SDSTREAM_READ_BLOCKS)
+        blocks = 2 * SDSTREAM_READ_BLOCKS;
+    if (blocks > SDSTREAM_POOL_BLOCKS)
+    {
+        ConsolePrintf(PRIO_ERROR, YELLOW "SD stream: read-ahead limited to %u blocks, increase SDSTREAM_POOL_BLOCKS" RESETCOLOR "\r\n", SDSTREAM_POOL_BLOCKS);
+        blocks = SDSTREAM_POOL_BLOCKS;
+    }
+    return (uint16_t)blocks;
+}
+
+static void CheckTransfer(void)
+{
+    uint32_t elapsed;
+    SDCard_State_t state = SDCard_GetState();
+    if (SDCard_State_Busy == state)
+        return;
+    m.xferPending = false;
+    elapsed = GetTicks() - m.xferStart;
+    if (elapsed > m.stats.maxReadTimeMs)
+        m.stats.maxReadTimeMs = elapsed;
+    if (!m.active)
+        return;
+    if (SDCard_State_Idle == state)
+    {
+        m.wrIdx = (m.wrIdx + m.xferBlocks) % m.depth;
+        m.fill += m.xferBlocks;
+        m.fetchPos += m.xferBlocks * SDCARD_BLOCK_SIZE;
+        m.stats.bytesRead += m.xferBlocks * SDCARD_BLOCK_SIZE;
+        m.retries = 0;
+    }
+    else
+    {
+        m.stats.readErrors++;
+        if (SDSTREAM_MAX_RETRIES <= ++m.retries)
+        {
+            ConsolePrintf(PRIO_ERROR, RED "SD stream: giving up after %u failed reads" RESETCOLOR "\r\n", m.retries);
+            m.active = false;
+        }
+    }
+}
+
+static void StartNextRead(void)
+{
+    uint32_t lba;
+    uint32_t blocks;
+    uint32_t mapped;
+    uint32_t toDataEnd;
+    if (m.fetchPos >= m.dataEnd)
+    {
+        if (!m.loop)
+            return;
+        m.fetchPos = m.dataStart & ~BLOCK_MASK;
+    }
+    /* Never cross the end of the ring, a DMA read needs a contiguous destination */
+    blocks = m.depth - m.wrIdx;
+    if (blocks > SDSTREAM_READ_BLOCKS)
+        blocks = SDSTREAM_READ_BLOCKS;
+    toDataEnd = (m.dataEnd - m.fetchPos + SDCARD_BLOCK_SIZE - 1) / SDCARD_BLOCK_SIZE;
+    if (blocks > toDataEnd)
+        blocks = toDataEnd;
+    if (blocks > (uint32_t)(m.depth - m.fill))
+        return;
+    mapped = Fat32_MapBlocks(&m.file, m.fetchPos, &lba);
+    if (0 == mapped)
+    {
+        ConsolePrintf(PRIO_ERROR, RED "SD stream: broken cluster chain" RESETCOLOR "\r\n");
+        m.active = false;
+        return;
+    }
+    if (blocks > mapped)
+        blocks = mapped;
+    if (!SDCard_StartRead(lba, (uint16_t)blocks, ring[m.wrIdx]))
+        return;
+    m.xferBlocks = (uint16_t)blocks;
+    m.xferStart = GetTicks();
+    m.xferPending = true;
+}
+
+static void FinishFile(void)
+{
+    m.active = false;
+    m.stats.filesPlayed++;
+    ConsolePrintf(PRIO_HIGH, "SD stream: finished, underruns=%lu, read errors=%lu, max read time=%lums\r\n",
+        m.stats.underruns, m.stats.readErrors, m.stats.maxReadTimeMs);
+}
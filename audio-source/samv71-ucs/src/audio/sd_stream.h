@@ -0,0 +1,139 @@
+/*------------------------------------------------------------------------------------------------*/
+/* SD Card Audio Streaming Source                                                                 */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Streams WAV or raw PCM files from the SD card into a
+ *         synchronous TX channel. A read-ahead ring, sized from the
+ *         channel rate, is refilled with multi-block DMA reads.
+ */
+/*----------------------------------------------------------*/
+#ifndef SD_STREAM_H_
+#define SD_STREAM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/** Maximum amount of files waiting for playback */
+#define SDSTREAM_QUEUE_LEN      (4)
+
+/** MOST frame rate, the sync channel delivers one subSize chunk per frame */
+#define SDSTREAM_FRAME_RATE     (48000)
+
+typedef struct
+{
+    uint32_t sampleRate;
+    uint16_t channels;
+    uint16_t bitsPerSample;
+    /** true for WAV (little endian), false for raw PCM which is expected in network byte order */
+    bool littleEndian;
+} SDStream_Format_t;
+
+typedef struct
+{
+    uint32_t filesPlayed;
+    uint32_t underruns;
+    uint32_t readErrors;
+    uint32_t bytesRead;
+    uint32_t maxReadTimeMs;
+} SDStream_Stats_t;
+
+/**
+ * \brief Initializes the SD card and mounts the file system.
+ * \note A missing card is not fatal, SDStream_Queue will just fail.
+ * \return true, if a card with FAT32 file system was found. false, otherwise.
+ */
+bool SDStream_Init(void);
+
+/**
+ * \brief Queues a file for playback on a synchronous TX instance.
+ * \note The file will be opened when all files queued before have finished.
+ * \param instance - The sync TX instance, as used with DIM2LLD_GetTxData
+ * \param pFileName - 8.3 file name in the root directory, files ending with ".wav" are parsed as RIFF WAVE (PCM with 16, 24 or 32 bit), all others are raw PCM
+ * \param bytesPerFrame - subSize of the sync channel, used to size the read-ahead and to check the file format
+ * \param loop - true, the file will be repeated until SDStream_Stop is called. false, it is played once.
+ * \return true, if the file was queued. false, if there is no card or the queue is full.
+ */
+bool SDStream_Queue(uint8_t instance, const char *pFileName, uint16_t bytesPerFrame, bool loop);
+
+/**
+ * \brief Stops the current playback on the given instance and drops all files queued for it.
+ * \param instance - The sync TX instance
+ */
+void SDStream_Stop(uint8_t instance);
+
+/**
+ * \brief Checks if there is a file currently streamed to the given instance.
+ * \param instance - The sync TX instance
+ * \return true, if SDStream_Read will deliver data for this instance.
+ */
+bool SDStream_IsActive(uint8_t instance);
+
+/**
+ * \brief Retrieves the format of the currently streamed file.
+ * \param instance - The sync TX instance
+ * \return Pointer to the format, NULL if the instance is not active.
+ */
+const SDStream_Format_t *SDStream_GetFormat(uint8_t instance);
+
+/**
+ * \brief Copies PCM data of the current file.
+ * \note Data is copied as it is stored in the file, the caller converts the sample format if needed.
+ * \param instance - The sync TX instance
+ * \param pBuf - Destination buffer
+ * \param len - Requested amount of bytes, should be a multiple of bytesPerFrame
+ * \return Amount of bytes copied. Less than len in case of an underrun or at the end of the file.
+ */
+uint32_t SDStream_Read(uint8_t instance, uint8_t *pBuf, uint32_t len);
+
+/**
+ * \brief Gives the stream time to refill its read-ahead ring and to start queued files.
+ */
+void SDStream_Service(void);
+
+/**
+ * \brief Returns the statistics since SDStream_Init.
+ * \return Pointer to the statistic counters.
+ */
+const SDStream_Stats_t *SDStream_GetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SD_STREAM_H_ */
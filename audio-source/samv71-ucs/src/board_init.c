@@ -36,6 +36,7 @@
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
 void TCM_StackInit(void);
+static void OnPhyLinkChanged(GMacb *pMacb, uint8_t linkUp);
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                      DEFINES AND LOCAL VARIABLES                     */
@@ -101,10 +102,6 @@ void Board_Init()
     LED_Clear(0);
     LED_Clear(1);
 
-    // enable GMAC interrupts
-    NVIC_ClearPendingIRQ(GMAC_IRQn);
-    NVIC_EnableIRQ(GMAC_IRQn);
-
     // Configure Board Pushbuttons
     // SW1 is a ERASE system function, switch it to port function
     MATRIX->CCFG_SYSIO |= (1u << 12);
@@ -129,28 +126,30 @@ void Board_Init()
     NVIC_ClearPendingIRQ(XDMAC_IRQn);
     NVIC_SetPriority(XDMAC_IRQn, 1);
     NVIC_EnableIRQ(XDMAC_IRQn);
+}
+
+void Board_InitEthernet(void)
+{
+    // enable GMAC interrupts
+    NVIC_ClearPendingIRQ(GMAC_IRQn);
+    NVIC_EnableIRQ(GMAC_IRQn);
 
     /* Initialize the hardware interface */
     init_gmac(&gGmacd);
 
-    /* Setup interrupts */
+    /* PHY initialize, done step by step in Board_EthernetService */
     GMACB_Init(&gGmacb, &gGmacd, BOARD_GMAC_PHY_ADDR);
-    GMACB_ResetPhy(&gGmacb);
+    GMACB_StartPhy(&gGmacb, BOARD_MCK, &gmacResetPin, 1, gmacPins, PIO_LISTSIZE(gmacPins), OnPhyLinkChanged);
+}
 
-    /* PHY initialize */
-    if (!GMACB_InitPhy(&gGmacb, BOARD_MCK, &gmacResetPin, 1, gmacPins, PIO_LISTSIZE(gmacPins))) {
-        printf("PHY Initialize ERROR!\n\r");
-        assert(false);
-    }
+void Board_EthernetService(void)
+{
+    GMACB_PhyService(&gGmacb);
+}
 
-    if(!GMACB_PhySetSpeed100(&gGmacb, 1u)) {
-        printf("Set Ethernet PHY Speed ERROR!\n\r");
-        assert(false);
-    }
-#ifdef DEBUG
-    //Phy takes a while until ready, do not wait for it in release variant
-    Wait(5000);
-#endif
+bool Board_IsEthernetLinkUp(void)
+{
+    return (0 != GMACB_IsLinkUp(&gGmacb));
 }
 
 bool Board_IsButtonPressed(Board_Button_t button)
@@ -166,6 +165,16 @@ bool Board_IsButtonPressed(Board_Button_t button)
     return false;
 }
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      CALLBACK FUNCTIONS FROM GMACB                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void OnPhyLinkChanged(GMacb *pMacb, uint8_t linkUp)
+{
+    pMacb = pMacb;
+    Board_CB_OnEthernetLink(0 != linkUp);
+}
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                            ISR HOOKS                                 */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
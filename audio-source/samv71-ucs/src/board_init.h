@@ -81,6 +81,24 @@ typedef enum
  */
 void Board_Init(void);
 
+/**
+ * \brief Initializes GMAC and starts the bring-up of the Ethernet PHY
+ * \note Does not wait for the PHY, Board_EthernetService completes the bring-up. Must be called before anything sends via gGmacd.
+ */
+void Board_InitEthernet(void);
+
+/**
+ * \brief Steps the Ethernet PHY bring-up and polls the link afterwards, never waits
+ * \note Call it on every tick, link changes are reported by Board_CB_OnEthernetLink
+ */
+void Board_EthernetService(void);
+
+/**
+ * \brief Checks the Ethernet link
+ * \return true, if the PHY reported link up on the last poll. false, otherwise
+ */
+bool Board_IsEthernetLinkUp(void);
+
 /**
  * \brief Checks if the given button is pressed
  * \param button - Enumeration specifying the button to check
@@ -88,6 +106,17 @@ void Board_Init(void);
  */
 bool Board_IsButtonPressed(Board_Button_t button);
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                        CALLBACK SECTION                              */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/**
+ * \brief Callback when the Ethernet link goes up or down, called from Board_EthernetService
+ * \note This function must be implemented by the integrator
+ * \param isUp - true, if the link is up. false, if it went down
+ */
+extern void Board_CB_OnEthernetLink(bool isUp);
+
 #ifdef __cplusplus
 }
 #endif
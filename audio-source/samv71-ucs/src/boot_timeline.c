@@ -0,0 +1,132 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Boot Timeline Implementation                                                                   */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <assert.h>
+#include "Console.h"
+#include "timetick.h"
+#include "boot_timeline.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* Print the incomplete timeline, if no audio was streamed after this time */
+#define BOOT_REPORT_TIMEOUT_MS  (30000)
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+typedef struct
+{
+    uint32_t reached;
+    uint32_t times[BOOT_MILESTONE_COUNT];
+    bool reported;
+} LocalVar_t;
+
+/* Zero initialized by the startup code, so milestones can be marked before main initializes anything */
+static LocalVar_t m;
+
+static const char *const milestoneNames[BOOT_MILESTONE_COUNT] =
+{
+    "board init",
+    "console init",
+    "mlb started",
+    "ethernet init",
+    "ethernet link",
+    "mlb locked",
+    "channels ready",
+    "ucsi init",
+    "network up",
+    "route active",
+    "first audio"
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void PrintTimeline(void);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void BootTimeline_Mark(BootTimeline_Milestone_t milestone)
+{
+    assert(BOOT_MILESTONE_COUNT > milestone);
+    if (0 != (m.reached & (1u << milestone)))
+        return;
+    m.times[milestone] = GetTicks();
+    m.reached |= (1u << milestone);
+}
+
+bool BootTimeline_IsReached(BootTimeline_Milestone_t milestone)
+{
+    assert(BOOT_MILESTONE_COUNT > milestone);
+    return (0 != (m.reached & (1u << milestone)));
+}
+
+void BootTimeline_Service(void)
+{
+    if (m.reported)
+        return;
+    if (!BootTimeline_IsReached(BOOT_FIRST_AUDIO) && GetTicks() < BOOT_REPORT_TIMEOUT_MS)
+        return;
+    m.reported = true;
+    PrintTimeline();
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void PrintTimeline(void)
+{
+    uint32_t i;
+    uint32_t last = 0;
+    if (BootTimeline_IsReached(BOOT_FIRST_AUDIO))
+        ConsolePrintf(PRIO_HIGH, GREEN "Boot timeline, first audio after %lums:" RESETCOLOR "\r\n", m.times[BOOT_FIRST_AUDIO]);
+    else
+        ConsolePrintf(PRIO_HIGH, YELLOW "Boot timeline, no audio after %lums:" RESETCOLOR "\r\n", (uint32_t)BOOT_REPORT_TIMEOUT_MS);
+    for (i = 0; i < BOOT_MILESTONE_COUNT; i++)
+    {
+        if (!BootTimeline_IsReached((BootTimeline_Milestone_t)i))
+        {
+            ConsolePrintf(PRIO_HIGH, "  %-16s not reached\r\n", milestoneNames[i]);
+            continue;
+        }
+        /* Milestones may overlap, so the delta is taken to the latest one before */
+        ConsolePrintf(PRIO_HIGH, "  %-16s %6lums (+%lums)\r\n", milestoneNames[i], m.times[i],
+            (m.times[i] >= last) ? (m.times[i] - last) : 0);
+        if (m.times[i] > last)
+            last = m.times[i];
+    }
+}
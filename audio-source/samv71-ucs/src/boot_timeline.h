@@ -0,0 +1,93 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Boot Timeline                                                                                  */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Records a timestamp for every phase of the startup,
+ *         from Board_Init until the first sync frame of an active
+ *         route, and prints the timeline once the boot is done.
+ */
+/*----------------------------------------------------------*/
+#ifndef BOOT_TIMELINE_H_
+#define BOOT_TIMELINE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* In the order they are expected during a normal boot */
+typedef enum
+{
+    BOOT_BOARD_INIT = 0,    /**< Clocks, caches, TWI and DMA are up */
+    BOOT_CONSOLE_INIT,
+    BOOT_MLB_STARTED,       /**< DIM2 started, MLB PLL is locking */
+    BOOT_ETHERNET_INIT,     /**< GMAC initialized, PHY bring-up started */
+    BOOT_ETHERNET_LINK,     /**< First Ethernet link up, not needed for audio */
+    BOOT_MLB_LOCKED,
+    BOOT_CHANNELS_READY,    /**< All MLB channels allocated */
+    BOOT_UCSI_INIT,         /**< UNICENS configuration enqueued */
+    BOOT_NETWORK_UP,
+    BOOT_ROUTE_ACTIVE,      /**< First route built */
+    BOOT_FIRST_AUDIO,       /**< First sync frame after a route became active */
+    BOOT_MILESTONE_COUNT
+} BootTimeline_Milestone_t;
+
+/**
+ * \brief Records the current time for the given milestone. Only the first call per milestone counts.
+ * \note Can be called before any other component is initialized, times are taken from GetTicks().
+ * \param milestone - The reached milestone
+ */
+void BootTimeline_Mark(BootTimeline_Milestone_t milestone);
+
+/**
+ * \brief Checks if the given milestone was already reached.
+ * \param milestone - The milestone to check
+ * \return true, if BootTimeline_Mark was called for it.
+ */
+bool BootTimeline_IsReached(BootTimeline_Milestone_t milestone);
+
+/**
+ * \brief Prints the timeline once BOOT_FIRST_AUDIO was reached, or after BOOT_REPORT_TIMEOUT_MS with
+ *        the missing milestones. Call it cyclically from the main loop.
+ */
+void BootTimeline_Service(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BOOT_TIMELINE_H_ */
@@ -1,6 +1,6 @@
 /*------------------------------------------------------------------------------------------------*/
 /* UNICENS Generated Network Configuration                                                        */
-/* Generator: xml2struct for Windows V4.4.0                                                       */
+/* Generator: xml2struct.py V1.0.0                                                                */
 /*------------------------------------------------------------------------------------------------*/
 #include "ucs_api.h"
 
@@ -158,13 +158,13 @@ UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response1ForNode270 = {
     0x00,
     NULL };
 UCS_NS_CONST uint8_t PayloadRequest2ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x02, 0x00, 0x64, 0x1B, 0x80 };
+    0x0F, 0x00, 0x02, 0x05, 0x2A, 0x02, 0x00, 0x64, 0x1B, 0x80, 0x11, 0xB8, 0x12, 0x60, 0x13, 0xA0, 0x14, 0x48 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request2ForNode270 = {
     0x00,
     0x01,
     0x06C4,
     0x02,
-    0x0A,
+    0x12,
     PayloadRequest2ForNode270 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response2ForNode270 = {
     0x00,
@@ -174,13 +174,13 @@ UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response2ForNode270 = {
     0x00,
     NULL };
 UCS_NS_CONST uint8_t PayloadRequest3ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x02, 0x00, 0x64, 0x11, 0xB8 };
+    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x05, 0x00, 0x64, 0x20, 0x00, 0x89, 0x77, 0x72 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request3ForNode270 = {
     0x00,
     0x01,
     0x06C4,
     0x02,
-    0x0A,
+    0x0D,
     PayloadRequest3ForNode270 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response3ForNode270 = {
     0x00,
@@ -190,13 +190,13 @@ UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response3ForNode270 = {
     0x00,
     NULL };
 UCS_NS_CONST uint8_t PayloadRequest4ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x02, 0x00, 0x64, 0x12, 0x60 };
+    0x0F, 0x00, 0x02, 0x02, 0x2A, 0x02, 0x00, 0x64, 0x06, 0x00, 0x05, 0x00 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request4ForNode270 = {
     0x00,
     0x01,
     0x06C4,
     0x02,
-    0x0A,
+    0x0C,
     PayloadRequest4ForNode270 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response4ForNode270 = {
     0x00,
@@ -206,13 +206,13 @@ UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response4ForNode270 = {
     0x00,
     NULL };
 UCS_NS_CONST uint8_t PayloadRequest5ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x02, 0x00, 0x64, 0x13, 0xA0 };
+    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x03, 0x00, 0x64, 0x07, 0x01, 0x50 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request5ForNode270 = {
     0x00,
     0x01,
     0x06C4,
     0x02,
-    0x0A,
+    0x0B,
     PayloadRequest5ForNode270 };
 UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response5ForNode270 = {
     0x00,
@@ -221,86 +221,6 @@ UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response5ForNode270 = {
     0x0C,
     0x00,
     NULL };
-UCS_NS_CONST uint8_t PayloadRequest6ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x02, 0x00, 0x64, 0x14, 0x48 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request6ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x02,
-    0x0A,
-    PayloadRequest6ForNode270 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response6ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x0C,
-    0x00,
-    NULL };
-UCS_NS_CONST uint8_t PayloadRequest7ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x05, 0x00, 0x64, 0x20, 0x00, 0x89, 0x77, 0x72 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request7ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x02,
-    0x0D,
-    PayloadRequest7ForNode270 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response7ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x0C,
-    0x00,
-    NULL };
-UCS_NS_CONST uint8_t PayloadRequest8ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x02, 0x00, 0x64, 0x06, 0x00 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request8ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x02,
-    0x0A,
-    PayloadRequest8ForNode270 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response8ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x0C,
-    0x00,
-    NULL };
-UCS_NS_CONST uint8_t PayloadRequest9ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x02, 0x00, 0x64, 0x05, 0x00 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request9ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x02,
-    0x0A,
-    PayloadRequest9ForNode270 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response9ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x0C,
-    0x00,
-    NULL };
-UCS_NS_CONST uint8_t PayloadRequest10ForNode270[] = {
-    0x0F, 0x00, 0x00, 0x00, 0x2A, 0x03, 0x00, 0x64, 0x07, 0x01, 0x50 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Request10ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x02,
-    0x0B,
-    PayloadRequest10ForNode270 };
-UCS_NS_CONST Ucs_Ns_ConfigMsg_t Response10ForNode270 = {
-    0x00,
-    0x01,
-    0x06C4,
-    0x0C,
-    0x00,
-    NULL };
 UCS_NS_CONST Ucs_Ns_Script_t ScriptsForNode270[] = {
     {
         0,
@@ -322,26 +242,6 @@ UCS_NS_CONST Ucs_Ns_Script_t ScriptsForNode270[] = {
         0,
         &Request5ForNode270,
         &Response5ForNode270
-    }, {
-        0,
-        &Request6ForNode270,
-        &Response6ForNode270
-    }, {
-        0,
-        &Request7ForNode270,
-        &Response7ForNode270
-    }, {
-        0,
-        &Request8ForNode270,
-        &Response8ForNode270
-    }, {
-        0,
-        &Request9ForNode270,
-        &Response9ForNode270
-    }, {
-        0,
-        &Request10ForNode270,
-        &Response10ForNode270
     } };
 UCS_NS_CONST uint8_t PayloadRequest1ForNode240[] = {
     0x00, 0x00, 0x01, 0x01 };
@@ -421,7 +321,7 @@ Ucs_Rm_Node_t AllNodes[] = {
     }, {
         &SignatureForNode270,
         ScriptsForNode270,
-        10
+        5
     }, {
         &SignatureForNode240,
         ScriptsForNode240,
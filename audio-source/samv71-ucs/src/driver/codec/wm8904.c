@@ -0,0 +1,177 @@
+/*------------------------------------------------------------------------------------------------*/
+/* WM8904 Audio Codec Driver Implementation                                                       */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <stddef.h>
+#include <assert.h>
+#include "board.h"
+#include "timetick.h"
+#include "wm8904.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* Headphone volume after initialization, 57 is 0dB */
+#define WM8904_DEFAULT_VOLUME       (0x39)
+/* Line input PGA gain, 5 is 0dB */
+#define WM8904_INPUT_GAIN           (0x05)
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define WM8904_TWI_ADDRESS          (0x1A)
+
+#define REG_SW_RESET                (0x00)
+#define REG_BIAS_CONTROL_0          (0x04)
+#define REG_VMID_CONTROL_0          (0x05)
+#define REG_POWER_MANAGEMENT_0      (0x0C)
+#define REG_POWER_MANAGEMENT_2      (0x0E)
+#define REG_POWER_MANAGEMENT_6      (0x12)
+#define REG_CLOCK_RATES_0           (0x14)
+#define REG_CLOCK_RATES_1           (0x15)
+#define REG_CLOCK_RATES_2           (0x16)
+#define REG_AUDIO_INTERFACE_1       (0x19)
+#define REG_AUDIO_INTERFACE_2       (0x1A)
+#define REG_AUDIO_INTERFACE_3       (0x1B)
+#define REG_DAC_DIGITAL_1           (0x21)
+#define REG_ANALOGUE_LEFT_INPUT_0   (0x2C)
+#define REG_ANALOGUE_RIGHT_INPUT_0  (0x2D)
+#define REG_ANALOGUE_OUT1_LEFT      (0x39)
+#define REG_ANALOGUE_OUT1_RIGHT     (0x3A)
+#define REG_DC_SERVO_0              (0x43)
+#define REG_DC_SERVO_1              (0x44)
+#define REG_ANALOGUE_HP_0           (0x5A)
+#define REG_CHARGE_PUMP_0           (0x62)
+#define REG_CLASS_W_0               (0x68)
+#define REG_FLL_CONTROL_1           (0x74)
+#define REG_FLL_CONTROL_2           (0x75)
+#define REG_FLL_CONTROL_3           (0x76)
+#define REG_FLL_CONTROL_4           (0x77)
+
+/* HPL and HPR bits of the headphone analog control, enabled in the order required by the datasheet */
+#define HP_ENA                      (0x0011)
+#define HP_ENA_DLY                  (0x0022)
+#define HP_ENA_OUTP                 (0x0044)
+#define HP_RMV_SHORT                (0x0088)
+#define HPOUT_VU                    (0x0080)
+
+typedef struct
+{
+    uint8_t reg;
+    uint16_t value;
+    uint8_t waitMs;
+} RegWrite_t;
+
+/* 32768Hz * 187.5 * 16 / 8 = 12.288MHz = 256fs for 48kHz, BCLK = 32fs */
+static const RegWrite_t initSequence[] =
+{
+    { REG_SW_RESET,                 0x0000, 5 },
+    { REG_BIAS_CONTROL_0,           0x0008, 0 },    /* ISEL_HP_BIAS */
+    { REG_VMID_CONTROL_0,           0x0047, 5 },    /* VMID_BUF_ENA, fast start, VMID_ENA */
+    { REG_VMID_CONTROL_0,           0x0043, 0 },    /* normal VMID resistor */
+    { REG_BIAS_CONTROL_0,           0x0009, 0 },    /* BIAS_ENA */
+    { REG_POWER_MANAGEMENT_0,       0x0003, 0 },    /* INL_ENA, INR_ENA */
+    { REG_POWER_MANAGEMENT_2,       0x0003, 0 },    /* HPL_PGA_ENA, HPR_PGA_ENA */
+    { REG_DAC_DIGITAL_1,            0x0000, 0 },
+    { REG_CHARGE_PUMP_0,            0x0001, 0 },    /* CP_ENA */
+    { REG_CLASS_W_0,                0x0001, 0 },    /* CP_DYN_PWR */
+    { REG_FLL_CONTROL_1,            0x0000, 0 },
+    { REG_FLL_CONTROL_2,            0x0704, 0 },    /* FLL_OUTDIV 8, FLL_FRATIO 16 */
+    { REG_FLL_CONTROL_3,            0x8000, 0 },    /* FLL_K 0.5 */
+    { REG_FLL_CONTROL_4,            0x1760, 0 },    /* FLL_N 187 */
+    { REG_FLL_CONTROL_1,            0x0005, 5 },    /* FLL_FRACN_ENA, FLL_ENA */
+    { REG_CLOCK_RATES_1,            0x0C05, 0 },    /* CLK_SYS_RATE 256fs, SAMPLE_RATE 48kHz */
+    { REG_CLOCK_RATES_0,            0x0000, 0 },
+    { REG_CLOCK_RATES_2,            0x4006, 0 },    /* SYSCLK_SRC FLL, CLK_SYS_ENA, CLK_DSP_ENA */
+    { REG_AUDIO_INTERFACE_1,        0x0042, 0 },    /* BCLK_DIR master, I2S, 16 bit */
+    { REG_AUDIO_INTERFACE_2,        0x0008, 0 },    /* BCLK_DIV 8 */
+    { REG_AUDIO_INTERFACE_3,        0x0820, 0 },    /* LRCLK_DIR master, LRCLK_RATE 32 */
+    { REG_POWER_MANAGEMENT_6,       0x000F, 5 },    /* DACL_ENA, DACR_ENA, ADCL_ENA, ADCR_ENA */
+    { REG_ANALOGUE_LEFT_INPUT_0,    WM8904_INPUT_GAIN, 0 },
+    { REG_ANALOGUE_RIGHT_INPUT_0,   WM8904_INPUT_GAIN, 0 },
+    { REG_ANALOGUE_HP_0,            HP_ENA, 0 },
+    { REG_ANALOGUE_HP_0,            HP_ENA | HP_ENA_DLY, 0 },
+    { REG_DC_SERVO_0,               0x0003, 0 },    /* DCS_ENA_CHAN_0/1 */
+    { REG_DC_SERVO_1,               0x0030, 100 },  /* DCS_TRIG_STARTUP_0/1, offset calibration of the headphone */
+    { REG_ANALOGUE_HP_0,            HP_ENA | HP_ENA_DLY | HP_ENA_OUTP, 0 },
+    { REG_ANALOGUE_HP_0,            HP_ENA | HP_ENA_DLY | HP_ENA_OUTP | HP_RMV_SHORT, 0 },
+    { REG_ANALOGUE_OUT1_LEFT,       HPOUT_VU | WM8904_DEFAULT_VOLUME, 0 },
+    { REG_ANALOGUE_OUT1_RIGHT,      HPOUT_VU | WM8904_DEFAULT_VOLUME, 0 },
+};
+
+static Twid *pTwi = NULL;
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool WriteRegister(uint8_t reg, uint16_t value);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool WM8904_Init(Twid *pTwid)
+{
+    uint32_t i;
+    assert(NULL != pTwid);
+    pTwi = pTwid;
+    /* FLL reference, 32.768kHz slow clock on PCK2 (MCLK of the codec) */
+    PMC_ConfigurePCK2(PMC_PCK_CSS_SLOW_CLK, PMC_PCK_PRES(0));
+    for (i = 0; i < sizeof(initSequence) / sizeof(RegWrite_t); i++)
+    {
+        if (!WriteRegister(initSequence[i].reg, initSequence[i].value))
+            return false;
+        if (0 != initSequence[i].waitMs)
+            Wait(initSequence[i].waitMs);
+    }
+    return true;
+}
+
+bool WM8904_SetVolume(uint8_t volume)
+{
+    if (NULL == pTwi || 0x3F < volume)
+        return false;
+    return WriteRegister(REG_ANALOGUE_OUT1_LEFT, volume)
+        && WriteRegister(REG_ANALOGUE_OUT1_RIGHT, HPOUT_VU | volume);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool WriteRegister(uint8_t reg, uint16_t value)
+{
+    uint8_t data[2];
+    data[0] = (uint8_t)(value >> 8);
+    data[1] = (uint8_t)value;
+    return (0 == TWID_Write(pTwi, WM8904_TWI_ADDRESS, reg, 1, data, sizeof(data), NULL));
+}
@@ -26,6 +26,8 @@
 #include "board.h"
 #include "dim2_hardware.h"
 #include "Console.h"
+#include "event_loop.h"
+#include "profile.h"
 
 void enable_mlb_clock(void)
 {
@@ -84,16 +86,22 @@ void dimcb_on_error(uint8_t error_id, const char *error_message)
 
 void mlb_int_handler(void)
 {
+    PROFILE_BEGIN(PROF_MLB_ISR);
     irqflags_t flags = cpu_irq_save();
 
     on_mlb_int_isr();
     cpu_irq_restore(flags);
+    EventLoop_Post(EVENT_MLB);
+    PROFILE_END(PROF_MLB_ISR);
 }
 
 void ahb0_int_handler(void)
 {
+    PROFILE_BEGIN(PROF_AHB_ISR);
     irqflags_t flags = cpu_irq_save();
 
     on_ahb0_int_isr();
     cpu_irq_restore(flags);
+    EventLoop_Post(EVENT_MLB);
+    PROFILE_END(PROF_AHB_ISR);
 }
@@ -28,6 +28,7 @@
 #include "dim2_hal.h"
 #include "dim2_lld.h"
 #include "dim2_hardware.h"
+#include "profile.h"
 
 //USE CASE SPECIFIC:
 //Depending from this value, different buffer sizes must be used for synchronous streaming (ask for helper tool):
@@ -71,6 +72,9 @@ typedef struct {
     DIM2LLD_ChannelType_t cType;
     DIM2LLD_ChannelDirection_t dir;
     uint8_t lastPacketCount;
+    uint16_t channelAddress;
+    uint16_t bufferSize;
+    uint16_t subSize;
 } ChannelContext_t;
 
 typedef struct {
@@ -217,6 +221,25 @@ static bool AddDimChannelToIsrList(struct dim_channel *ch)
     return added;
 }
 
+//Must be called with disabled MLB interrupt
+static uint8_t InitDimChannel(ChannelContext_t *context)
+{
+    uint8_t isTx = (DIM2LLD_ChannelDirection_TX == context->dir);
+    switch (context->cType) {
+    case DIM2LLD_ChannelType_Control:
+        return dim_init_control(context->dimChannel, isTx, context->channelAddress, context->bufferSize);
+    case DIM2LLD_ChannelType_Async:
+        return dim_init_async(context->dimChannel, isTx, context->channelAddress, context->bufferSize);
+    case DIM2LLD_ChannelType_Sync:
+        return dim_init_sync(context->dimChannel, isTx, context->channelAddress, context->subSize);
+    case DIM2LLD_ChannelType_Isoc:
+        return dim_init_isoc(context->dimChannel, isTx, context->channelAddress, context->subSize);
+    default:
+        assert(false);
+        return DIM_ERR_BAD_CONFIG;
+    }
+}
+
 bool DIM2LLD_Init(void)
 {
     assert(!lc.initialized);
@@ -269,6 +292,9 @@ bool DIM2LLD_SetupChannel(DIM2LLD_ChannelType_t cType,
         return false;
     context->cType = cType;
     context->dir = dir;
+    context->channelAddress = channelAddress;
+    context->bufferSize = bufferSize;
+    context->subSize = subSize;
     context->workingStruct = (QueueEntry_t *)calloc(numberOfBuffers,
                              sizeof(QueueEntry_t));
     for (i = 0; i < numberOfBuffers; i++) {
@@ -287,32 +313,35 @@ bool DIM2LLD_SetupChannel(DIM2LLD_ChannelType_t cType,
            NULL != context->dimChannel);
     AddDimChannelToIsrList(context->dimChannel);
     disable_mlb_interrupt();
-    switch (cType) {
-    case DIM2LLD_ChannelType_Control:
-        result = dim_init_control(context->dimChannel,
-                                  (DIM2LLD_ChannelDirection_TX == dir), channelAddress, bufferSize);
-        enable_mlb_interrupt();
-        return (DIM_NO_ERROR == result);
-    case DIM2LLD_ChannelType_Async:
-        result = dim_init_async(context->dimChannel,
-                                (DIM2LLD_ChannelDirection_TX == dir), channelAddress, bufferSize);
-        enable_mlb_interrupt();
-        return (DIM_NO_ERROR == result);
-    case DIM2LLD_ChannelType_Sync:
-        result = dim_init_sync(context->dimChannel,
-                               (DIM2LLD_ChannelDirection_TX == dir), channelAddress, subSize);
-        enable_mlb_interrupt();
-        return (DIM_NO_ERROR == result);
-    case DIM2LLD_ChannelType_Isoc:
-        result = dim_init_isoc(context->dimChannel,
-                               (DIM2LLD_ChannelDirection_TX == dir), channelAddress, subSize);
-        enable_mlb_interrupt();
-        return (DIM_NO_ERROR == result);
-    default:
-        enable_mlb_interrupt();
-        assert(false);
+    result = InitDimChannel(context);
+    enable_mlb_interrupt();
+    return (DIM_NO_ERROR == result);
+}
+
+bool DIM2LLD_ResetChannel(DIM2LLD_ChannelType_t cType,
+                          DIM2LLD_ChannelDirection_t dir, uint8_t instance)
+{
+    uint8_t result;
+    uint16_t i;
+    ChannelContext_t *context;
+    assert(lc.initialized);
+    if (!lc.initialized)
         return false;
+    context = GetDimContext(cType, dir, instance);
+    if (NULL == context || !context->channelUsed)
+        return false;
+    //Buffers and the ISR list entry are kept, only the hardware channel and the queue start over
+    disable_mlb_interrupt();
+    dim_destroy_channel(context->dimChannel);
+    for (i = 0; i < context->amountOfEntries; i++) {
+        context->workingStruct[i].hwEnqueued = false;
+        context->workingStruct[i].payloadLen = 0;
     }
+    RingBuffer_Init(context->ringBuffer, context->amountOfEntries, sizeof(QueueEntry_t),
+                    context->workingStruct);
+    result = InitDimChannel(context);
+    enable_mlb_interrupt();
+    return (DIM_NO_ERROR == result);
 }
 
 void DIM2LLD_Deinit(void)
@@ -455,6 +484,7 @@ void DIM2LLD_Service(void)
     assert(lc.initialized);
     if (!lc.initialized)
         return;
+    PROFILE_BEGIN(PROF_DIM2_SERVICE);
 
     //Handle TX channels
     ServiceTxChannel(&lc.controlLookupTable[DIM2LLD_ChannelDirection_TX]);
@@ -471,6 +501,7 @@ void DIM2LLD_Service(void)
         ServiceRxChannel(&lc.syncLookupTable[DIM2LLD_ChannelDirection_RX][i]);
         ServiceRxChannel(&lc.isocLookupTable[DIM2LLD_ChannelDirection_RX][i]);
     }
+    PROFILE_END(PROF_DIM2_SERVICE);
 }
 
 bool DIM2LLD_IsMlbLocked(void)
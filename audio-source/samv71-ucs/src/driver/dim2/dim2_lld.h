@@ -72,6 +72,17 @@ bool DIM2LLD_SetupChannel(DIM2LLD_ChannelType_t cType,
                           uint16_t bufferSize, uint16_t subSize, uint16_t numberOfBuffers, uint16_t bufferOffset);
 
 
+/** \brief Resets a communication channel, which was set up by DIM2LLD_SetupChannel before.
+* \note All queued data of the channel is dropped and the DIM2 channel is initialized again with the same parameters. Other channels are not touched.
+* \param cType - The data type which shall be used for this channel
+* \param dir - The direction for this unidirectional channel
+* \param instance - For Isoc or Sync channels multiple instances may be used, starting with 0 for the first instance. For Control and Async there is only instance per direction allowed.
+* \return true, if the channel could be initialized again, false otherwise.
+*/
+bool DIM2LLD_ResetChannel(DIM2LLD_ChannelType_t cType,
+                          DIM2LLD_ChannelDirection_t dir, uint8_t instance);
+
+
 /** \brief Deinitializes the DIM Low Level Driver
 *
 */
@@ -0,0 +1,227 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Read-only FAT32 File Access                                                                    */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+#include "sd_card.h"
+#include "fat32.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define LE16(p)             ((uint16_t)((p)[0] | ((p)[1] << 8)))
+#define LE32(p)             ((uint32_t)((p)[0] | ((p)[1] << 8) | ((p)[2] << 16) | ((uint32_t)(p)[3] << 24)))
+
+#define FAT_CLUSTER_MASK    (0x0FFFFFFFu)
+#define FAT_CLUSTER_EOC     (0x0FFFFFF8u)
+#define DIR_ENTRY_SIZE      (32)
+#define DIR_ATTR_VOLUME_ID  (0x08)
+#define DIR_ATTR_DIRECTORY  (0x10)
+#define DIR_ATTR_LFN        (0x0F)
+#define DIR_ENTRY_FREE      (0xE5)
+
+typedef struct
+{
+    bool mounted;
+    uint32_t fatLba;
+    uint32_t dataLba;
+    uint32_t rootCluster;
+    uint8_t sectorsPerCluster;
+    uint32_t cachedLba;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+static SDCARD_BUFFER uint8_t sector[SDCARD_BLOCK_SIZE];
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool ReadSector(uint32_t lba);
+static bool IsFat32BootSector(void);
+static uint32_t NextCluster(uint32_t cluster);
+static uint32_t ClusterToLba(uint32_t cluster);
+static void ToShortName(const char *pName, char *pShort);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool Fat32_Mount(void)
+{
+    uint32_t volumeLba = 0;
+    uint16_t reserved;
+    uint32_t fatSize;
+    memset(&m, 0, sizeof(m));
+    m.cachedLba = 0xFFFFFFFF;
+    if (!ReadSector(0))
+        return false;
+    if (!IsFat32BootSector())
+    {
+        /* Partitioned card, take the first entry of the MBR partition table */
+        const uint8_t *entry = &sector[0x1BE];
+        if (0x55 != sector[510] || 0xAA != sector[511])
+            return false;
+        if (0x0B != entry[4] && 0x0C != entry[4])
+            return false;
+        volumeLba = LE32(&entry[8]);
+        if (!ReadSector(volumeLba) || !IsFat32BootSector())
+            return false;
+    }
+    if (SDCARD_BLOCK_SIZE != LE16(&sector[11]))
+        return false;
+    m.sectorsPerCluster = sector[13];
+    reserved = LE16(&sector[14]);
+    fatSize = LE32(&sector[36]);
+    m.rootCluster = LE32(&sector[44]);
+    m.fatLba = volumeLba + reserved;
+    m.dataLba = m.fatLba + sector[16] * fatSize;
+    if (0 == m.sectorsPerCluster || 2 > m.rootCluster)
+        return false;
+    m.mounted = true;
+    return true;
+}
+
+bool Fat32_Open(Fat32_File_t *pFile, const char *pName)
+{
+    char shortName[11];
+    uint32_t cluster;
+    assert(NULL != pFile && NULL != pName);
+    memset(pFile, 0, sizeof(Fat32_File_t));
+    if (!m.mounted)
+        return false;
+    ToShortName(pName, shortName);
+    for (cluster = m.rootCluster; 2 <= cluster && FAT_CLUSTER_EOC > cluster; cluster = NextCluster(cluster))
+    {
+        uint8_t s;
+        for (s = 0; s < m.sectorsPerCluster; s++)
+        {
+            uint16_t e;
+            if (!ReadSector(ClusterToLba(cluster) + s))
+                return false;
+            for (e = 0; e < SDCARD_BLOCK_SIZE; e += DIR_ENTRY_SIZE)
+            {
+                const uint8_t *entry = &sector[e];
+                if (0x00 == entry[0])
+                    return false;
+                if (DIR_ENTRY_FREE == entry[0] || DIR_ATTR_LFN == entry[11])
+                    continue;
+                if (0 != (entry[11] & (DIR_ATTR_VOLUME_ID | DIR_ATTR_DIRECTORY)))
+                    continue;
+                if (0 != memcmp(entry, shortName, sizeof(shortName)))
+                    continue;
+                pFile->firstCluster = ((uint32_t)LE16(&entry[20]) << 16) | LE16(&entry[26]);
+                pFile->size = LE32(&entry[28]);
+                pFile->curIndex = 0;
+                pFile->curCluster = pFile->firstCluster;
+                return (0 != pFile->firstCluster);
+            }
+        }
+    }
+    return false;
+}
+
+uint32_t Fat32_MapBlocks(Fat32_File_t *pFile, uint32_t offset, uint32_t *pLba)
+{
+    uint32_t clusterBytes = m.sectorsPerCluster * SDCARD_BLOCK_SIZE;
+    uint32_t index = offset / clusterBytes;
+    uint32_t blockInCluster = (offset % clusterBytes) / SDCARD_BLOCK_SIZE;
+    uint32_t blocksLeftInFile;
+    uint32_t count;
+    assert(NULL != pFile && NULL != pLba);
+    assert(0 == offset % SDCARD_BLOCK_SIZE);
+    if (!m.mounted || 0 == pFile->firstCluster || offset >= pFile->size)
+        return 0;
+    if (index < pFile->curIndex)
+    {
+        pFile->curIndex = 0;
+        pFile->curCluster = pFile->firstCluster;
+    }
+    while (pFile->curIndex < index)
+    {
+        pFile->curCluster = NextCluster(pFile->curCluster);
+        if (2 > pFile->curCluster || FAT_CLUSTER_EOC <= pFile->curCluster)
+            return 0;
+        pFile->curIndex++;
+    }
+    *pLba = ClusterToLba(pFile->curCluster) + blockInCluster;
+    count = m.sectorsPerCluster - blockInCluster;
+    blocksLeftInFile = (pFile->size - offset + SDCARD_BLOCK_SIZE - 1) / SDCARD_BLOCK_SIZE;
+    return (count < blocksLeftInFile) ? count : blocksLeftInFile;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static bool ReadSector(uint32_t lba)
+{
+    if (lba == m.cachedLba)
+        return true;
+    m.cachedLba = 0xFFFFFFFF;
+    if (!SDCard_ReadBlocks(lba, 1, sector))
+        return false;
+    m.cachedLba = lba;
+    return true;
+}
+
+static bool IsFat32BootSector(void)
+{
+    return (0x55 == sector[510] && 0xAA == sector[511] && 0 == memcmp(&sector[82], "FAT32", 5));
+}
+
+static uint32_t NextCluster(uint32_t cluster)
+{
+    uint32_t offset = cluster * 4;
+    if (!ReadSector(m.fatLba + offset / SDCARD_BLOCK_SIZE))
+        return 0;
+    return LE32(&sector[offset % SDCARD_BLOCK_SIZE]) & FAT_CLUSTER_MASK;
+}
+
+static uint32_t ClusterToLba(uint32_t cluster)
+{
+    return m.dataLba + (cluster - 2) * m.sectorsPerCluster;
+}
+
+static void ToShortName(const char *pName, char *pShort)
+{
+    uint8_t i = 0;
+    memset(pShort, ' ', 11);
+    while ('\0' != *pName && '.' != *pName && i < 8)
+        pShort[i++] = (char)toupper((unsigned char)*pName++);
+    while ('\0' != *pName && '.' != *pName)
+        pName++;
+    if ('.' == *pName)
+        pName++;
+    for (i = 8; '\0' != *pName && i < 11; i++)
+        pShort[i] = (char)toupper((unsigned char)*pName++);
+}
@@ -0,0 +1,93 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Read-only FAT32 File Access                                                                    */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Just enough FAT32 to locate files in the root directory of a
+ *         SD card and translate file offsets into card blocks.
+ *         Long file names, sub directories and writing are not supported.
+ */
+/*----------------------------------------------------------*/
+#ifndef FAT32_H_
+#define FAT32_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+typedef struct
+{
+    /** First cluster of the file, 0 if the file is not open */
+    uint32_t firstCluster;
+    /** File size in bytes */
+    uint32_t size;
+    /** Cluster index (relative to the file start) of curCluster, used to walk the chain forward only once */
+    uint32_t curIndex;
+    /** Cluster number of the cluster with index curIndex */
+    uint32_t curCluster;
+} Fat32_File_t;
+
+/**
+ * \brief Mounts the first FAT32 volume of the card, either a super floppy or the first MBR partition.
+ * \note SDCard_Init must have been called successfully before.
+ * \return true, if a FAT32 volume was found. false, otherwise.
+ */
+bool Fat32_Mount(void);
+
+/**
+ * \brief Opens a file in the root directory.
+ * \param pFile - Handle which will be filled
+ * \param pName - File name in 8.3 notation, case insensitive (e.g. "beat.wav")
+ * \return true, if the file was found. false, otherwise.
+ */
+bool Fat32_Open(Fat32_File_t *pFile, const char *pName);
+
+/**
+ * \brief Translates a file position into a card block.
+ * \note Sequential access is cheap, seeking backwards restarts the cluster walk from the file start.
+ * \param pFile - Handle returned by Fat32_Open
+ * \param offset - Byte offset in the file, must be a multiple of SDCARD_BLOCK_SIZE
+ * \param pLba - Card block holding the data at offset
+ * \return Amount of consecutive blocks starting at pLba, which belong to the file (limited to the current cluster). 0 on end of file or error.
+ */
+uint32_t Fat32_MapBlocks(Fat32_File_t *pFile, uint32_t offset, uint32_t *pLba);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FAT32_H_ */
@@ -0,0 +1,123 @@
+/*------------------------------------------------------------------------------------------------*/
+/* SD Card Block Device                                                                           */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Minimal block device interface to a SD memory card.
+ *         On the target it is implemented by sd_card_hsmci.c (HSMCI + XDMAC).
+ *         For host builds define SDCARD_FILE_BACKEND and link sd_card_file.c,
+ *         which maps the same API onto a raw image file (used by
+ *         tools/sd-card-test).
+ */
+/*----------------------------------------------------------*/
+#ifndef SD_CARD_H_
+#define SD_CARD_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/** Size of a single block in bytes, for all supported card types */
+#define SDCARD_BLOCK_SIZE       (512)
+
+/** Maximum amount of blocks, which may be requested with one call of SDCard_StartRead */
+#define SDCARD_MAX_MULTI_BLOCK  (32)
+
+/** Placement of all buffers passed to this driver. On the target they are filled by DMA and must not be cached (same as the GMAC buffers). */
+#ifdef SDCARD_FILE_BACKEND
+#define SDCARD_BUFFER
+#else
+#include "compiler.h"
+#define SDCARD_BUFFER COMPILER_SECTION(".ram_nocache") COMPILER_ALIGNED(32)
+#endif
+
+typedef enum
+{
+    /** No transfer pending, last transfer (if any) was successful */
+    SDCard_State_Idle,
+    /** Transfer is still ongoing, call SDCard_GetState again later */
+    SDCard_State_Busy,
+    /** Last transfer failed, the destination buffer content is undefined */
+    SDCard_State_Error,
+    /** There is no card or it could not be initialized */
+    SDCard_State_NoCard
+} SDCard_State_t;
+
+/**
+ * \brief Initializes the interface and identifies the inserted card.
+ * \note This function blocks for the duration of the card identification (up to one second).
+ * \return true, if a card was found and is ready to be read. false, otherwise.
+ */
+bool SDCard_Init(void);
+
+/**
+ * \brief Returns the capacity of the initialized card.
+ * \return Amount of blocks with the size of SDCARD_BLOCK_SIZE, 0 if there is no card.
+ */
+uint32_t SDCard_GetBlockCount(void);
+
+/**
+ * \brief Starts an asynchronous multi-block read.
+ * \note Only one transfer may be pending at a time. Poll SDCard_GetState until it is no longer busy.
+ * \param lba - The first block to read
+ * \param blockCount - Amount of blocks to read, 1 up to SDCARD_MAX_MULTI_BLOCK
+ * \param pBuffer - Destination, declared with SDCARD_BUFFER and able to hold blockCount * SDCARD_BLOCK_SIZE bytes
+ * \return true, if the transfer was started. false, if the driver is busy or the parameters are invalid.
+ */
+bool SDCard_StartRead(uint32_t lba, uint16_t blockCount, uint8_t *pBuffer);
+
+/**
+ * \brief Returns the state of the last transfer started by SDCard_StartRead.
+ * \return Current state, see SDCard_State_t.
+ */
+SDCard_State_t SDCard_GetState(void);
+
+/**
+ * \brief Reads blocks and waits for the end of the transfer.
+ * \note Intended for the file system layer (mounting, directory and FAT lookups), not for streaming.
+ * \param lba - The first block to read
+ * \param blockCount - Amount of blocks to read, 1 up to SDCARD_MAX_MULTI_BLOCK
+ * \param pBuffer - Destination, see SDCard_StartRead
+ * \return true, if the data was read successfully. false, otherwise.
+ */
+bool SDCard_ReadBlocks(uint32_t lba, uint16_t blockCount, uint8_t *pBuffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SD_CARD_H_ */
@@ -0,0 +1,122 @@
+/*------------------------------------------------------------------------------------------------*/
+/* SD Card Block Device, file backed stand-in for host builds                                     */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#ifdef SDCARD_FILE_BACKEND
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "sd_card.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* The image path can be overridden at runtime with the environment variable of this name */
+#define SDCARD_IMAGE_ENV        "SDCARD_IMAGE"
+#define SDCARD_IMAGE_DEFAULT    "sdcard.img"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+typedef struct
+{
+    FILE *image;
+    uint32_t blockCount;
+    SDCard_State_t state;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool SDCard_Init(void)
+{
+    const char *path = getenv(SDCARD_IMAGE_ENV);
+    long size;
+    if (NULL != m.image)
+        fclose(m.image);
+    memset(&m, 0, sizeof(m));
+    m.state = SDCard_State_NoCard;
+    if (NULL == path)
+        path = SDCARD_IMAGE_DEFAULT;
+    m.image = fopen(path, "rb");
+    if (NULL == m.image)
+        return false;
+    if (0 != fseek(m.image, 0, SEEK_END) || 0 > (size = ftell(m.image)))
+    {
+        fclose(m.image);
+        m.image = NULL;
+        return false;
+    }
+    m.blockCount = (uint32_t)(size / SDCARD_BLOCK_SIZE);
+    m.state = SDCard_State_Idle;
+    return true;
+}
+
+uint32_t SDCard_GetBlockCount(void)
+{
+    return (NULL != m.image) ? m.blockCount : 0;
+}
+
+bool SDCard_StartRead(uint32_t lba, uint16_t blockCount, uint8_t *pBuffer)
+{
+    assert(NULL != pBuffer);
+    if (NULL == m.image || SDCard_State_Busy == m.state)
+        return false;
+    if (0 == blockCount || SDCARD_MAX_MULTI_BLOCK < blockCount || m.blockCount < lba + blockCount)
+        return false;
+    /* The read completes synchronously, SDCard_GetState never reports Busy for this backend */
+    m.state = SDCard_State_Error;
+    if (0 == fseek(m.image, (long)lba * SDCARD_BLOCK_SIZE, SEEK_SET)
+        && blockCount == fread(pBuffer, SDCARD_BLOCK_SIZE, blockCount, m.image))
+    {
+        m.state = SDCard_State_Idle;
+    }
+    return true;
+}
+
+SDCard_State_t SDCard_GetState(void)
+{
+    return m.state;
+}
+
+bool SDCard_ReadBlocks(uint32_t lba, uint16_t blockCount, uint8_t *pBuffer)
+{
+    if (!SDCard_StartRead(lba, blockCount, pBuffer))
+        return false;
+    return (SDCard_State_Idle == SDCard_GetState());
+}
+
+#endif /* SDCARD_FILE_BACKEND */
@@ -0,0 +1,359 @@
+/*------------------------------------------------------------------------------------------------*/
+/* SD Card Block Device, HSMCI implementation                                                     */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#ifndef SDCARD_FILE_BACKEND
+
+#include <string.h>
+#include <assert.h>
+#include "board.h"
+#include "board_init.h"
+#include "timetick.h"
+#include "sd_card.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define SDCARD_INIT_CLOCK_HZ    (400000)
+#define SDCARD_DATA_CLOCK_HZ    (25000000)
+#define SDCARD_INIT_TIMEOUT_MS  (1000)
+#define SDCARD_CMD_TIMEOUT_MS   (10)
+#define SDCARD_XFER_TIMEOUT_MS  (250)
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define CMD_R0      (HSMCI_CMDR_RSPTYP_NORESP)
+#define CMD_R1      (HSMCI_CMDR_RSPTYP_48_BIT | HSMCI_CMDR_MAXLAT_64)
+#define CMD_R1B     (HSMCI_CMDR_RSPTYP_R1B | HSMCI_CMDR_MAXLAT_64)
+#define CMD_R2      (HSMCI_CMDR_RSPTYP_136_BIT | HSMCI_CMDR_MAXLAT_64)
+#define CMD_R3      (HSMCI_CMDR_RSPTYP_48_BIT | HSMCI_CMDR_MAXLAT_64)
+#define CMD_R6      (HSMCI_CMDR_RSPTYP_48_BIT | HSMCI_CMDR_MAXLAT_64)
+#define CMD_R7      (HSMCI_CMDR_RSPTYP_48_BIT | HSMCI_CMDR_MAXLAT_64)
+
+#define SD_CMD0_GO_IDLE             (HSMCI_CMDR_CMDNB(0) | CMD_R0 | HSMCI_CMDR_SPCMD_INIT | HSMCI_CMDR_OPDCMD_OPENDRAIN)
+#define SD_CMD2_ALL_SEND_CID        (HSMCI_CMDR_CMDNB(2) | CMD_R2 | HSMCI_CMDR_OPDCMD_OPENDRAIN)
+#define SD_CMD3_SEND_RCA            (HSMCI_CMDR_CMDNB(3) | CMD_R6 | HSMCI_CMDR_OPDCMD_OPENDRAIN)
+#define SD_CMD7_SELECT              (HSMCI_CMDR_CMDNB(7) | CMD_R1B)
+#define SD_CMD8_SEND_IF_COND        (HSMCI_CMDR_CMDNB(8) | CMD_R7 | HSMCI_CMDR_OPDCMD_OPENDRAIN)
+#define SD_CMD9_SEND_CSD            (HSMCI_CMDR_CMDNB(9) | CMD_R2)
+#define SD_CMD12_STOP               (HSMCI_CMDR_CMDNB(12) | CMD_R1B | HSMCI_CMDR_TRCMD_STOP_DATA)
+#define SD_CMD16_SET_BLOCKLEN       (HSMCI_CMDR_CMDNB(16) | CMD_R1)
+#define SD_CMD17_READ_SINGLE        (HSMCI_CMDR_CMDNB(17) | CMD_R1 | HSMCI_CMDR_TRCMD_START_DATA | HSMCI_CMDR_TRDIR_READ | HSMCI_CMDR_TRTYP_SINGLE)
+#define SD_CMD18_READ_MULTIPLE      (HSMCI_CMDR_CMDNB(18) | CMD_R1 | HSMCI_CMDR_TRCMD_START_DATA | HSMCI_CMDR_TRDIR_READ | HSMCI_CMDR_TRTYP_MULTIPLE)
+#define SD_CMD55_APP_CMD            (HSMCI_CMDR_CMDNB(55) | CMD_R1)
+#define SD_ACMD6_SET_BUS_WIDTH      (HSMCI_CMDR_CMDNB(6) | CMD_R1)
+#define SD_ACMD41_SEND_OP_COND      (HSMCI_CMDR_CMDNB(41) | CMD_R3 | HSMCI_CMDR_OPDCMD_OPENDRAIN)
+
+#define SD_IF_COND_ARG              (0x1AA)
+#define SD_OCR_BUSY                 (1u << 31)
+#define SD_OCR_CCS                  (1u << 30)
+#define SD_OCR_HCS                  (1u << 30)
+#define SD_OCR_VDD_32_33            (1u << 20)
+#define SD_OCR_VDD_33_34            (1u << 21)
+
+#define STATUS_ERRORS_RESP  (HSMCI_SR_CSTOE | HSMCI_SR_RTOE | HSMCI_SR_RENDE | HSMCI_SR_RCRCE | HSMCI_SR_RDIRE | HSMCI_SR_RINDE)
+#define STATUS_ERRORS_DATA  (HSMCI_SR_UNRE | HSMCI_SR_OVRE | HSMCI_SR_DTOE | HSMCI_SR_DCRCE)
+
+typedef struct
+{
+    bool initialized;
+    bool highCapacity;
+    uint16_t rca;
+    uint32_t blockCount;
+    uint32_t dmaChannel;
+    SDCard_State_t state;
+    uint16_t xferBlocks;
+    uint32_t xferStartTime;
+} LocalVar_t;
+
+static LocalVar_t m = { 0 };
+static const Pin sdPins[] = BOARD_SD_PINS;
+static const Pin sdCardDetect = BOARD_SD_PIN_CD;
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void SetClock(uint32_t hz);
+static bool SendCommand(uint32_t cmdr, uint32_t arg, uint32_t ignoredErrors, uint32_t *pResp);
+static bool SendAppCommand(uint32_t cmdr, uint32_t arg, uint32_t ignoredErrors, uint32_t *pResp);
+static bool IdentifyCard(void);
+static uint32_t ParseBlockCount(const uint32_t *csd);
+static bool FinishTransfer(bool success);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+bool SDCard_Init(void)
+{
+    memset(&m, 0, sizeof(m));
+    m.state = SDCard_State_NoCard;
+    PIO_Configure(sdPins, PIO_LISTSIZE(sdPins));
+    PIO_Configure(&sdCardDetect, 1);
+    if (0 != PIO_Get(&sdCardDetect))
+        return false;
+    PMC_EnablePeripheral(ID_HSMCI);
+    HSMCI_Reset(HSMCI, false);
+    HSMCI_Disable(HSMCI);
+    HSMCI_DisableIt(HSMCI, 0xFFFFFFFF);
+    HSMCI_ConfigureDataTO(HSMCI, HSMCI_DTOR_DTOCYC(0xF) | HSMCI_DTOR_DTOMUL_1048576);
+    HSMCI_ConfigureCompletionTO(HSMCI, HSMCI_CSTOR_CSTOCYC(0xF) | HSMCI_CSTOR_CSTOMUL_1048576);
+    HSMCI_Configure(HSMCI, HSMCI_CFG_FIFOMODE | HSMCI_CFG_FERRCTRL);
+    HSMCI_ConfigureMode(HSMCI, HSMCI_MR_RDPROOF | HSMCI_MR_WRPROOF);
+    SetClock(SDCARD_INIT_CLOCK_HZ);
+    HSMCI_Select(HSMCI, 0, 1);
+    HSMCI_Enable(HSMCI);
+    if (!IdentifyCard())
+    {
+        HSMCI_Disable(HSMCI);
+        return false;
+    }
+    m.dmaChannel = XDMAD_AllocateChannel(&xdma, ID_HSMCI, XDMAD_TRANSFER_MEMORY);
+    if (XDMAD_ALLOC_FAILED == m.dmaChannel)
+        return false;
+    XDMAD_PrepareChannel(&xdma, m.dmaChannel);
+    m.state = SDCard_State_Idle;
+    m.initialized = true;
+    return true;
+}
+
+uint32_t SDCard_GetBlockCount(void)
+{
+    return m.initialized ? m.blockCount : 0;
+}
+
+bool SDCard_StartRead(uint32_t lba, uint16_t blockCount, uint8_t *pBuffer)
+{
+    sXdmadCfg cfg;
+    uint32_t cmdr;
+    assert(NULL != pBuffer);
+    assert(0 == ((uint32_t)pBuffer & 0x1F));
+    if (!m.initialized || SDCard_State_Busy == m.state)
+        return false;
+    if (0 == blockCount || SDCARD_MAX_MULTI_BLOCK < blockCount || m.blockCount < lba + blockCount)
+        return false;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.mbr_ubc = blockCount * (SDCARD_BLOCK_SIZE / 4);
+    cfg.mbr_sa = (uint32_t)&HSMCI->HSMCI_RDR;
+    cfg.mbr_da = (uint32_t)pBuffer;
+    cfg.mbr_cfg = XDMAC_CC_TYPE_PER_TRAN
+        | XDMAC_CC_MBSIZE_SINGLE
+        | XDMAC_CC_DSYNC_PER2MEM
+        | XDMAC_CC_CSIZE_CHK_1
+        | XDMAC_CC_DWIDTH_WORD
+        | XDMAC_CC_SIF_AHB_IF1
+        | XDMAC_CC_DIF_AHB_IF1
+        | XDMAC_CC_SAM_FIXED_AM
+        | XDMAC_CC_DAM_INCREMENTED_AM
+        | XDMAC_CC_PERID(XDMAIF_Get_ChannelNumber(ID_HSMCI, XDMAD_TRANSFER_RX));
+    if (XDMAD_OK != XDMAD_ConfigureTransfer(&xdma, m.dmaChannel, &cfg, 0, 0, XDMAC_CIE_BIE))
+        return false;
+
+    HSMCI_ConfigureTransfer(HSMCI, SDCARD_BLOCK_SIZE, blockCount);
+    HSMCI_ConfigureDma(HSMCI, HSMCI_DMA_CHKSIZE_1 | HSMCI_DMA_DMAEN);
+    if (XDMAD_OK != XDMAD_StartTransfer(&xdma, m.dmaChannel))
+        return false;
+
+    m.xferBlocks = blockCount;
+    m.xferStartTime = GetTicks();
+    m.state = SDCard_State_Busy;
+    cmdr = (1 == blockCount) ? SD_CMD17_READ_SINGLE : SD_CMD18_READ_MULTIPLE;
+    if (!SendCommand(cmdr, m.highCapacity ? lba : lba * SDCARD_BLOCK_SIZE, 0, NULL))
+        return FinishTransfer(false);
+    return true;
+}
+
+SDCard_State_t SDCard_GetState(void)
+{
+    uint32_t status;
+    if (SDCard_State_Busy != m.state)
+        return m.state;
+    status = HSMCI_GetStatus(HSMCI);
+    if (0 != (status & STATUS_ERRORS_DATA))
+    {
+        FinishTransfer(false);
+    }
+    else if (XDMAD_OK == XDMAD_IsTransferDone(&xdma, m.dmaChannel) && 0 != (status & HSMCI_SR_XFRDONE))
+    {
+        FinishTransfer(true);
+    }
+    else if (SDCARD_XFER_TIMEOUT_MS < (GetTicks() - m.xferStartTime))
+    {
+        FinishTransfer(false);
+    }
+    return m.state;
+}
+
+bool SDCard_ReadBlocks(uint32_t lba, uint16_t blockCount, uint8_t *pBuffer)
+{
+    SDCard_State_t state;
+    if (!SDCard_StartRead(lba, blockCount, pBuffer))
+        return false;
+    do
+    {
+        state = SDCard_GetState();
+    }
+    while (SDCard_State_Busy == state);
+    return (SDCard_State_Idle == state);
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void SetClock(uint32_t hz)
+{
+    uint32_t div = (BOARD_MCK + hz - 1) / hz;
+    if (2 > div)
+        div = 2;
+    HSMCI_DivCtrl(HSMCI, div, 7);
+}
+
+static bool SendCommand(uint32_t cmdr, uint32_t arg, uint32_t ignoredErrors, uint32_t *pResp)
+{
+    uint32_t status;
+    uint32_t start = GetTicks();
+    HSMCI_SendCmd(HSMCI, cmdr, arg);
+    do
+    {
+        status = HSMCI_GetStatus(HSMCI);
+        if (SDCARD_CMD_TIMEOUT_MS < (GetTicks() - start))
+            return false;
+    }
+    while (0 == (status & HSMCI_SR_CMDRDY));
+    if (0 != (status & STATUS_ERRORS_RESP & ~ignoredErrors))
+        return false;
+    if (HSMCI_CMDR_RSPTYP_R1B == (cmdr & HSMCI_CMDR_RSPTYP_Msk))
+    {
+        while (0 == (HSMCI_GetStatus(HSMCI) & HSMCI_SR_NOTBUSY))
+        {
+            if (SDCARD_CMD_TIMEOUT_MS < (GetTicks() - start))
+                return false;
+        }
+    }
+    if (NULL != pResp)
+    {
+        uint8_t i;
+        uint8_t words = (HSMCI_CMDR_RSPTYP_136_BIT == (cmdr & HSMCI_CMDR_RSPTYP_Msk)) ? 4 : 1;
+        for (i = 0; i < words; i++)
+            pResp[i] = HSMCI_GetResponse(HSMCI);
+    }
+    return true;
+}
+
+static bool SendAppCommand(uint32_t cmdr, uint32_t arg, uint32_t ignoredErrors, uint32_t *pResp)
+{
+    if (!SendCommand(SD_CMD55_APP_CMD, (uint32_t)m.rca << 16, 0, NULL))
+        return false;
+    return SendCommand(cmdr, arg, ignoredErrors, pResp);
+}
+
+static bool IdentifyCard(void)
+{
+    uint32_t resp[4];
+    uint32_t ocrArg = SD_OCR_VDD_32_33 | SD_OCR_VDD_33_34;
+    uint32_t start;
+    if (!SendCommand(SD_CMD0_GO_IDLE, 0, 0, NULL))
+        return false;
+    /* Cards before physical layer V2.00 do not answer CMD8, they do not support block addressing */
+    if (SendCommand(SD_CMD8_SEND_IF_COND, SD_IF_COND_ARG, 0, resp))
+    {
+        if ((SD_IF_COND_ARG & 0xFFF) != (resp[0] & 0xFFF))
+            return false;
+        ocrArg |= SD_OCR_HCS;
+    }
+    start = GetTicks();
+    do
+    {
+        /* R3 carries no CRC */
+        if (!SendAppCommand(SD_ACMD41_SEND_OP_COND, ocrArg, HSMCI_SR_RCRCE, resp))
+            return false;
+        if (SDCARD_INIT_TIMEOUT_MS < (GetTicks() - start))
+            return false;
+    }
+    while (0 == (resp[0] & SD_OCR_BUSY));
+    m.highCapacity = (0 != (resp[0] & SD_OCR_CCS));
+    if (!SendCommand(SD_CMD2_ALL_SEND_CID, 0, HSMCI_SR_RCRCE, resp))
+        return false;
+    if (!SendCommand(SD_CMD3_SEND_RCA, 0, 0, resp))
+        return false;
+    m.rca = (uint16_t)(resp[0] >> 16);
+    if (!SendCommand(SD_CMD9_SEND_CSD, (uint32_t)m.rca << 16, HSMCI_SR_RCRCE, resp))
+        return false;
+    m.blockCount = ParseBlockCount(resp);
+    if (0 == m.blockCount)
+        return false;
+    if (!SendCommand(SD_CMD7_SELECT, (uint32_t)m.rca << 16, 0, NULL))
+        return false;
+    if (!SendAppCommand(SD_ACMD6_SET_BUS_WIDTH, 2, 0, NULL))
+        return false;
+    HSMCI_Select(HSMCI, 0, 4);
+    if (!SendCommand(SD_CMD16_SET_BLOCKLEN, SDCARD_BLOCK_SIZE, 0, NULL))
+        return false;
+    SetClock(SDCARD_DATA_CLOCK_HZ);
+    return true;
+}
+
+static uint32_t ParseBlockCount(const uint32_t *csd)
+{
+    /* csd[0] holds bits 127..96 of the register, csd[3] bits 31..0 */
+    uint32_t cSize;
+    if (1 == (csd[0] >> 30))
+    {
+        /* CSD V2.0 (SDHC/SDXC): capacity = (C_SIZE + 1) * 512 KByte */
+        cSize = ((csd[1] & 0x3F) << 16) | (csd[2] >> 16);
+        return (cSize + 1) * 1024;
+    }
+    else
+    {
+        /* CSD V1.0 (SDSC): capacity = (C_SIZE + 1) * 2^(C_SIZE_MULT + 2) * 2^READ_BL_LEN */
+        uint32_t readBlLen = (csd[1] >> 16) & 0xF;
+        uint32_t cSizeMult = (csd[2] >> 15) & 0x7;
+        cSize = ((csd[1] & 0x3FF) << 2) | (csd[2] >> 30);
+        return ((cSize + 1) << (cSizeMult + 2 + readBlLen)) / SDCARD_BLOCK_SIZE;
+    }
+}
+
+static bool FinishTransfer(bool success)
+{
+    XDMAD_StopTransfer(&xdma, m.dmaChannel);
+    HSMCI_EnableDma(HSMCI, false);
+    if (1 < m.xferBlocks && !SendCommand(SD_CMD12_STOP, 0, 0, NULL))
+        success = false;
+    m.xferBlocks = 0;
+    m.state = success ? SDCard_State_Idle : SDCard_State_Error;
+    return success;
+}
+
+#endif /* SDCARD_FILE_BACKEND */
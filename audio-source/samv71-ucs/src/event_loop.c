@@ -0,0 +1,150 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Event Loop Implementation                                                                      */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "board.h"
+#include "timetick.h"
+#include "utility.h"
+#include "event_loop.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define LOAD_WINDOW_MS          (1000)
+
+typedef struct
+{
+    volatile uint32_t pending;
+    volatile uint32_t postCycles;
+    uint32_t lastTick;
+    uint32_t windowStartTick;
+    uint32_t windowStartCycles;
+    uint32_t sleepCycles;
+    EventLoop_Stats_t stats;
+} LocalVar_t;
+
+static LocalVar_t m;
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void UpdateLoad(uint32_t now);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void EventLoop_Init(void)
+{
+    memset(&m, 0, sizeof(m));
+    RESET_CYCLE_COUNTER();
+    m.lastTick = GetTicks();
+    m.windowStartTick = m.lastTick;
+}
+
+void EventLoop_Post(uint32_t events)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    /* Latency is measured from the oldest event not yet picked up */
+    if (0 == m.pending)
+        m.postCycles = DWT->CYCCNT;
+    m.pending |= events;
+    if (0 == primask)
+        __enable_irq();
+}
+
+uint32_t EventLoop_Wait(void)
+{
+    __disable_irq();
+    while (0 == m.pending && GetTicks() == m.lastTick)
+    {
+        uint32_t start = DWT->CYCCNT;
+        /* With interrupts masked, WFI still wakes on a pending interrupt, but the handler runs only after enabling them again */
+        __DSB();
+        __WFI();
+        m.sleepCycles += DWT->CYCCNT - start;
+        m.stats.wakeups++;
+        __enable_irq();
+        __ISB();
+        __disable_irq();
+    }
+    __enable_irq();
+    return EventLoop_Poll();
+}
+
+uint32_t EventLoop_Poll(void)
+{
+    uint32_t events;
+    uint32_t now;
+    __disable_irq();
+    now = DWT->CYCCNT;
+    events = m.pending;
+    m.pending = 0;
+    if (0 != events && now - m.postCycles > m.stats.maxLatencyCycles)
+        m.stats.maxLatencyCycles = now - m.postCycles;
+    __enable_irq();
+    if (GetTicks() != m.lastTick)
+    {
+        m.lastTick = GetTicks();
+        events |= EVENT_TICK;
+        UpdateLoad(now);
+    }
+    return events;
+}
+
+const EventLoop_Stats_t *EventLoop_GetStats(void)
+{
+    return &m.stats;
+}
+
+void EventLoop_ResetLatency(void)
+{
+    m.stats.maxLatencyCycles = 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void UpdateLoad(uint32_t now)
+{
+    uint32_t total;
+    if (m.lastTick - m.windowStartTick < LOAD_WINDOW_MS)
+        return;
+    total = now - m.windowStartCycles;
+    if (0 != total && m.sleepCycles <= total)
+        m.stats.loadPermille = (uint16_t)(1000 - (uint32_t)(((uint64_t)m.sleepCycles * 1000) / total));
+    m.windowStartTick = m.lastTick;
+    m.windowStartCycles = now;
+    m.sleepCycles = 0;
+}
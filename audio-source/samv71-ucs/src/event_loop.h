@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Event Loop                                                                                     */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Event flags for the main loop. Interrupt handlers and
+ *         callbacks post events, the main loop sleeps with WFI while
+ *         no event is pending. A tick event is generated every
+ *         millisecond, so polled work is never delayed longer.
+ *         The time spent sleeping and the latency between posting
+ *         an event and the loop picking it up are measured with the
+ *         DWT cycle counter.
+ */
+/*----------------------------------------------------------*/
+#ifndef EVENT_LOOP_H_
+#define EVENT_LOOP_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/** DIM2 AHB or MLB interrupt, buffers were completed */
+#define EVENT_MLB           (1u << 0)
+/** GMAC interrupt, frames were received or sent */
+#define EVENT_GMAC          (1u << 1)
+/** SysTick advanced, timeouts may have expired */
+#define EVENT_TICK          (1u << 2)
+/** Console has data to send */
+#define EVENT_CONSOLE       (1u << 3)
+/** UNICENS requested a service call */
+#define EVENT_UNICENS       (1u << 4)
+
+typedef struct
+{
+    uint32_t wakeups;               /**< Times the loop returned from WFI */
+    uint32_t maxLatencyCycles;      /**< Worst case from posting an event until EventLoop_Wait returned it */
+    uint16_t loadPermille;          /**< CPU time not spent in WFI during the last full second */
+} EventLoop_Stats_t;
+
+/**
+ * \brief Clears all events and starts the DWT cycle counter.
+ */
+void EventLoop_Init(void);
+
+/**
+ * \brief Marks events as pending. May be called from interrupt context.
+ * \param events - Bit mask of EVENT_ values
+ */
+void EventLoop_Post(uint32_t events);
+
+/**
+ * \brief Sleeps until at least one event is pending.
+ * \return The pending events, they are cleared.
+ */
+uint32_t EventLoop_Wait(void);
+
+/**
+ * \brief Takes the pending events without sleeping.
+ * \return The pending events or 0, they are cleared.
+ */
+uint32_t EventLoop_Poll(void);
+
+/**
+ * \brief Returns the measurements of the event loop.
+ * \return Pointer to the statistics.
+ */
+const EventLoop_Stats_t *EventLoop_GetStats(void);
+
+/**
+ * \brief Resets the worst case latency measurement.
+ */
+void EventLoop_ResetLatency(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_LOOP_H_ */
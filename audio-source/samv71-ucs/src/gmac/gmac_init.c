@@ -1,5 +1,7 @@
 #include <assert.h>
 #include "gmac_init.h"
+#include "event_loop.h"
+#include "profile.h"
 #include <string.h>
 
 /** Enable/Disable CopyAllFrame */
@@ -17,10 +19,6 @@
 #define DUMMY_BUFFERS           4     /** Must be a power of 2 */
 #define DUMMY_BUFF_SIZE         128    /** Must be a power of 2 */
 
-#define AVB_RX_BUFFERS          8
-#define AVB_TX_BUFFERS          8
-#define AVB_BUFF_SIZE           1280
-
 #define ETH_RX_BUFFERS          8
 #define ETH_TX_BUFFERS          8
 
@@ -137,7 +135,8 @@ void init_gmac(sGmacd  *pGmacd)
   GMAC_EnableIt(GMAC, (GMAC_IER_PDRQFT | GMAC_IER_PDRSFT), PTP_QUEUE );
 
   /* QUE must match screener register configuration! */
-  GMACD_SetRxCallback(pGmacd, PtpDataReceived, GMAC_QUE_1);
+  /* GMAC_QUE_1 (AVB) is consumed by the AVB bridge */
+  GMACD_SetRxCallback(pGmacd, PtpDataReceived, GMAC_QUE_2);
   GMACD_RxPtpEvtMsgCBRegister(pGmacd, gmac_RxPtpEvtMsgIsrCB, PTP_QUEUE);
   GMACD_TxPtpEvtMsgCBRegister(pGmacd, gmac_TxPtpEvtMsgIsrCB, PTP_QUEUE);
 
@@ -179,20 +178,29 @@ void init_gmac(sGmacd  *pGmacd)
  */
 void GMAC_Handler(void)
 {
+    PROFILE_BEGIN(PROF_GMAC_ISR);
     assert(NULL != spGmacd);
     GMACD_Handler(spGmacd, GMAC_QUE_0);
+    EventLoop_Post(EVENT_GMAC);
+    PROFILE_END(PROF_GMAC_ISR);
 }
 
 void GMACQ1_Handler (void)
 {
+    PROFILE_BEGIN(PROF_GMAC_Q1_ISR);
     assert(NULL != spGmacd);
     GMACD_Handler(spGmacd, GMAC_QUE_1);
+    EventLoop_Post(EVENT_GMAC);
+    PROFILE_END(PROF_GMAC_Q1_ISR);
 }
 
 void GMACQ2_Handler (void)
 {
+    PROFILE_BEGIN(PROF_GMAC_Q2_ISR);
     assert(NULL != spGmacd);
     GMACD_Handler(spGmacd, GMAC_QUE_2);
+    EventLoop_Post(EVENT_GMAC);
+    PROFILE_END(PROF_GMAC_Q2_ISR);
 }
 
 void GMACQ3_Handler(void)
@@ -225,7 +233,7 @@ static void PtpDataReceived(uint32_t status, void *pTag)
   TRACE_INFO("%u ETH_RXCB(%u)\n\r", (unsigned int)GetTicks(), (unsigned int)status);
   assert(NULL != spGmacd);
 
-  while(GMACD_OK == GMACD_GetRxDIdx(spGmacd, &buffIdx, &frmSize, PTP_QUEUE)) {
+  while(GMACD_OK == GMACD_GetRxDIdx(spGmacd, &buffIdx, &frmSize, GMAC_QUE_2)) {
 
     msgPtr = (uint8_t *)&gRxPtpBuffer[buffIdx * PTP_RX_BUFF_SIZE];
 
@@ -251,7 +259,7 @@ static void PtpDataReceived(uint32_t status, void *pTag)
       break;
     }; /* switch (ptpMsg) */
 
-    GMACD_FreeRxDTail(spGmacd, PTP_QUEUE);
+    GMACD_FreeRxDTail(spGmacd, GMAC_QUE_2);
 
   } /* while () */
 }
@@ -11,6 +11,13 @@
 extern "C" {
 #endif
     
+#define AVB_RX_BUFFERS          8
+#define AVB_TX_BUFFERS          8
+#define AVB_BUFF_SIZE           1280
+
+/** Receive buffers of the AVB queue (GMAC_QUE_1), indexed by GMACD_GetRxDIdx */
+extern uint8_t gRxAvbBuffer[AVB_RX_BUFFERS * AVB_BUFF_SIZE];
+
 void init_gmac(sGmacd  *pGmacd);
 
 #ifdef __cplusplus
@@ -48,6 +48,29 @@
 /** Default max retry count */
 #define GACB_RETRY_MAX            1000000u
 
+/** Hard reset low time, KSZ8081 needs at least 500us */
+#define GMACB_HW_RESET_MS          2u
+/** Delay after hard reset before MDIO access, KSZ8081 needs at least 100us */
+#define GMACB_HW_RESET_RELEASE_MS  1u
+/** Time for the soft reset to complete */
+#define GMACB_SOFT_RESET_MS        100u
+/** Interval of the link status poll */
+#define GMACB_LINK_POLL_MS         100u
+/** Delay before the bring-up is restarted after an error */
+#define GMACB_RESTART_MS           1000u
+
+/** States of the asynchronous PHY bring-up */
+enum {
+  GMACB_PHY_IDLE = 0,
+  GMACB_PHY_HW_RESET,
+  GMACB_PHY_HW_RESET_RELEASE,
+  GMACB_PHY_PROBE,
+  GMACB_PHY_SOFT_RESET,
+  GMACB_PHY_CONFIGURE,
+  GMACB_PHY_LINK_POLL,
+  GMACB_PHY_ERROR
+};
+
 /*---------------------------------------------------------------------------
  *         Local functions
  *---------------------------------------------------------------------------*/
@@ -370,6 +393,173 @@ SetSpeedExit:
   return rc;
 }
 
+/**
+ * \brief Start the asynchronous PHY bring-up, the non-blocking alternative to
+ * GMACB_InitPhy() followed by GMACB_PhySetSpeed100(). The steps are done by
+ * GMACB_PhyService(), link changes are reported by the callback.
+ * \param pMacb Pointer to the MACB instance, GMACB_Init() must be called before
+ * \param mck         Main clock setting to initialize clock
+ * \param pResetPins  Pointer to list of PIOs to configure before HW RESET
+ * \param nbResetPins Number of PIO items that should be configured
+ * \param pGmacPins   Pointer to list of PIOs for the GMAC interface
+ * \param nbGmacPins  Number of PIO items that should be configured
+ * \param fLinkCb     Called from GMACB_PhyService() on every link change, may be NULL
+ */
+void GMACB_StartPhy(GMacb *pMacb,
+        uint32_t mck,
+        const Pin *pResetPins,
+        uint32_t nbResetPins,
+        const Pin *pGmacPins,
+        uint32_t nbGmacPins,
+        fGmacbLinkCallback fLinkCb)
+{
+  pMacb->mck = mck;
+  pMacb->pResetPins = pResetPins;
+  pMacb->nbResetPins = nbResetPins;
+  pMacb->pGmacPins = pGmacPins;
+  pMacb->nbGmacPins = nbGmacPins;
+  pMacb->fLinkCb = fLinkCb;
+  pMacb->linkUp = 0;
+  pMacb->phyState = GMACB_PHY_HW_RESET;
+  pMacb->phyTimeout = GetTicks();
+}
+
+/**
+ * \brief Do the next step of the PHY bring-up started by GMACB_StartPhy() and
+ * poll the link status afterwards. Never waits, call it from the main loop
+ * at least once per millisecond tick.
+ * \param pMacb Pointer to the MACB instance
+ */
+void GMACB_PhyService(GMacb *pMacb)
+{
+  Gmac *pHw = pMacb->pGmacd->pHw;
+  uint32_t now = GetTicks();
+  uint32_t value;
+  uint8_t phy;
+  uint8_t linkUp;
+
+  if ((GMACB_PHY_IDLE == pMacb->phyState) || (now < pMacb->phyTimeout)) {
+    return;
+  }
+
+  switch (pMacb->phyState) {
+  case GMACB_PHY_HW_RESET:
+    if (pMacb->pResetPins) {
+      PIO_Configure(pMacb->pResetPins, pMacb->nbResetPins);
+      TRACE_INFO("Hard Reset of GMACD Phy\n\r");
+      PIO_Clear(pMacb->pResetPins);
+    }
+    pMacb->phyState = GMACB_PHY_HW_RESET_RELEASE;
+    pMacb->phyTimeout = now + GMACB_HW_RESET_MS;
+    break;
+
+  case GMACB_PHY_HW_RESET_RELEASE:
+    if (pMacb->pResetPins) {
+      PIO_Set(pMacb->pResetPins);
+    }
+    pMacb->phyState = GMACB_PHY_PROBE;
+    pMacb->phyTimeout = now + GMACB_HW_RESET_RELEASE_MS;
+    break;
+
+  case GMACB_PHY_PROBE:
+    PIO_Configure(pMacb->pGmacPins, pMacb->nbGmacPins);
+    if (!GMAC_SetMdcClock(pHw, pMacb->mck)) {
+      TRACE_ERROR("No Valid MDC clock\n\r");
+      pMacb->phyState = GMACB_PHY_ERROR;
+      break;
+    }
+    phy = GMACB_FindValidPhy(pMacb);
+    if (phy == 0xFF) {
+      TRACE_ERROR("PHY Access fail\n\r");
+      pMacb->phyState = GMACB_PHY_ERROR;
+      break;
+    }
+    if (phy == pMacb->phyAddress) {
+      pMacb->phyState = GMACB_PHY_CONFIGURE;
+      break;
+    }
+    /* Strap address differs, reset the PHY found at the other address */
+    pMacb->phyAddress = phy;
+    GMAC_EnableMdio(pHw);
+    GMACB_WritePhy(pHw, phy, GMII_BMCR, GMII_RESET, pMacb->retryMax);
+    GMAC_DisableMdio(pHw);
+    pMacb->phyState = GMACB_PHY_SOFT_RESET;
+    pMacb->phyTimeout = now + GMACB_SOFT_RESET_MS;
+    break;
+
+  case GMACB_PHY_SOFT_RESET:
+    GMAC_EnableMdio(pHw);
+    value = GMII_RESET;
+    GMACB_ReadPhy(pHw, pMacb->phyAddress, GMII_BMCR, &value, pMacb->retryMax);
+    GMAC_DisableMdio(pHw);
+    if (value & GMII_RESET) {
+      TRACE_ERROR("PHY Reset Timeout\n\r");
+    }
+    pMacb->phyState = GMACB_PHY_CONFIGURE;
+    break;
+
+  case GMACB_PHY_CONFIGURE:
+    GMAC_EnableMdio(pHw);
+    if (!GMACB_ReadPhy(pHw, pMacb->phyAddress, GMII_BMCR, &value, pMacb->retryMax)) {
+      GMAC_DisableMdio(pHw);
+      pMacb->phyState = GMACB_PHY_ERROR;
+      break;
+    }
+    value |= GMII_DUPLEX_MODE;
+    value &= ~(GMII_LOOPBACK | GMII_AUTONEG | GMII_POWER_DOWN);
+    if (!GMACB_WritePhy(pHw, pMacb->phyAddress, GMII_BMCR, value, pMacb->retryMax)) {
+      GMAC_DisableMdio(pHw);
+      pMacb->phyState = GMACB_PHY_ERROR;
+      break;
+    }
+    GMAC_EnableRGMII(pHw, GMAC_DUPLEX_FULL, GMAC_SPEED_100M);
+    GMAC_DisableMdio(pHw);
+    pMacb->phyState = GMACB_PHY_LINK_POLL;
+    break;
+
+  case GMACB_PHY_LINK_POLL:
+    GMAC_EnableMdio(pHw);
+    /* The link status bit latches low, so a short drop is seen on the next poll */
+    if (!GMACB_ReadPhy(pHw, pMacb->phyAddress, GMII_BMSR, &value, pMacb->retryMax)) {
+      value = 0;
+    }
+    GMAC_DisableMdio(pHw);
+    linkUp = (value & GMII_LINK_STATUS) ? 1u : 0;
+    if (linkUp != pMacb->linkUp) {
+      pMacb->linkUp = linkUp;
+      TRACE_INFO("PHY link %s\n\r", linkUp ? "up" : "down");
+      if (pMacb->fLinkCb) {
+        pMacb->fLinkCb(pMacb, linkUp);
+      }
+    }
+    pMacb->phyTimeout = now + GMACB_LINK_POLL_MS;
+    break;
+
+  case GMACB_PHY_ERROR:
+  default:
+    TRACE_ERROR("PHY bring-up failed, restarting\n\r");
+    if (pMacb->linkUp) {
+      pMacb->linkUp = 0;
+      if (pMacb->fLinkCb) {
+        pMacb->fLinkCb(pMacb, 0);
+      }
+    }
+    pMacb->phyState = GMACB_PHY_HW_RESET;
+    pMacb->phyTimeout = now + GMACB_RESTART_MS;
+    break;
+  }
+}
+
+/**
+ * \brief Returns the link status found by the last poll of GMACB_PhyService().
+ * \param pMacb Pointer to the MACB instance
+ * \return 1 if the link is up, 0 otherwise.
+ */
+uint8_t GMACB_IsLinkUp(GMacb *pMacb)
+{
+  return pMacb->linkUp;
+}
+
 #if 0
 /**
  * \brief Issue a Auto Negotiation of the PHY
@@ -41,6 +41,9 @@
  *     automatically adjusted by attempt to read.
  *  -# Perform PHY auto negotiate through GMACB_AutoNegotiate(), so
  *     connection established.
+ *  -# Alternatively start the bring-up with GMACB_StartPhy() and call
+ *     GMACB_PhyService() from the main loop, it never waits and reports
+ *     link changes by callback.
  *
  *
  *  Related files:\n
@@ -78,6 +81,11 @@ extern "C" {
  *---------------------------------------------------------------------------*/
 
 
+struct _GMacb;
+
+/** Link change callback of the asynchronous bring-up, linkUp is 1 or 0 */
+typedef void (*fGmacbLinkCallback)(struct _GMacb *pMacb, uint8_t linkUp);
+
 /** The DM9161 instance */
 typedef struct _GMacb {
 	/**< Driver */
@@ -86,6 +94,19 @@ typedef struct _GMacb {
 	uint32_t retryMax;
 	/** PHY address (pre-defined by pins on reset) */
 	uint8_t phyAddress;
+	/** State of the asynchronous bring-up, see GMACB_PhyService() */
+	uint8_t phyState;
+	/** Link status of the last poll */
+	uint8_t linkUp;
+	/** Tick of the next step */
+	uint32_t phyTimeout;
+	/** Settings given to GMACB_StartPhy() */
+	uint32_t mck;
+	const Pin *pResetPins;
+	uint32_t nbResetPins;
+	const Pin *pGmacPins;
+	uint32_t nbGmacPins;
+	fGmacbLinkCallback fLinkCb;
 } GMacb;
 
 /*---------------------------------------------------------------------------
@@ -105,6 +126,19 @@ extern uint8_t GMACB_InitPhy(
 
 extern uint8_t GMACB_PhySetSpeed100(GMacb* pMacb, uint8_t waitForLink);
 
+extern void GMACB_StartPhy(
+	GMacb *pMacb,
+	uint32_t mck,
+	const Pin *pResetPins,
+	uint32_t nbResetPins,
+	const Pin *pGmacPins,
+	uint32_t nbGmacPins,
+	fGmacbLinkCallback fLinkCb);
+
+extern void GMACB_PhyService(GMacb *pMacb);
+
+extern uint8_t GMACB_IsLinkUp(GMacb *pMacb);
+
 //extern uint8_t GMACB_AutoNegotiate(GMacb *pMacb);
 
 //extern uint8_t GMACB_GetLinkSpeed(GMacb *pMacb, uint8_t applySettings);
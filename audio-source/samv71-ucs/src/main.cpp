@@ -36,6 +36,10 @@
 #include "Console.h"
 #include "task-unicens.h"
 #include "task-audio.h"
+#include "event_loop.h"
+#include "task_sched.h"
+#include "profile.h"
+#include "boot_timeline.h"
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                          USER ADJUSTABLE                             */
@@ -43,6 +47,22 @@
 
 /* UNICENS daemon version number */
 #define UNICENSD_VERSION    ("V4.3.0")
+/* Interval of the CPU load and profiling report, printed with PRIO_MEDIUM */
+#define LOAD_REPORT_MS      (10000)
+
+/* Scheduling of the main loop tasks, 0 is the highest priority.
+ * Deadline is the allowed delay between event and run, budget the allowed duration of one run. */
+#define AUDIO_PRIO          (0)
+#define AUDIO_DEADLINE_US   (1000)
+#define AUDIO_BUDGET_US     (300)
+#define UNICENS_PRIO        (1)
+#define UNICENS_DEADLINE_US (5000)
+#define UNICENS_BUDGET_US   (1000)
+#define CONSOLE_PRIO        (2)
+#define CONSOLE_DEADLINE_US (20000)
+#define CONSOLE_BUDGET_US   (500)
+#define ETHERNET_PRIO       (3)
+#define HOUSEKEEP_PRIO      (4)
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                      DEFINES AND LOCAL VARIABLES                     */
@@ -51,8 +71,11 @@
 typedef struct
 {
     uint32_t lastToggle;
-    bool consoleTrigger;
-    bool gmacSendInProgress;
+    uint32_t lastLoadReport;
+    /** Set from main context, cleared by the GMAC TX complete interrupt */
+    volatile bool gmacSendInProgress;
+    /** Console output is waiting for the current send to complete */
+    volatile bool consolePending;
 } LocalVar_t;
 
 static LocalVar_t m;
@@ -62,6 +85,8 @@ static LocalVar_t m;
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
 static void GmacTransferCallback(uint32_t status, void *pTag);
+static void Housekeeping(void);
+static void ReportLoad(uint32_t now);
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                         PUBLIC FUNCTIONS                             */
@@ -70,31 +95,76 @@ static void GmacTransferCallback(uint32_t status, void *pTag);
 int main()
 {
     Board_Init();
+    BootTimeline_Mark(BOOT_BOARD_INIT);
     memset(&m, 0, sizeof(LocalVar_t));
+    EventLoop_Init();
     ConsoleInit();
+    BootTimeline_Mark(BOOT_CONSOLE_INIT);
     ConsoleSetPrio(PRIO_HIGH);
     ConsolePrintf(PRIO_HIGH, BLUE "------|V71 UNICENS sample start %s (BUILD %s %s)|------" RESETCOLOR "\r\n", UNICENSD_VERSION, __DATE__, __TIME__);
     if (!TaskUnicens_Init())
         ConsolePrintf(PRIO_ERROR, RED "Init of Task UNICENS Init Failed" RESETCOLOR "\r\n");
+    /* The PHY comes up in the background, while MLB is locking */
+    Board_InitEthernet();
+    BootTimeline_Mark(BOOT_ETHERNET_INIT);
     if (!TaskAudio_Init())
         ConsolePrintf(PRIO_ERROR, RED "Init of Task Audio Failed" RESETCOLOR "\r\n");
+    TaskSched_Init();
+    TaskSched_Add("audio", TaskAudio_Service, EVENT_MLB | EVENT_GMAC | EVENT_TICK, AUDIO_PRIO, AUDIO_DEADLINE_US, AUDIO_BUDGET_US);
+    TaskSched_Add("unicens", TaskUnicens_Service, EVENT_MLB | EVENT_UNICENS | EVENT_TICK, UNICENS_PRIO, UNICENS_DEADLINE_US, UNICENS_BUDGET_US);
+    TaskSched_Add("console", ConsoleService, EVENT_CONSOLE, CONSOLE_PRIO, CONSOLE_DEADLINE_US, CONSOLE_BUDGET_US);
+    TaskSched_Add("ethernet", Board_EthernetService, EVENT_TICK, ETHERNET_PRIO, 0, 0);
+    TaskSched_Add("housekeep", Housekeeping, EVENT_TICK, HOUSEKEEP_PRIO, 0, 0);
     while (1)
+        TaskSched_Service();
+    return 0;
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void Housekeeping(void)
+{
+    uint32_t now = GetTicks();
+    if (now - m.lastToggle >= 333)
     {
-        uint32_t now = GetTicks();
-        TaskUnicens_Service();
-        TaskAudio_Service();
-        if (m.consoleTrigger)
-        {
-            m.consoleTrigger = false;
-            ConsoleService();
-        }
-        if (now - m.lastToggle >= 333)
-        {
-            m.lastToggle = now;
-            LED_Toggle(0);
-        }
+        m.lastToggle = now;
+        LED_Toggle(0);
     }
-    return 0;
+    ReportLoad(now);
+    BootTimeline_Service();
+}
+
+static void ReportLoad(uint32_t now)
+{
+    const EventLoop_Stats_t *pStats;
+    uint32_t cyclesPerUs = SystemCoreClock / 1000000;
+    uint32_t windowMs;
+    int8_t i;
+    if (now - m.lastLoadReport < LOAD_REPORT_MS)
+        return;
+    windowMs = now - m.lastLoadReport;
+    m.lastLoadReport = now;
+    pStats = EventLoop_GetStats();
+    ConsolePrintf(PRIO_MEDIUM, "CPU load %u.%u%%, worst event latency %luus\r\n", pStats->loadPermille / 10,
+        pStats->loadPermille % 10, pStats->maxLatencyCycles / cyclesPerUs);
+    EventLoop_ResetLatency();
+    for (i = 0; i < TaskSched_GetTaskCount(); i++)
+    {
+        const TaskSched_Stats_t *pTask = TaskSched_GetStats(i);
+        uint32_t share = (uint32_t)(pTask->totalCycles / ((uint64_t)windowMs * cyclesPerUs)); /* permille */
+        ConsolePrintf(PRIO_MEDIUM, "  %-10s runs=%lu max=%luus latency=%luus cpu=%lu.%lu%%\r\n", TaskSched_GetName(i),
+            pTask->runs, pTask->maxCycles / cyclesPerUs, pTask->maxLatencyCycles / cyclesPerUs, share / 10, share % 10);
+        if (0 != pTask->overruns || 0 != pTask->deadlineMisses)
+            ConsolePrintf(PRIO_HIGH, YELLOW "Task %s exceeded budget %lu times, missed deadline %lu times" RESETCOLOR "\r\n",
+                TaskSched_GetName(i), pTask->overruns, pTask->deadlineMisses);
+    }
+    TaskSched_ResetStats();
+    Profile_Print(PRIO_MEDIUM);
+    Profile_Reset();
+    TaskUnicens_PrintQueueStats();
+    TaskUnicens_PrintRecoveryStats();
 }
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
@@ -105,20 +175,40 @@ void TaskUnicens_CB_OnRouteResult(uint16_t routeId, bool isActive, uint16_t conn
 {
 }
 
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                  CALLBACK FUNCTION FROM BOARD                        */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void Board_CB_OnEthernetLink(bool isUp)
+{
+    ConsolePrintf(PRIO_HIGH, YELLOW "Ethernet link %s" RESETCOLOR "\r\n", isUp ? "up" : "down");
+    if (!isUp)
+        return;
+    BootTimeline_Mark(BOOT_ETHERNET_LINK);
+    /* Flush what was printed while the link was down */
+    EventLoop_Post(EVENT_CONSOLE);
+}
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                 CALLBACK FUNCTIONS FROM CONSOLE                      */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
 void ConsoleCB_OnServiceNeeded(void)
 {
-    m.consoleTrigger = true;
+    /* Without link the output stays buffered, Board_CB_OnEthernetLink flushes it */
+    if (!Board_IsEthernetLinkUp())
+        return;
+    /* While a datagram is in flight GmacTransferCallback posts the event, posting it here would spin the console task */
+    m.consolePending = true;
+    if (!m.gmacSendInProgress)
+        EventLoop_Post(EVENT_CONSOLE);
 }
 
 bool ConsoleCB_SendDatagram( uint8_t *pEthHeader, uint32_t ethLen, uint8_t *pPayload, uint32_t payloadLen )
 {
     sGmacSGList sgl;
     sGmacSG sg[2];
-    if (m.gmacSendInProgress)
+    if (m.gmacSendInProgress || !Board_IsEthernetLinkUp())
         return false;
     sg[0].pBuffer = pEthHeader;
     sg[0].size = ethLen;
@@ -126,9 +216,14 @@ bool ConsoleCB_SendDatagram( uint8_t *pEthHeader, uint32_t ethLen, uint8_t *pPay
     sg[1].size = payloadLen;
     sgl.sg = sg;
     sgl.len = 2;
+    /* Set before the send, the TX complete interrupt may fire before GMACD_SendSG returns */
+    m.gmacSendInProgress = true;
+    m.consolePending = false;
     if (GMACD_OK != GMACD_SendSG(&gGmacd, &sgl, GmacTransferCallback, NULL, GMAC_QUE_0))
+    {
+        m.gmacSendInProgress = false;
         return false;
-    m.gmacSendInProgress = true;
+    }
     return true;
 }
 
@@ -139,4 +234,9 @@ bool ConsoleCB_SendDatagram( uint8_t *pEthHeader, uint32_t ethLen, uint8_t *pPay
 static void GmacTransferCallback(uint32_t status, void *pTag)
 {
     m.gmacSendInProgress = false;
+    if (m.consolePending)
+    {
+        m.consolePending = false;
+        EventLoop_Post(EVENT_CONSOLE);
+    }
 }
\ No newline at end of file
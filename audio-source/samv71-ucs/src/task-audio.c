@@ -31,19 +31,82 @@
 #include <string.h>
 #include <assert.h>
 #include "Console.h"
+#include "board_init.h"
 #include "dim2_lld.h"
+#include "sd_stream.h"
+#include "avb_bridge.h"
+#include "sample_conv.h"
+#include "audio_sched.h"
+#include "rtp_tap.h"
+#include "codec_bridge.h"
+#include "profile.h"
+#include "boot_timeline.h"
 #include "task-audio.h"
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
-/*                      DEFINES AND LOCAL VARIABLES                     */
+/*                          USER ADJUSTABLE                             */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
 /* #define ENABLE_AUDIO_RX */
 
+/* If this file exists on the SD card, it is looped on the first TX stream instead of the built-in beat */
+#define SD_AUTOPLAY_FILE            "AUDIO.WAV"
+/* Interval of the level meter results, printed with PRIO_MEDIUM, 0 disables metering */
+#define LEVEL_METER_PERIOD_MS       (1000)
+/* Index into syncStreams, which is broadcast as RTP for remote monitoring, -1 disables the tap */
+#define RTP_TAP_STREAM              (-1)
+#define RTP_TAP_UDP_PORT            (5004)
+#define RTP_TAP_FORMAT              (RtpTap_Format_L16)
+/* Index into syncStreams, which is played on the headphone output of the board, -1 disables the sink */
+#define CODEC_SINK_STREAM           (-1)
+/* Index of a TX stream in syncStreams, which gets the line input of the board, -1 disables the source */
+#define CODEC_SOURCE_STREAM         (-1)
+
+typedef struct
+{
+    DIM2LLD_ChannelDirection_t dir;
+    uint8_t instance;
+    uint16_t bytesPerFrame;
+    uint16_t numberOfBuffers;
+} SyncStreamConfig_t;
+
+/* Must match the sync channels (instance, subSize, numberOfBuffers) in mlbConfig of task-unicens.c.
+ * The first TX stream plays the AVB listener, the first RX stream feeds the AVB talker. */
+static const SyncStreamConfig_t syncStreams[] =
+{
+    { DIM2LLD_ChannelDirection_TX, 0, 4, 4 },
+#ifdef ENABLE_AUDIO_RX
+    { DIM2LLD_ChannelDirection_RX, 0, 4, 4 },
+#endif
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define SYNC_STREAM_COUNT           (sizeof(syncStreams) / sizeof(SyncStreamConfig_t))
+#define BEAT_BYTES_PER_FRAME        (4)
+#define MOST_FRAME_RATE             (48000)
+
+typedef struct
+{
+    const SyncStreamConfig_t *pConfig;
+    int8_t schedIdx;
+    bool avb;
+    bool tap;
+    bool codecSink;
+    bool codecSource;
+    uint32_t audioPos;
+    uint32_t meterPeriods;
+    uint32_t clips;
+} SyncStream_t;
+
 struct TaskAudioVars
 {
     bool initialized;
-    uint32_t audioPos;
+    bool sdCardPresent;
+    uint32_t tapGaps;
+    SyncStream_t streams[SYNC_STREAM_COUNT];
 };
 static struct TaskAudioVars m = { 0 };
 static const uint8_t audioData[] =
@@ -55,7 +118,13 @@ static const uint8_t audioData[] =
 /*                      PRIVATE FUNCTION PROTOTYPES                     */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
-static bool ProcessStreamingData(const uint8_t *pRxBuf, uint32_t rxLen, uint8_t *pTxBuf, uint32_t txLen);
+static const SyncStreamConfig_t *GetTxStreamConfig(uint8_t instance);
+static bool FillTxStream(void *pTag, uint8_t *pTxBuf, uint32_t txLen);
+static void ConsumeRxStream(void *pTag, const uint8_t *pRxBuf, uint32_t rxLen);
+static void ReadSdStream(uint8_t instance, uint8_t *pTxBuf, uint32_t txLen);
+static void ReadBeat(SyncStream_t *pStream, uint8_t *pTxBuf, uint32_t txLen);
+static void PrintLevels(SyncStream_t *pStream);
+static void PrintTapGaps(void);
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                         PUBLIC FUNCTIONS                             */
@@ -63,53 +132,239 @@ static bool ProcessStreamingData(const uint8_t *pRxBuf, uint32_t rxLen, uint8_t
 
 bool TaskAudio_Init(void)
 {
+    uint8_t i;
+    uint16_t listenerBytesPerFrame = 0;
+    uint16_t talkerBytesPerFrame = 0;
+    uint16_t tapBytesPerFrame = 0;
+    uint16_t codecSinkBytesPerFrame = 0;
+    uint16_t codecSourceBytesPerFrame = 0;
+    uint8_t listenerInstance = 0;
     memset(&m, 0, sizeof(m));
-    assert(0 == sizeof(audioData) % 4);
+    assert(0 == sizeof(audioData) % BEAT_BYTES_PER_FRAME);
+    AudioSched_Init(MOST_FRAME_RATE / 1000 * LEVEL_METER_PERIOD_MS);
+    for (i = 0; i < SYNC_STREAM_COUNT; i++)
+    {
+        SyncStream_t *pStream = &m.streams[i];
+        int8_t idx;
+        pStream->pConfig = &syncStreams[i];
+        pStream->tap = (RTP_TAP_STREAM == i);
+        if (pStream->tap)
+            tapBytesPerFrame = pStream->pConfig->bytesPerFrame;
+        pStream->codecSink = (CODEC_SINK_STREAM == i);
+        if (pStream->codecSink)
+            codecSinkBytesPerFrame = pStream->pConfig->bytesPerFrame;
+        pStream->codecSource = (CODEC_SOURCE_STREAM == i && DIM2LLD_ChannelDirection_TX == pStream->pConfig->dir);
+        if (pStream->codecSource)
+            codecSourceBytesPerFrame = pStream->pConfig->bytesPerFrame;
+        if (DIM2LLD_ChannelDirection_TX == pStream->pConfig->dir)
+        {
+            pStream->avb = (0 == listenerBytesPerFrame);
+            if (pStream->avb)
+            {
+                listenerBytesPerFrame = pStream->pConfig->bytesPerFrame;
+                listenerInstance = pStream->pConfig->instance;
+            }
+            idx = AudioSched_AddTxStream(pStream->pConfig->instance, pStream->pConfig->bytesPerFrame, FillTxStream, pStream);
+        }
+        else
+        {
+            pStream->avb = (0 == talkerBytesPerFrame);
+            if (pStream->avb)
+                talkerBytesPerFrame = pStream->pConfig->bytesPerFrame;
+            idx = AudioSched_AddRxStream(pStream->pConfig->instance, pStream->pConfig->bytesPerFrame,
+                pStream->pConfig->numberOfBuffers, ConsumeRxStream, pStream);
+        }
+        pStream->schedIdx = idx;
+        if (0 > idx)
+        {
+            ConsolePrintf(PRIO_ERROR, RED "TaskAudio_Init failed to add sync stream %u" RESETCOLOR "\r\n", i);
+            return false;
+        }
+    }
+    m.sdCardPresent = SDStream_Init();
+    if (m.sdCardPresent && 0 != listenerBytesPerFrame)
+        TaskAudio_PlayFile(listenerInstance, SD_AUTOPLAY_FILE, true);
+    if (!AvbBridge_Init(&gGmacd, listenerBytesPerFrame, talkerBytesPerFrame))
+        ConsolePrintf(PRIO_ERROR, RED "TaskAudio_Init failed to initialize AVB bridge" RESETCOLOR "\r\n");
+    if (0 != tapBytesPerFrame && !RtpTap_Init(&gGmacd, tapBytesPerFrame, RTP_TAP_FORMAT, RTP_TAP_UDP_PORT))
+        ConsolePrintf(PRIO_ERROR, RED "TaskAudio_Init failed to initialize RTP tap" RESETCOLOR "\r\n");
+    if (!CodecBridge_Init(codecSinkBytesPerFrame, codecSourceBytesPerFrame))
+        ConsolePrintf(PRIO_ERROR, RED "TaskAudio_Init failed to initialize the codec" RESETCOLOR "\r\n");
     m.initialized = true;
     return true;
 }
 
+bool TaskAudio_PlayFile(uint8_t instance, const char *pFileName, bool loop)
+{
+    const SyncStreamConfig_t *pConfig = GetTxStreamConfig(instance);
+    if (!m.sdCardPresent || NULL == pConfig)
+        return false;
+    return SDStream_Queue(instance, pFileName, pConfig->bytesPerFrame, loop);
+}
+
+void TaskAudio_StopFile(uint8_t instance)
+{
+    SDStream_Stop(instance);
+}
+
 void TaskAudio_Service(void)
 {
-    while(true)
+    uint8_t i;
+    if (!m.initialized)
+        return;
+    SDStream_Service();
+    AvbBridge_Service();
+    AudioSched_Service();
+    for (i = 0; i < SYNC_STREAM_COUNT; i++)
+        PrintLevels(&m.streams[i]);
+    PrintTapGaps();
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static const SyncStreamConfig_t *GetTxStreamConfig(uint8_t instance)
+{
+    uint8_t i;
+    for (i = 0; i < SYNC_STREAM_COUNT; i++)
+    {
+        if (DIM2LLD_ChannelDirection_TX == syncStreams[i].dir && instance == syncStreams[i].instance)
+            return &syncStreams[i];
+    }
+    return NULL;
+}
+
+static bool FillTxStream(void *pTag, uint8_t *pTxBuf, uint32_t txLen)
+{
+    PROFILE_BEGIN(PROF_STREAM_TX);
+    SyncStream_t *pStream = (SyncStream_t *)pTag;
+    assert(NULL != pStream);
+    if (SDStream_IsActive(pStream->pConfig->instance))
+        ReadSdStream(pStream->pConfig->instance, pTxBuf, txLen);
+    else if (pStream->codecSource && CodecBridge_IsSourceActive())
+        CodecBridge_SourceRead(pTxBuf, txLen);
+    else if (pStream->avb && AvbBridge_IsListening())
+        AvbBridge_ListenerRead(pTxBuf, txLen);
+    else
+        ReadBeat(pStream, pTxBuf, txLen);
+    if (pStream->tap)
+        RtpTap_Write(pTxBuf, txLen);
+    if (pStream->codecSink)
+        CodecBridge_SinkWrite(pTxBuf, txLen);
+    if (BootTimeline_IsReached(BOOT_ROUTE_ACTIVE))
+        BootTimeline_Mark(BOOT_FIRST_AUDIO);
+    PROFILE_END(PROF_STREAM_TX);
+    return true;
+}
+
+static void ConsumeRxStream(void *pTag, const uint8_t *pRxBuf, uint32_t rxLen)
+{
+    PROFILE_BEGIN(PROF_STREAM_RX);
+    SyncStream_t *pStream = (SyncStream_t *)pTag;
+    assert(NULL != pStream);
+    if (pStream->avb)
+        AvbBridge_TalkerWrite(pRxBuf, rxLen);
+    if (pStream->tap)
+        RtpTap_Write(pRxBuf, rxLen);
+    if (pStream->codecSink)
+        CodecBridge_SinkWrite(pRxBuf, rxLen);
+    PROFILE_END(PROF_STREAM_RX);
+}
+
+static void ReadSdStream(uint8_t instance, uint8_t *pTxBuf, uint32_t txLen)
+{
+    const SDStream_Format_t *pFormat = SDStream_GetFormat(instance);
+    uint32_t len = SDStream_Read(instance, pTxBuf, txLen);
+    /* WAV files are little endian, MOST sync channels carry big endian samples.
+     * The WAV parser only accepts the sample sizes handled here */
+    if (NULL != pFormat && pFormat->littleEndian)
     {
-        uint8_t *pTxBuf = NULL;
-        const uint8_t *pRxBuf = NULL;
-        uint16_t rxLen = 0;
-        uint16_t txLen = 0;
-#if ENABLE_AUDIO_RX
-        rxLen = DIM2LLD_GetRxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_RX, 0, 0, &pRxBuf, NULL, NULL);
-        if (0 == rxLen)
+        switch (pFormat->bitsPerSample)
+        {
+        case 16:
+            SampleConv_Swap16(pTxBuf, pTxBuf, len / 2);
             break;
-#endif
-        txLen = DIM2LLD_GetTxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_TX, 0, &pTxBuf);
-        if (0 == txLen)
+        case 24:
+            SampleConv_Swap24(pTxBuf, pTxBuf, len / 3);
+            break;
+        case 32:
+            SampleConv_Swap32(pTxBuf, pTxBuf, len / 4);
+            break;
+        default:
+            assert(false);
             break;
-        if (ProcessStreamingData(pRxBuf, rxLen, pTxBuf, txLen))
-        {
-#if ENABLE_AUDIO_RX
-            DIM2LLD_ReleaseRxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_RX, 0);
-#endif
-            DIM2LLD_SendTxData(DIM2LLD_ChannelType_Sync, DIM2LLD_ChannelDirection_TX, 0, txLen);
         }
-        else break;
     }
+    /* Underrun or end of file: fill up with silence */
+    if (len < txLen)
+        memset(&pTxBuf[len], 0, txLen - len);
 }
 
-/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
-/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
-/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+static void ReadBeat(SyncStream_t *pStream, uint8_t *pTxBuf, uint32_t txLen)
+{
+    uint16_t bytesPerFrame = pStream->pConfig->bytesPerFrame;
+    if (BEAT_BYTES_PER_FRAME == bytesPerFrame)
+    {
+        while (0 != txLen)
+        {
+            uint32_t chunk = sizeof(audioData) - pStream->audioPos;
+            if (chunk > txLen)
+                chunk = txLen;
+            memcpy(pTxBuf, &audioData[pStream->audioPos], chunk);
+            pStream->audioPos += chunk;
+            if (sizeof(audioData) <= pStream->audioPos)
+                pStream->audioPos = 0;
+            pTxBuf += chunk;
+            txLen -= chunk;
+        }
+        return;
+    }
+    /* The beat is stereo, other channel layouts get it on the first two channels */
+    memset(pTxBuf, 0, txLen);
+    for (; txLen >= bytesPerFrame; txLen -= bytesPerFrame)
+    {
+        memcpy(pTxBuf, &audioData[pStream->audioPos], (bytesPerFrame < BEAT_BYTES_PER_FRAME) ? bytesPerFrame : BEAT_BYTES_PER_FRAME);
+        pStream->audioPos += BEAT_BYTES_PER_FRAME;
+        if (sizeof(audioData) <= pStream->audioPos)
+            pStream->audioPos = 0;
+        pTxBuf += bytesPerFrame;
+    }
+}
 
-static bool ProcessStreamingData(const uint8_t *pRxBuf, uint32_t rxLen, uint8_t *pTxBuf, uint32_t txLen)
+static void PrintLevels(SyncStream_t *pStream)
 {
-    uint32_t i;
-    if (!m.initialized)
-        return false;
-    for (i = 0; i < txLen; i++)
+    const LevelMeter_t *pMeter = AudioSched_GetLevels(pStream->schedIdx);
+    uint32_t clips = 0;
+    uint16_t ch;
+    if (NULL == pMeter || pMeter->periods == pStream->meterPeriods)
+        return;
+    pStream->meterPeriods = pMeter->periods;
+    ConsolePrintf(PRIO_MEDIUM, "Sync %s %u levels [dBFS peak/rms]:",
+        (DIM2LLD_ChannelDirection_TX == pStream->pConfig->dir) ? "TX" : "RX", pStream->pConfig->instance);
+    for (ch = 0; ch < pMeter->channels; ch++)
     {
-        pTxBuf[i] = audioData[m.audioPos++];
-        if (sizeof(audioData) <= m.audioPos)
-            m.audioPos = 0;
+        int16_t peak = LevelMeter_ToDecibel(pMeter->levels[ch].peak);
+        int16_t rms = LevelMeter_ToDecibel(pMeter->levels[ch].rms);
+        /* Levels are never above full scale, print the tenths of dB as negative decimal */
+        ConsolePrintf(PRIO_MEDIUM, " -%u.%u/-%u.%u", -peak / 10, -peak % 10, -rms / 10, -rms % 10);
+        clips += pMeter->levels[ch].clips;
     }
-    return true;
-}
\ No newline at end of file
+    ConsolePrintf(PRIO_MEDIUM, "\r\n");
+    if (clips != pStream->clips)
+    {
+        ConsolePrintf(PRIO_HIGH, YELLOW "Sync %s %u: %lu samples clipped" RESETCOLOR "\r\n",
+            (DIM2LLD_ChannelDirection_TX == pStream->pConfig->dir) ? "TX" : "RX", pStream->pConfig->instance, clips - pStream->clips);
+        pStream->clips = clips;
+    }
+}
+
+static void PrintTapGaps(void)
+{
+    const RtpTap_Stats_t *pStats = RtpTap_GetStats();
+    if (pStats->sequenceGaps == m.tapGaps)
+        return;
+    ConsolePrintf(PRIO_HIGH, YELLOW "RTP tap: %lu new sequence gaps, %lu packets lost in total" RESETCOLOR "\r\n",
+        pStats->sequenceGaps - m.tapGaps, pStats->packetsDropped + pStats->sendErrors);
+    m.tapGaps = pStats->sequenceGaps;
+}
@@ -49,6 +49,22 @@ extern "C" {
  */
 bool TaskAudio_Init(void);
 
+/**
+ * \brief Queues playback of a file from the SD card on a sync TX stream
+ * \note While a file is played, it replaces the built-in audio data. Afterwards the built-in data is played again.
+ * \param instance - The sync TX instance, must be listed in the sync stream table of task-audio.c
+ * \param pFileName - 8.3 file name in the root directory of the card (WAV or raw big endian PCM)
+ * \param loop - true, the file is repeated until TaskAudio_StopFile is called. false, it is played once.
+ * \return true, if the file was queued. false, if there is no card or too many files are queued.
+ */
+bool TaskAudio_PlayFile(uint8_t instance, const char *pFileName, bool loop);
+
+/**
+ * \brief Stops the playback of SD card files, and drops all queued files
+ * \param instance - The sync TX instance
+ */
+void TaskAudio_StopFile(uint8_t instance);
+
 /**
  * \brief Gives the Audio Task time to maintain it's service routines
  */
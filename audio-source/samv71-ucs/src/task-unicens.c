@@ -35,19 +35,29 @@
 #include <unistd.h>
 #include <string.h>
 #include <assert.h>
+#include "compiler.h"
 #include "Console.h"
 #include "ucsi_api.h"
 #include "default_config.h"
 #include "timetick.h"
 #include "dim2_lld.h"
 #include "task-unicens.h"
+#include "event_loop.h"
+#include "profile.h"
+#include "boot_timeline.h"
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                          USER ADJUSTABLE                             */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
 #define ENABLE_PROMISCOUS_MODE     (true)
+/* Keep the topology across a controller reset and report the nodes and connection labels, which changed */
+#define ENABLE_WARM_START          (true)
 #define DEBUG_TABLE_PRINT_TIME_MS  (250)
+/* Time after DIM2LLD_Init before the MLB lock is checked */
+#define MLB_SETTLE_MS              (100)
+/* Interval of the error message, as long as MLB is not locked */
+#define MLB_LOCK_REPORT_MS         (1000)
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                      DEFINES AND LOCAL VARIABLES                     */
@@ -66,8 +76,17 @@ typedef struct
     uint16_t bufferOffset;
 } DIM2_Setup_t;
 
+typedef enum
+{
+    StartupState_Settle,
+    StartupState_WaitLock,
+    StartupState_Done
+} StartupState_t;
+
 typedef struct
 {
+    StartupState_t startupState;
+    uint32_t startupTimeout;
     bool allowRun;
     bool lldTrace;
     bool noRouteTable;
@@ -81,6 +100,9 @@ typedef struct
 
 static LocalVar_t m;
 
+/* Not cleared by the startup code, so the last topology survives a reset of the controller */
+static UCSI_TopologyCache_t topologyCache COMPILER_SECTION(".ram_noinit");
+
 static DIM2_Setup_t mlbConfig[] =
 {
     {
@@ -136,7 +158,10 @@ static const uint32_t mlbConfigSize = sizeof(mlbConfig) / sizeof(DIM2_Setup_t);
 /*                     PRIVTATE FUNCTION PROTOTYPES                     */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
+static void ServiceStartup(void);
+static bool StartUnicens(void);
 static void ServiceMostCntrlRx(void);
+static void ResetChannels(DIM2LLD_ChannelType_t cType);
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                         PUBLIC FUNCTIONS                             */
@@ -145,40 +170,19 @@ static void ServiceMostCntrlRx(void);
 bool TaskUnicens_Init(void)
 {
     m.promiscuousMode = ENABLE_PROMISCOUS_MODE;
-    // Initialize MOST DIM2 driver
+    // Initialize MOST DIM2 driver, the lock is awaited in TaskUnicens_Service
     DIM2LLD_Init();
-    Wait(100);
-    while (!DIM2LLD_IsMlbLocked())
-    {
-        ConsolePrintf(PRIO_ERROR, RED "MLB is not locked!" RESETCOLOR "\r\n");
-        Wait(1000);
-    }
-    for (uint32_t i = 0; i < mlbConfigSize; i++)
-    {
-        if (!DIM2LLD_SetupChannel(mlbConfig[i].cType, mlbConfig[i].dir, mlbConfig[i].instance, mlbConfig[i].channelAddress,
-            mlbConfig[i].bufferSize, mlbConfig[i].subSize, mlbConfig[i].numberOfBuffers, mlbConfig[i].bufferOffset))
-        {
-            ConsolePrintf(PRIO_ERROR, "Failed to allocate MLB channel with address=0x%X\r\n", mlbConfig[i].channelAddress);
-            assert(false);
-            return false;
-        }
-    }
-
-    /* Initialize UNICENS */
-    UCSI_Init(&m.unicens, &m);
-    if (!UCSI_NewConfig(&m.unicens, PacketBandwidth, AllRoutes, RoutesSize, AllNodes, NodeSize))
-    {
-        ConsolePrintf(PRIO_ERROR, RED "Could not enqueue new UNICENS config" RESETCOLOR "\r\n");
-        assert(false);
-        return false;
-    }
-    m.allowRun = true;
+    BootTimeline_Mark(BOOT_MLB_STARTED);
+    m.startupState = StartupState_Settle;
+    m.startupTimeout = GetTicks() + MLB_SETTLE_MS;
     return true;
 }
 
 void TaskUnicens_Service(void)
 {
     uint32_t now;
+    if (StartupState_Done != m.startupState)
+        ServiceStartup();
     if (!m.allowRun)
         return;
     ServiceMostCntrlRx();
@@ -186,8 +190,10 @@ void TaskUnicens_Service(void)
     /* UNICENS Service */
     if (m.unicensTrigger)
     {
+        PROFILE_BEGIN(PROF_UCSI_SERVICE);
         m.unicensTrigger = false;
         UCSI_Service(&m.unicens);
+        PROFILE_END(PROF_UCSI_SERVICE);
     }
     if (0 != m.unicensTimeout && now >= m.unicensTimeout)
     {
@@ -212,13 +218,98 @@ void TaskUnicens_Service(void)
 
 bool TaskUnicens_SetRouteActive(uint16_t routeId, bool isActive)
 {
+    if (!m.allowRun)
+        return false;
     return UCSI_SetRouteActive(&m.unicens, routeId, isActive);
 }
 
+void TaskUnicens_PrintQueueStats(void)
+{
+    UCSI_QueueStats_t stats;
+    UCSI_GetQueueStats(&m.unicens, &stats);
+    ConsolePrintf(PRIO_MEDIUM, "UNICENS queue: enqueued=%lu merged=%lu cancelled=%lu\r\n",
+        stats.enqueued, stats.merged, stats.cancelled);
+}
+
+void TaskUnicens_PrintRecoveryStats(void)
+{
+    uint8_t i;
+    UCSI_RecoveryStats_t stats;
+    static const char *const names[UCSI_Recovery_Count] = { "retry", "route", "channel", "full" };
+    UCSI_GetRecoveryStats(&m.unicens, &stats);
+    for (i = 0; i < UCSI_Recovery_Count; i++)
+    {
+        if (0 == stats.count[i] && 0 == stats.failed[i])
+            continue;
+        ConsolePrintf(PRIO_MEDIUM, "UNICENS recovery %-7s ok=%lu failed=%lu downtime last=%ums max=%ums\r\n",
+            names[i], stats.count[i], stats.failed[i], stats.lastDowntime[i], stats.maxDowntime[i]);
+    }
+}
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                  PRIVATE FUNCTION IMPLEMENTATIONS                    */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 
+static void ServiceStartup(void)
+{
+    uint32_t now = GetTicks();
+    switch (m.startupState)
+    {
+    case StartupState_Settle:
+        if (now < m.startupTimeout)
+            return;
+        m.startupState = StartupState_WaitLock;
+        m.startupTimeout = now + MLB_LOCK_REPORT_MS;
+        /* fall through */
+    case StartupState_WaitLock:
+        if (!DIM2LLD_IsMlbLocked())
+        {
+            if (now >= m.startupTimeout)
+            {
+                ConsolePrintf(PRIO_ERROR, RED "MLB is not locked!" RESETCOLOR "\r\n");
+                m.startupTimeout = now + MLB_LOCK_REPORT_MS;
+            }
+            return;
+        }
+        BootTimeline_Mark(BOOT_MLB_LOCKED);
+        m.startupState = StartupState_Done;
+        m.allowRun = StartUnicens();
+        if (!m.allowRun)
+            ConsolePrintf(PRIO_ERROR, RED "Init of Task UNICENS Init Failed" RESETCOLOR "\r\n");
+        break;
+    default:
+        break;
+    }
+}
+
+static bool StartUnicens(void)
+{
+    for (uint32_t i = 0; i < mlbConfigSize; i++)
+    {
+        if (!DIM2LLD_SetupChannel(mlbConfig[i].cType, mlbConfig[i].dir, mlbConfig[i].instance, mlbConfig[i].channelAddress,
+            mlbConfig[i].bufferSize, mlbConfig[i].subSize, mlbConfig[i].numberOfBuffers, mlbConfig[i].bufferOffset))
+        {
+            ConsolePrintf(PRIO_ERROR, "Failed to allocate MLB channel with address=0x%X\r\n", mlbConfig[i].channelAddress);
+            assert(false);
+            return false;
+        }
+    }
+    BootTimeline_Mark(BOOT_CHANNELS_READY);
+
+    /* Initialize UNICENS */
+    UCSI_Init(&m.unicens, &m);
+    if (ENABLE_WARM_START)
+        UCSI_SetTopologyCache(&m.unicens, &topologyCache);
+    if (!UCSI_NewConfig(&m.unicens, PacketBandwidth, AllRoutes, RoutesSize, AllNodes, NodeSize))
+    {
+        ConsolePrintf(PRIO_ERROR, RED "Could not enqueue new UNICENS config" RESETCOLOR "\r\n");
+        assert(false);
+        return false;
+    }
+    BootTimeline_Mark(BOOT_UCSI_INIT);
+    return true;
+}
+
 static void ServiceMostCntrlRx(void)
 {
     uint16_t bufLen;
@@ -254,6 +345,17 @@ static void ServiceMostCntrlRx(void)
     while (0 != bufLen);
 }
 
+static void ResetChannels(DIM2LLD_ChannelType_t cType)
+{
+    for (uint32_t i = 0; i < mlbConfigSize; i++)
+    {
+        if (cType != mlbConfig[i].cType)
+            continue;
+        if (!DIM2LLD_ResetChannel(mlbConfig[i].cType, mlbConfig[i].dir, mlbConfig[i].instance))
+            ConsolePrintf(PRIO_ERROR, RED "Failed to reset MLB channel with address=0x%X" RESETCOLOR "\r\n", mlbConfig[i].channelAddress);
+    }
+}
+
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                  CALLBACK FUNCTIONS FROM UNICENS                     */
@@ -283,6 +385,8 @@ void UCSI_CB_OnNetworkState(void *pTag, bool isAvailable, uint16_t packetBandwid
     pTag = pTag;
     ConsolePrintf(PRIO_HIGH, YELLOW "Network isAvailable=%s, packetBW=%d, nodeCount=%d" RESETCOLOR "\r\n",
         isAvailable ? "yes" : "no", packetBandwidth, amountOfNodes);
+    if (isAvailable)
+        BootTimeline_Mark(BOOT_NETWORK_UP);
 }
 
 void UCSI_CB_OnUserMessage(void *pTag, bool isError, const char format[], uint16_t vargsCnt, ...)
@@ -307,10 +411,32 @@ void UCSI_CB_OnPrintRouteTable(void *pTag, const char pString[])
 void UCSI_CB_OnServiceRequired(void *pTag)
 {
     m.unicensTrigger = true;
+    EventLoop_Post(EVENT_UNICENS);
 }
 
 void UCSI_CB_OnResetInic(void *pTag)
 {
+    pTag = pTag;
+    /* This board has no reset line to the INIC, so its packet interface is restarted instead.
+     * The control channels have been reset by UCSI_CB_OnResetControlChannel already */
+    ResetChannels(DIM2LLD_ChannelType_Async);
+}
+
+void UCSI_CB_OnResetControlChannel(void *pTag)
+{
+    uint16_t dropped = 0;
+    const uint8_t *pBuf;
+    pTag = pTag;
+    /* Messages still queued in the DIM2 belong to the terminated UNICENS instance */
+    while (0 != DIM2LLD_GetRxData(DIM2LLD_ChannelType_Control, DIM2LLD_ChannelDirection_RX, 0, 0, &pBuf, NULL, NULL))
+    {
+        DIM2LLD_ReleaseRxData(DIM2LLD_ChannelType_Control, DIM2LLD_ChannelDirection_RX, 0);
+        ++dropped;
+    }
+    if (0 != dropped)
+        ConsolePrintf(PRIO_MEDIUM, "Dropped %d stale control messages\r\n", dropped);
+    /* Also drops messages in the DIM2 hardware and transmissions of the old instance */
+    ResetChannels(DIM2LLD_ChannelType_Control);
 }
 
 void UCSI_CB_OnTxRequest(void *pTag,
@@ -362,6 +488,8 @@ void UCSI_CB_OnRouteResult(void *pTag, uint16_t routeId, bool isActive, uint16_t
 {
     ConsolePrintf(PRIO_MEDIUM, "Route id=0x%X isActive=%s ConLabel=0x%X\r\n", routeId,
         (isActive ? "true" : "false"), connectionLabel);
+    if (isActive)
+        BootTimeline_Mark(BOOT_ROUTE_ACTIVE);
     TaskUnicens_CB_OnRouteResult(routeId, isActive, connectionLabel);
 }
 
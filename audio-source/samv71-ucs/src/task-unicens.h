@@ -41,7 +41,8 @@ extern "C" {
 
 /**
  * \brief Initializes the UNICENS Task
- * \note Must be called before any other function of this component
+ * \note Must be called before any other function of this component. Only starts the MLB interface, the
+ *       channels and UNICENS are set up by TaskUnicens_Service as soon as MLB is locked.
  * \return true, if initialization was successful. false, otherwise, do not call any other function in that case
  */
 bool TaskUnicens_Init(void);
@@ -57,10 +58,21 @@ void TaskUnicens_Service(void);
  * \param routeId - identifier as given in XML file along with MOST socket (unique)
  * \param isActive - true, route will become active. false, route will be deallocated
  *
- * \return true, if route was found and the specific command was enqueued to UNICENS.
+ * \return true, if route was found and the specific command was enqueued to UNICENS. false, also if UNICENS is not started yet.
  */
 bool TaskUnicens_SetRouteActive(uint16_t routeId, bool isActive);
 
+/**
+ * \brief Prints how many UNICENS commands were queued, and how many of them were merged into
+ *        or cancelled by pending commands instead of being sent to the INIC
+ */
+void TaskUnicens_PrintQueueStats(void);
+
+/**
+ * \brief Prints how often each error recovery step succeeded or failed, and the downtime it caused
+ */
+void TaskUnicens_PrintRecoveryStats(void);
+
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
 /*                        CALLBACK SECTION                              */
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
@@ -0,0 +1,189 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Cooperative Task Scheduler Implementation                                                      */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <string.h>
+#include <assert.h>
+#include "board.h"
+#include "utility.h"
+#include "event_loop.h"
+#include "task_sched.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+typedef struct
+{
+    const char *pName;
+    TaskSched_Func_t func;
+    uint32_t events;
+    uint8_t priority;
+    uint32_t deadlineCycles;
+    uint32_t budgetCycles;
+    uint32_t pending;
+    uint32_t readyCycles;
+    TaskSched_Stats_t stats;
+} Task_t;
+
+typedef struct
+{
+    Task_t tasks[TASKSCHED_MAX_TASKS];
+    uint8_t taskCount;
+    uint32_t cyclesPerUs;
+} LocalVar_t;
+
+static LocalVar_t m;
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      PRIVATE FUNCTION PROTOTYPES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void Distribute(uint32_t events);
+static Task_t *GetNextTask(void);
+static void RunTask(Task_t *pTask);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void TaskSched_Init(void)
+{
+    memset(&m, 0, sizeof(m));
+    m.cyclesPerUs = SystemCoreClock / 1000000;
+}
+
+int8_t TaskSched_Add(const char *pName, TaskSched_Func_t func, uint32_t events, uint8_t priority, uint32_t deadlineUs, uint32_t budgetUs)
+{
+    Task_t *pTask;
+    assert(NULL != pName && NULL != func);
+    if (TASKSCHED_MAX_TASKS <= m.taskCount)
+        return -1;
+    pTask = &m.tasks[m.taskCount];
+    pTask->pName = pName;
+    pTask->func = func;
+    pTask->events = events;
+    pTask->priority = priority;
+    pTask->deadlineCycles = deadlineUs * m.cyclesPerUs;
+    pTask->budgetCycles = budgetUs * m.cyclesPerUs;
+    return (int8_t)m.taskCount++;
+}
+
+void TaskSched_Service(void)
+{
+    Task_t *pTask;
+    Distribute(EventLoop_Wait());
+    while (NULL != (pTask = GetNextTask()))
+    {
+        RunTask(pTask);
+        Distribute(EventLoop_Poll());
+    }
+}
+
+uint8_t TaskSched_GetTaskCount(void)
+{
+    return m.taskCount;
+}
+
+const char *TaskSched_GetName(int8_t task)
+{
+    if (0 > task || m.taskCount <= task)
+        return NULL;
+    return m.tasks[task].pName;
+}
+
+const TaskSched_Stats_t *TaskSched_GetStats(int8_t task)
+{
+    if (0 > task || m.taskCount <= task)
+        return NULL;
+    return &m.tasks[task].stats;
+}
+
+void TaskSched_ResetStats(void)
+{
+    uint8_t i;
+    for (i = 0; i < m.taskCount; i++)
+        memset(&m.tasks[i].stats, 0, sizeof(TaskSched_Stats_t));
+}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                   PRIVATE FUNCTION IMPLEMENTATIONS                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static void Distribute(uint32_t events)
+{
+    uint32_t now;
+    uint8_t i;
+    if (0 == events)
+        return;
+    GET_CYCLE_COUNTER(now);
+    for (i = 0; i < m.taskCount; i++)
+    {
+        Task_t *pTask = &m.tasks[i];
+        if (0 == (events & pTask->events))
+            continue;
+        if (0 == pTask->pending)
+            pTask->readyCycles = now;
+        pTask->pending |= (events & pTask->events);
+    }
+}
+
+static Task_t *GetNextTask(void)
+{
+    Task_t *pNext = NULL;
+    uint8_t i;
+    for (i = 0; i < m.taskCount; i++)
+    {
+        Task_t *pTask = &m.tasks[i];
+        if (0 != pTask->pending && (NULL == pNext || pTask->priority < pNext->priority))
+            pNext = pTask;
+    }
+    return pNext;
+}
+
+static void RunTask(Task_t *pTask)
+{
+    uint32_t start, end, latency, cycles;
+    GET_CYCLE_COUNTER(start);
+    latency = start - pTask->readyCycles;
+    pTask->pending = 0;
+    pTask->func();
+    GET_CYCLE_COUNTER(end);
+    cycles = end - start;
+    pTask->stats.runs++;
+    pTask->stats.totalCycles += cycles;
+    if (cycles > pTask->stats.maxCycles)
+        pTask->stats.maxCycles = cycles;
+    if (latency > pTask->stats.maxLatencyCycles)
+        pTask->stats.maxLatencyCycles = latency;
+    if (0 != pTask->budgetCycles && cycles > pTask->budgetCycles)
+        pTask->stats.overruns++;
+    if (0 != pTask->deadlineCycles && latency > pTask->deadlineCycles)
+        pTask->stats.deadlineMisses++;
+}
@@ -0,0 +1,123 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Cooperative Task Scheduler                                                                     */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Runs the tasks of the main loop by priority. Each task
+ *         subscribes to events of the event loop. After every task
+ *         invocation the events are polled again, so a high priority
+ *         task waits at most for one invocation of a lower one.
+ *         Every invocation is timed with the DWT cycle counter and
+ *         checked against the cycle budget and the deadline of the
+ *         task.
+ */
+/*----------------------------------------------------------*/
+#ifndef TASK_SCHED_H_
+#define TASK_SCHED_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define TASKSCHED_MAX_TASKS     (8)
+
+typedef void (*TaskSched_Func_t)(void);
+
+typedef struct
+{
+    uint32_t runs;
+    uint32_t overruns;          /**< Invocations, which took longer than the budget */
+    uint32_t deadlineMisses;    /**< Invocations, which started later than the deadline after the task became ready */
+    uint32_t maxCycles;         /**< Longest invocation */
+    uint32_t maxLatencyCycles;  /**< Longest time between becoming ready and running */
+    uint64_t totalCycles;       /**< Sum of all invocations, shows which task takes the CPU (32 bit wrap after 14 s at 300 MHz) */
+} TaskSched_Stats_t;
+
+/**
+ * \brief Removes all tasks.
+ * \note EventLoop_Init must have been called before.
+ */
+void TaskSched_Init(void);
+
+/**
+ * \brief Registers a task.
+ * \param pName - Name for the reports, must stay valid
+ * \param func - Service function of the task, must return after a bounded amount of work
+ * \param events - Bit mask of EVENT_ values, which make the task ready
+ * \param priority - 0 is the highest priority, tasks of equal priority run in the order of registration
+ * \param deadlineUs - Maximum time between becoming ready and running, 0 disables the check
+ * \param budgetUs - Maximum duration of one invocation, 0 disables the check
+ * \return Task index for TaskSched_GetStats, -1 if the task table is full.
+ */
+int8_t TaskSched_Add(const char *pName, TaskSched_Func_t func, uint32_t events, uint8_t priority, uint32_t deadlineUs, uint32_t budgetUs);
+
+/**
+ * \brief Sleeps until events are pending and runs all tasks, which became ready. Call it in an endless loop.
+ */
+void TaskSched_Service(void);
+
+/**
+ * \brief Returns the amount of registered tasks.
+ * \return Number of tasks, valid indices are 0 to the returned value - 1.
+ */
+uint8_t TaskSched_GetTaskCount(void);
+
+/**
+ * \brief Returns the name of a task.
+ * \param task - Index returned by TaskSched_Add
+ * \return The name or NULL, if the index is invalid.
+ */
+const char *TaskSched_GetName(int8_t task);
+
+/**
+ * \brief Returns the statistics of a task.
+ * \note The cycle values are CPU cycles, divide by SystemCoreClock / 1000000 to get microseconds.
+ * \param task - Index returned by TaskSched_Add
+ * \return Pointer to the statistics or NULL, if the index is invalid.
+ */
+const TaskSched_Stats_t *TaskSched_GetStats(int8_t task);
+
+/**
+ * \brief Clears the statistics of all tasks.
+ */
+void TaskSched_ResetStats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TASK_SCHED_H_ */
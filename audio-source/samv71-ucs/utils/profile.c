@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Cycle Counter Profiling Implementation                                                         */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "board.h"
+#include "profile.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                      DEFINES AND LOCAL VARIABLES                     */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+#define LINE_LEN                (320)
+
+typedef struct
+{
+    Profile_Stats_t probes[PROF_COUNT];
+    char line[LINE_LEN];
+} LocalVar_t;
+
+static const char *const probeNames[PROF_COUNT] =
+{
+    "mlb_isr",
+    "ahb_isr",
+    "gmac_isr",
+    "gmac_q1_isr",
+    "gmac_q2_isr",
+    "dim2_service",
+    "ucsi_service",
+    "stream_tx",
+    "stream_rx",
+    "console_service"
+};
+
+static LocalVar_t m =
+{
+    .probes = { [0 ... PROF_COUNT - 1] = { .minCycles = UINT32_MAX } }
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         PUBLIC FUNCTIONS                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+void Profile_Record(Profile_Probe_t probe, uint32_t cycles)
+{
+    Profile_Stats_t *pStats;
+    uint32_t bucket;
+    assert(PROF_COUNT > probe);
+    pStats = &m.probes[probe];
+    pStats->count++;
+    pStats->totalCycles += cycles;
+    if (cycles < pStats->minCycles)
+        pStats->minCycles = cycles;
+    if (cycles > pStats->maxCycles)
+        pStats->maxCycles = cycles;
+    bucket = 31 - __CLZ(cycles | 1);
+    if (PROFILE_HIST_BUCKETS <= bucket)
+        bucket = PROFILE_HIST_BUCKETS - 1;
+    pStats->hist[bucket]++;
+}
+
+const Profile_Stats_t *Profile_GetStats(Profile_Probe_t probe)
+{
+    assert(PROF_COUNT > probe);
+    return &m.probes[probe];
+}
+
+const char *Profile_GetName(Profile_Probe_t probe)
+{
+    assert(PROF_COUNT > probe);
+    return probeNames[probe];
+}
+
+void Profile_Print(ConsolePrio_t prio)
+{
+    uint32_t i, b;
+    ConsolePrintf(prio, "prof clock=%lu\r\n", SystemCoreClock);
+    for (i = 0; i < PROF_COUNT; i++)
+    {
+        Profile_Stats_t stats;
+        int pos;
+        uint32_t primask = __get_PRIMASK();
+        /* Take a consistent copy, ISR probes may update meanwhile */
+        __disable_irq();
+        stats = m.probes[i];
+        if (0 == primask)
+            __enable_irq();
+        if (0 == stats.count)
+            continue;
+        pos = snprintf(m.line, LINE_LEN, "prof %s n=%lu min=%lu avg=%lu max=%lu hist=", probeNames[i], stats.count,
+            stats.minCycles, (uint32_t)(stats.totalCycles / stats.count), stats.maxCycles);
+        for (b = 0; b < PROFILE_HIST_BUCKETS && pos < LINE_LEN; b++)
+            pos += snprintf(&m.line[pos], LINE_LEN - pos, (0 == b) ? "%lu" : ",%lu", stats.hist[b]);
+        ConsolePrintf(prio, "%s\r\n", m.line);
+    }
+}
+
+void Profile_Reset(void)
+{
+    uint32_t i;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset(m.probes, 0, sizeof(m.probes));
+    for (i = 0; i < PROF_COUNT; i++)
+        m.probes[i].minCycles = UINT32_MAX;
+    if (0 == primask)
+        __enable_irq();
+}
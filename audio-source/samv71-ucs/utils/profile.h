@@ -0,0 +1,142 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Cycle Counter Profiling                                                                        */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Named profiling probes based on the DWT cycle counter.
+ *         Wrap a code section with PROFILE_BEGIN and PROFILE_END,
+ *         both compile to a single read of DWT->CYCCNT. Every probe
+ *         keeps count, min, average, max and a log2 histogram of the
+ *         measured cycles. Profile_Print dumps the table over the
+ *         console, tools/profile-print/profile_print.py turns the
+ *         dump into a readable report on the host.
+ *  \note RESET_CYCLE_COUNTER must have been called once, this is
+ *        done by EventLoop_Init.
+ */
+/*----------------------------------------------------------*/
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "utility.h"
+#include "Console.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                          USER ADJUSTABLE                             */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* Set to 0 to compile all probes away */
+#ifndef PROFILE_ENABLED
+#define PROFILE_ENABLED         (1)
+#endif
+
+/* Bucket n counts durations of 2^n to 2^(n+1)-1 cycles, the last bucket counts everything longer */
+#define PROFILE_HIST_BUCKETS    (20)
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                            Public API                                */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+/* A probe must only be used from one context (one ISR or the main loop), so updates never interleave.
+ * Add new probes here and their name in profile.c */
+typedef enum
+{
+    PROF_MLB_ISR = 0,
+    PROF_AHB_ISR,
+    PROF_GMAC_ISR,
+    PROF_GMAC_Q1_ISR,
+    PROF_GMAC_Q2_ISR,
+    PROF_DIM2_SERVICE,
+    PROF_UCSI_SERVICE,
+    PROF_STREAM_TX,
+    PROF_STREAM_RX,
+    PROF_CONSOLE_SERVICE,
+    PROF_COUNT
+} Profile_Probe_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t hist[PROFILE_HIST_BUCKETS];
+} Profile_Stats_t;
+
+#if PROFILE_ENABLED
+#define PROFILE_BEGIN(probe)    uint32_t probe##_start; GET_CYCLE_COUNTER(probe##_start)
+#define PROFILE_END(probe)      Profile_Record(probe, DWT->CYCCNT - probe##_start)
+#else
+#define PROFILE_BEGIN(probe)    do { } while (0)
+#define PROFILE_END(probe)      do { } while (0)
+#endif
+
+/**
+ * \brief Adds one measurement to a probe. Normally used via PROFILE_END.
+ * \param probe - The probe to update
+ * \param cycles - Duration of the measured section in CPU cycles
+ */
+void Profile_Record(Profile_Probe_t probe, uint32_t cycles);
+
+/**
+ * \brief Returns the statistics of a probe.
+ * \param probe - The probe
+ * \return Pointer to the statistics, count is 0 if the probe did not run since the last reset.
+ */
+const Profile_Stats_t *Profile_GetStats(Profile_Probe_t probe);
+
+/**
+ * \brief Returns the name of a probe, as used in the console dump.
+ * \param probe - The probe
+ * \return The name.
+ */
+const char *Profile_GetName(Profile_Probe_t probe);
+
+/**
+ * \brief Prints all probes, which ran since the last reset.
+ * \note The output lines start with "prof " and are parsed by tools/profile-print/profile_print.py.
+ * \param prio - Console priority of the dump
+ */
+void Profile_Print(ConsolePrio_t prio);
+
+/**
+ * \brief Clears the statistics of all probes.
+ */
+void Profile_Reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILE_H_ */
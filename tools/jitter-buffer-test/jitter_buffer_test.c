@@ -0,0 +1,141 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Host Test for the Adaptive Jitter Buffer                                                       */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Simulates a bursty writer with clock drift against a
+ *         steady reader on audio-source/samv71-ucs/src/audio/
+ *         jitter_buffer.c and checks that the drift is corrected
+ *         by dropping or repeating frames instead of underruns and
+ *         overflows. Build and run on the host from the repository
+ *         root:
+ *
+ *         gcc -O2 -Iaudio-source/samv71-ucs/src/audio \
+ *             tools/jitter-buffer-test/jitter_buffer_test.c \
+ *             audio-source/samv71-ucs/src/audio/jitter_buffer.c \
+ *             -o jitter_buffer_test && ./jitter_buffer_test
+ */
+/*----------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdint.h>
+#include "jitter_buffer.h"
+
+#define BYTES_PER_FRAME     (4)
+#define FRAMES_PER_MS       (48)
+#define BURST_MS            (8)     /**< Mean write interval, varies from 2 to 14 ms */
+#define SETTLE_MS           (20000)
+#define RUN_MS              (60000)
+#define MIN_LATENCY         (FRAMES_PER_MS)
+#define MAX_LATENCY         (FRAMES_PER_MS * 40)
+
+typedef struct
+{
+    const char *name;
+    int32_t driftPpm;           /**< Writer clock relative to the reader */
+} Scenario_t;
+
+static const Scenario_t scenarios[] =
+{
+    { "writer fast", 500 },
+    { "writer slow", -500 },
+    { "no drift", 0 },
+};
+
+static uint8_t mem[MAX_LATENCY * BYTES_PER_FRAME * 2];
+static uint8_t burst[FRAMES_PER_MS * (BURST_MS + 6) * BYTES_PER_FRAME];
+static uint8_t out[FRAMES_PER_MS * BYTES_PER_FRAME];
+
+static int RunScenario(const Scenario_t *s)
+{
+    JitterBuffer_t jb;
+    JitterBuffer_Stats_t settled = { 0 };
+    const JitterBuffer_Stats_t *st;
+    int64_t acc = 0;
+    uint32_t maxLatency = 0;
+    uint32_t ms;
+    uint32_t nextWrite = 0;
+    int32_t expected;
+    int32_t net;
+    uint32_t seed = 1;
+    int errors = 0;
+    JitterBuffer_Init(&jb, mem, sizeof(mem), BYTES_PER_FRAME, MIN_LATENCY, MAX_LATENCY);
+    for (ms = 0; ms < SETTLE_MS + RUN_MS; ms++)
+    {
+        /* The writer delivers all frames since its last write at once, the reader takes one millisecond each tick */
+        acc += FRAMES_PER_MS * (1000000 + s->driftPpm);
+        if (nextWrite == ms)
+        {
+            seed = seed * 1103515245 + 12345;
+            nextWrite += BURST_MS - 6 + (seed >> 16) % 13;
+            uint32_t frames = (uint32_t)(acc / 1000000);
+            acc -= (int64_t)frames * 1000000;
+            JitterBuffer_Write(&jb, burst, frames * BYTES_PER_FRAME);
+        }
+        JitterBuffer_Read(&jb, out, sizeof(out));
+        if (SETTLE_MS == ms)
+            settled = *JitterBuffer_GetStats(&jb);
+        if (SETTLE_MS < ms && JitterBuffer_GetLatency(&jb) > maxLatency)
+            maxLatency = JitterBuffer_GetLatency(&jb);
+    }
+    st = JitterBuffer_GetStats(&jb);
+    /* Once settled, the net correction must cancel the drift, the remaining difference is absorbed by the target */
+    expected = (int32_t)((int64_t)s->driftPpm * FRAMES_PER_MS * RUN_MS / 1000000);
+    net = (int32_t)(st->framesDropped - settled.framesDropped) - (int32_t)(st->framesInserted - settled.framesInserted);
+    printf("%-12s underruns %lu overflows %lu net correction %ld of %ld frames, jitter %lu target %lu max latency %lu frames\n",
+        s->name, (unsigned long)(st->underruns - settled.underruns), (unsigned long)(st->overflows - settled.overflows),
+        (long)net, (long)expected, (unsigned long)st->jitterFrames, (unsigned long)st->targetFrames, (unsigned long)maxLatency);
+    if (st->underruns != settled.underruns || st->overflows != settled.overflows)
+    {
+        printf("  FAIL: underruns or overflows after %u ms\n", SETTLE_MS);
+        errors++;
+    }
+    if (st->jitterFrames < FRAMES_PER_MS * (BURST_MS + 6))
+    {
+        printf("  FAIL: jitter estimate below the largest write burst\n");
+        errors++;
+    }
+    if (net > expected + (int32_t)st->targetFrames / 2 || net < expected - (int32_t)st->targetFrames / 2)
+    {
+        printf("  FAIL: drift not corrected\n");
+        errors++;
+    }
+    return errors;
+}
+
+int main(void)
+{
+    int errors = 0;
+    uint32_t i;
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+        errors += RunScenario(&scenarios[i]);
+    printf(0 == errors ? "PASS\n" : "FAILED\n");
+    return errors;
+}
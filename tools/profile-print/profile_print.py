@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+#
+# Pretty-prints the profiling dump of the SAM V71 UNICENS sample.
+#
+# The firmware prints lines starting with "prof " every load report
+# interval (see utils/profile.c). Pipe the console log into this script,
+# it prints the last dump of every probe in microseconds together with
+# its log2 histogram:
+#
+#   nc -ul 5555 | python3 tools/profile-print/profile_print.py
+#   python3 tools/profile-print/profile_print.py console.log
+#
+# Use --all to print every dump instead of only the last one, for
+# example to compare the figures before and after a change.
+
+import argparse
+import re
+import sys
+
+LINE_RE = re.compile(r'prof (\S+) n=(\d+) min=(\d+) avg=(\d+) max=(\d+) hist=([\d,]+)')
+CLOCK_RE = re.compile(r'prof clock=(\d+)')
+BAR_WIDTH = 40
+
+
+def bucket_label(index, last, clock):
+    low = 0 if 0 == index else 1 << index
+    us = low * 1000000.0 / clock
+    suffix = '+' if index == last else ''
+    return '>=%9.2fus%s' % (us, suffix)
+
+
+def print_dump(clock, probes, show_hist):
+    to_us = 1000000.0 / clock
+    print('%-16s %9s %10s %10s %10s' % ('probe', 'count', 'min us', 'avg us', 'max us'))
+    for name, (count, cmin, cavg, cmax, hist) in probes.items():
+        print('%-16s %9d %10.2f %10.2f %10.2f' % (name, count, cmin * to_us, cavg * to_us, cmax * to_us))
+        if not show_hist:
+            continue
+        peak = max(hist) or 1
+        for i, n in enumerate(hist):
+            if 0 == n:
+                continue
+            bar = '#' * max(1, n * BAR_WIDTH // peak)
+            print('    %s %9d %s' % (bucket_label(i, len(hist) - 1, clock), n, bar))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pretty-print the profiling dump of the SAM V71 UNICENS sample')
+    parser.add_argument('log', nargs='?', help='console log, stdin if omitted')
+    parser.add_argument('--all', action='store_true', help='print every dump, not only the last one')
+    parser.add_argument('--no-hist', action='store_true', help='omit the histograms')
+    args = parser.parse_args()
+
+    source = open(args.log, errors='replace') if args.log else sys.stdin
+    clock = None
+    probes = {}
+    dumps = 0
+    for line in source:
+        match = CLOCK_RE.search(line)
+        if match:
+            if probes and args.all:
+                print_dump(clock, probes, not args.no_hist)
+            clock = int(match.group(1))
+            probes = {}
+            dumps += 1
+            continue
+        match = LINE_RE.search(line)
+        if match and clock:
+            hist = [int(x) for x in match.group(6).split(',')]
+            probes[match.group(1)] = (int(match.group(2)), int(match.group(3)), int(match.group(4)),
+                                      int(match.group(5)), hist)
+    if 0 == dumps:
+        sys.exit('no profiling dump found')
+    if probes:
+        print_dump(clock, probes, not args.no_hist)
+    elif not args.all:
+        print('no probe ran during the last interval')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,142 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Host Benchmark for the Sample Conversion Kernels                                               */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Measures the conversion kernels of
+ *         audio-source/samv71-ucs/src/audio/sample_conv.c against a
+ *         per byte reference loop and checks that both produce the
+ *         same output. Build and run on the host from the repository
+ *         root:
+ *
+ *         gcc -O2 -Iaudio-source/samv71-ucs/src/audio \
+ *             tools/sample-conv-bench/sample_conv_bench.c \
+ *             audio-source/samv71-ucs/src/audio/sample_conv.c \
+ *             -o sample_conv_bench && ./sample_conv_bench
+ */
+/*----------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "sample_conv.h"
+
+#define SAMPLES         (4096)
+#define ITERATIONS      (20000)
+
+typedef struct
+{
+    const char *name;
+    SampleConv_Format_t src;
+    SampleConv_Format_t dst;
+} Case_t;
+
+static const Case_t cases[] =
+{
+    { "S16LE -> S16BE (WAV)",        SampleConv_S16LE, SampleConv_S16BE },
+    { "S24LE -> S16BE (WAV 24 bit)", SampleConv_S24LE, SampleConv_S16BE },
+    { "S24BE -> S16BE (AAF 24 bit)", SampleConv_S24BE, SampleConv_S16BE },
+    { "S32LE -> S16BE (codec)",      SampleConv_S32LE, SampleConv_S16BE },
+    { "S32BE -> S16BE (AAF 32 bit)", SampleConv_S32BE, SampleConv_S16BE },
+    { "S16BE -> S32LE (codec)",      SampleConv_S16BE, SampleConv_S32LE },
+    { "S32LE -> S32BE",              SampleConv_S32LE, SampleConv_S32BE },
+    { "S16LE -> S24BE (generic)",    SampleConv_S16LE, SampleConv_S24BE },
+};
+
+static uint8_t src[SAMPLES * 4];
+static uint8_t dst[SAMPLES * 4];
+static uint8_t ref[SAMPLES * 4];
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int IsLittleEndian(SampleConv_Format_t f)
+{
+    return SampleConv_S16LE == f || SampleConv_S24LE == f || SampleConv_S32LE == f;
+}
+
+/* Straight forward per byte conversion, as the audio sources did it before */
+static void Reference(uint8_t *pDst, SampleConv_Format_t dstFormat, const uint8_t *pSrc, SampleConv_Format_t srcFormat, uint32_t samples)
+{
+    uint8_t srcSize = SampleConv_GetSampleSize(srcFormat);
+    uint8_t dstSize = SampleConv_GetSampleSize(dstFormat);
+    uint32_t s;
+    uint8_t i;
+    for (s = 0; s < samples; s++)
+    {
+        for (i = 0; i < dstSize; i++)
+        {
+            uint8_t b = (i < srcSize) ? pSrc[IsLittleEndian(srcFormat) ? srcSize - 1 - i : i] : 0;
+            pDst[IsLittleEndian(dstFormat) ? dstSize - 1 - i : i] = b;
+        }
+        pSrc += srcSize;
+        pDst += dstSize;
+    }
+}
+
+int main(void)
+{
+    uint32_t i, c;
+    int errors = 0;
+    for (i = 0; i < sizeof(src); i++)
+        src[i] = (uint8_t)rand();
+    printf("%-30s %13s %13s %8s\n", "conversion", "ref ns/smp", "kernel ns/smp", "speedup");
+    for (c = 0; c < sizeof(cases) / sizeof(cases[0]); c++)
+    {
+        double t0, tRef, tKernel;
+        uint32_t it;
+        Reference(ref, cases[c].dst, src, cases[c].src, SAMPLES);
+        SampleConv_Convert(dst, cases[c].dst, src, cases[c].src, SAMPLES);
+        if (0 != memcmp(dst, ref, SAMPLES * SampleConv_GetSampleSize(cases[c].dst)))
+        {
+            printf("%-30s MISMATCH\n", cases[c].name);
+            errors++;
+            continue;
+        }
+        t0 = Now();
+        for (it = 0; it < ITERATIONS; it++)
+            Reference(ref, cases[c].dst, src, cases[c].src, SAMPLES);
+        tRef = Now() - t0;
+        t0 = Now();
+        for (it = 0; it < ITERATIONS; it++)
+            SampleConv_Convert(dst, cases[c].dst, src, cases[c].src, SAMPLES);
+        tKernel = Now() - t0;
+        printf("%-30s %13.3f %13.3f %7.1fx\n", cases[c].name,
+            tRef * 1e9 / ((double)SAMPLES * ITERATIONS),
+            tKernel * 1e9 / ((double)SAMPLES * ITERATIONS), tRef / tKernel);
+    }
+    return errors;
+}
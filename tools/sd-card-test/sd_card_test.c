@@ -0,0 +1,285 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Host Test for the SD Card File System Layer                                                    */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Writes a small FAT32 image with a fragmented file and
+ *         reads it back through audio-source/samv71-ucs/src/driver/
+ *         sdcard/fat32.c on top of the host block device
+ *         sd_card_file.c, once as super floppy and once behind a
+ *         MBR. Build and run on the host from the repository root:
+ *
+ *         gcc -O2 -DSDCARD_FILE_BACKEND \
+ *             -Iaudio-source/samv71-ucs/src/driver/sdcard \
+ *             tools/sd-card-test/sd_card_test.c \
+ *             audio-source/samv71-ucs/src/driver/sdcard/fat32.c \
+ *             audio-source/samv71-ucs/src/driver/sdcard/sd_card_file.c \
+ *             -o sd_card_test && ./sd_card_test
+ */
+/*----------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "sd_card.h"
+#include "fat32.h"
+
+#define IMAGE_PATH          "sd_card_test.img"
+#define SECTORS_PER_CLUSTER (2)
+#define RESERVED_SECTORS    (32)
+#define NUM_FATS            (2)
+#define FAT_SECTORS         (1)
+#define DATA_CLUSTERS       (48)
+#define CLUSTER_BYTES       (SECTORS_PER_CLUSTER * SDCARD_BLOCK_SIZE)
+#define VOLUME_BLOCKS       (RESERVED_SECTORS + NUM_FATS * FAT_SECTORS + DATA_CLUSTERS * SECTORS_PER_CLUSTER)
+#define ROOT_CLUSTER        (2)
+#define ROOT_CLUSTER_NEXT   (9)
+#define FILE_SIZE           (9 * CLUSTER_BYTES + 300)
+#define FAT_EOC             (0x0FFFFFFFu)
+
+typedef struct
+{
+    const char *name;
+    uint32_t volumeLba;         /**< 0 for a super floppy, otherwise the start of the first MBR partition */
+} Scenario_t;
+
+static const Scenario_t scenarios[] =
+{
+    { "super floppy", 0 },
+    { "MBR partition", 63 },
+};
+
+/* Cluster chain of the test file, deliberately out of order and not contiguous */
+static const uint32_t fileChain[] = { 3, 4, 5, 12, 11, 20, 21, 22, 30, 40 };
+
+static SDCARD_BUFFER uint8_t buf[SDCARD_MAX_MULTI_BLOCK * SDCARD_BLOCK_SIZE];
+
+static void Put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void Put32(uint8_t *p, uint32_t v)
+{
+    Put16(p, (uint16_t)v);
+    Put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint8_t Pattern(uint32_t offset)
+{
+    /* Includes the block number, so a block read from the wrong place never matches */
+    return (uint8_t)(offset * 31 + (offset >> 9));
+}
+
+static void PutDirEntry(uint8_t *p, const char *shortName, uint8_t attr, uint32_t cluster, uint32_t size)
+{
+    memcpy(p, shortName, 11);
+    p[11] = attr;
+    Put16(&p[20], (uint16_t)(cluster >> 16));
+    Put16(&p[26], (uint16_t)cluster);
+    Put32(&p[28], size);
+}
+
+static int WriteImage(const Scenario_t *s)
+{
+    uint32_t blocks = s->volumeLba + VOLUME_BLOCKS;
+    uint8_t *img = calloc(blocks, SDCARD_BLOCK_SIZE);
+    uint8_t *vol;
+    uint8_t *fat;
+    uint8_t *root;
+    uint32_t i, f;
+    FILE *fp;
+    int ok;
+    if (NULL == img)
+        return 0;
+    vol = &img[s->volumeLba * SDCARD_BLOCK_SIZE];
+    if (0 != s->volumeLba)
+    {
+        uint8_t *entry = &img[0x1BE];
+        entry[4] = 0x0C;
+        Put32(&entry[8], s->volumeLba);
+        Put32(&entry[12], VOLUME_BLOCKS);
+        img[510] = 0x55;
+        img[511] = 0xAA;
+    }
+    vol[0] = 0xEB;
+    vol[1] = 0x58;
+    vol[2] = 0x90;
+    memcpy(&vol[3], "MSWIN4.1", 8);
+    Put16(&vol[11], SDCARD_BLOCK_SIZE);
+    vol[13] = SECTORS_PER_CLUSTER;
+    Put16(&vol[14], RESERVED_SECTORS);
+    vol[16] = NUM_FATS;
+    Put32(&vol[36], FAT_SECTORS);
+    Put32(&vol[44], ROOT_CLUSTER);
+    memcpy(&vol[82], "FAT32   ", 8);
+    vol[510] = 0x55;
+    vol[511] = 0xAA;
+
+    /* Only the first FAT is read, the second one stays empty */
+    fat = &vol[RESERVED_SECTORS * SDCARD_BLOCK_SIZE];
+    Put32(&fat[0], 0x0FFFFFF8);
+    Put32(&fat[4], FAT_EOC);
+    Put32(&fat[ROOT_CLUSTER * 4], ROOT_CLUSTER_NEXT);
+    Put32(&fat[ROOT_CLUSTER_NEXT * 4], FAT_EOC);
+    for (i = 0; i < sizeof(fileChain) / sizeof(fileChain[0]); i++)
+    {
+        uint32_t next = (i + 1 < sizeof(fileChain) / sizeof(fileChain[0])) ? fileChain[i + 1] : FAT_EOC;
+        /* The upper four bits are reserved and must be ignored by the reader */
+        if (12 == fileChain[i])
+            next |= 0xF0000000u;
+        Put32(&fat[fileChain[i] * 4], next);
+    }
+
+    /* The first root cluster holds only entries, which must be skipped, the file is found in the second one */
+    root = &vol[(RESERVED_SECTORS + NUM_FATS * FAT_SECTORS) * SDCARD_BLOCK_SIZE];
+    PutDirEntry(&root[0], "SDCARD     ", 0x08, 0, 0);
+    PutDirEntry(&root[32], "B\0e\0a\0t\0.\0w", 0x0F, 0, 0);
+    PutDirEntry(&root[64], "\xE5" "EAT    WAV", 0x20, 7, FILE_SIZE);
+    PutDirEntry(&root[96], "BEAT       ", 0x10, 6, 0);
+    for (i = 128; i < CLUSTER_BYTES; i += 32)
+        root[i] = 0xE5;
+    root += (ROOT_CLUSTER_NEXT - ROOT_CLUSTER) * CLUSTER_BYTES;
+    PutDirEntry(&root[0], "BEAT    WAV", 0x20, fileChain[0], FILE_SIZE);
+
+    for (f = 0; f < FILE_SIZE; f++)
+    {
+        uint32_t cluster = fileChain[f / CLUSTER_BYTES];
+        uint8_t *data = &vol[(RESERVED_SECTORS + NUM_FATS * FAT_SECTORS) * SDCARD_BLOCK_SIZE];
+        data[(cluster - ROOT_CLUSTER) * CLUSTER_BYTES + f % CLUSTER_BYTES] = Pattern(f);
+    }
+
+    fp = fopen(IMAGE_PATH, "wb");
+    ok = (NULL != fp && blocks == fwrite(img, SDCARD_BLOCK_SIZE, blocks, fp));
+    if (NULL != fp)
+        fclose(fp);
+    free(img);
+    return ok;
+}
+
+static int RunScenario(const Scenario_t *s)
+{
+    Fat32_File_t file;
+    uint32_t offset = 0;
+    uint32_t firstLba = 0;
+    uint32_t lba;
+    uint32_t count;
+    int errors = 0;
+    if (!WriteImage(s) || !SDCard_Init())
+    {
+        printf("%-14s FAIL: image could not be written or opened\n", s->name);
+        return 1;
+    }
+    if (s->volumeLba + VOLUME_BLOCKS != SDCard_GetBlockCount() || !Fat32_Mount())
+    {
+        printf("%-14s FAIL: mount\n", s->name);
+        return 1;
+    }
+    if (Fat32_Open(&file, "missing.wav") || Fat32_Open(&file, "beat"))
+    {
+        printf("%-14s FAIL: opened a missing file or a directory\n", s->name);
+        errors++;
+    }
+    if (!Fat32_Open(&file, "beat.wav") || FILE_SIZE != file.size)
+    {
+        printf("%-14s FAIL: open\n", s->name);
+        return errors + 1;
+    }
+    while (0 != (count = Fat32_MapBlocks(&file, offset, &lba)))
+    {
+        uint32_t len;
+        uint32_t i;
+        if (SECTORS_PER_CLUSTER < count)
+        {
+            printf("%-14s FAIL: %lu blocks mapped across a cluster boundary\n", s->name, (unsigned long)count);
+            errors++;
+            break;
+        }
+        if (0 == offset)
+            firstLba = lba;
+        if (!SDCard_StartRead(lba, (uint16_t)count, buf) || SDCard_State_Idle != SDCard_GetState())
+        {
+            printf("%-14s FAIL: read of block %lu\n", s->name, (unsigned long)lba);
+            errors++;
+            break;
+        }
+        len = count * SDCARD_BLOCK_SIZE;
+        if (len > FILE_SIZE - offset)
+            len = FILE_SIZE - offset;
+        for (i = 0; i < len && Pattern(offset + i) == buf[i]; i++);
+        if (i != len)
+        {
+            printf("%-14s FAIL: data mismatch at file offset %lu\n", s->name, (unsigned long)(offset + i));
+            errors++;
+            break;
+        }
+        offset += count * SDCARD_BLOCK_SIZE;
+    }
+    if (0 == errors && (offset < FILE_SIZE || offset - FILE_SIZE >= SDCARD_BLOCK_SIZE))
+    {
+        printf("%-14s FAIL: mapped %lu of %lu bytes\n", s->name, (unsigned long)offset, (unsigned long)FILE_SIZE);
+        errors++;
+    }
+    /* Seeking backwards restarts the cluster walk */
+    if (0 == Fat32_MapBlocks(&file, 0, &lba) || lba != firstLba)
+    {
+        printf("%-14s FAIL: seek back to the file start\n", s->name);
+        errors++;
+    }
+    if (SDCard_StartRead(SDCard_GetBlockCount() - 1, 2, buf))
+    {
+        printf("%-14s FAIL: read beyond the end of the card\n", s->name);
+        errors++;
+    }
+    if (0 == errors)
+        printf("%-14s %lu bytes in %u clusters read\n", s->name, (unsigned long)FILE_SIZE,
+            (unsigned)(sizeof(fileChain) / sizeof(fileChain[0])));
+    return errors;
+}
+
+int main(void)
+{
+    int errors = 0;
+    uint32_t i;
+    setenv("SDCARD_IMAGE", IMAGE_PATH, 1);
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+        errors += RunScenario(&scenarios[i]);
+    remove(IMAGE_PATH);
+    setenv("SDCARD_IMAGE", IMAGE_PATH ".missing", 1);
+    if (SDCard_Init() || 0 != SDCard_GetBlockCount())
+    {
+        printf("FAIL: missing image reported as card\n");
+        errors++;
+    }
+    printf(0 == errors ? "PASS\n" : "FAILED\n");
+    return errors;
+}
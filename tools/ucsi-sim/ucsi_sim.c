@@ -0,0 +1,223 @@
+/*------------------------------------------------------------------------------------------------*/
+/* Host Simulation of UCSI on a Full Ring                                                         */
+/* Copyright 2018, Microchip Technology Inc. and its subsidiaries.                                */
+/*                                                                                                */
+/* Redistribution and use in source and binary forms, with or without                             */
+/* modification, are permitted provided that the following conditions are met:                    */
+/*                                                                                                */
+/* 1. Redistributions of source code must retain the above copyright notice, this                 */
+/*    list of conditions and the following disclaimer.                                            */
+/*                                                                                                */
+/* 2. Redistributions in binary form must reproduce the above copyright notice,                   */
+/*    this list of conditions and the following disclaimer in the documentation                   */
+/*    and/or other materials provided with the distribution.                                      */
+/*                                                                                                */
+/* 3. Neither the name of the copyright holder nor the names of its                               */
+/*    contributors may be used to endorse or promote products derived from                        */
+/*    this software without specific prior written permission.                                    */
+/*                                                                                                */
+/* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"                    */
+/* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE                      */
+/* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE                 */
+/* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE                   */
+/* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL                     */
+/* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR                     */
+/* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER                     */
+/* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,                  */
+/* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE                  */
+/* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                           */
+/*------------------------------------------------------------------------------------------------*/
+
+/*----------------------------------------------------------*/
+/*! \file
+ *  \brief Runs UCSI with 64 nodes and 63 routes against stubs of
+ *         the UNICENS API. Each route is reported built after a
+ *         simulated delay, and the test checks that UCSI reports
+ *         the whole configuration built after the expected time.
+ *         It also measures the host time UCSI spends on the run.
+ *         Needs the UNICENS submodule for its headers, the library
+ *         itself is replaced by the stubs below. Build and run on
+ *         the host from the repository root:
+ *
+ *         U=audio-source/samv71-ucs/libraries
+ *         gcc -O2 -I$U/ucsi -I$U/unicens/ucs2/inc \
+ *             -I$U/unicens/cfg-daemon -Iaudio-source/samv71-ucs/utils/md5 \
+ *             tools/ucsi-sim/ucsi_sim.c $U/ucsi/ucsi_impl.c \
+ *             $U/ucsi/ucsi_print.c $U/ucsi/ucsi_collision.c \
+ *             $U/ucsi/ucsi_index.c $U/ucsi/ucsi_fingerprint.c \
+ *             audio-source/samv71-ucs/utils/md5/md5.c \
+ *             -o ucsi_sim && ./ucsi_sim
+ */
+/*----------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include "ucsi_api.h"
+
+#define NODES               (64)
+#define ROUTES              (NODES - 1)
+#define ROUTE_BUILD_MS      (37)    /**< Simulated time UNICENS needs to build one route */
+
+typedef void (*InitResultCb_t)(Ucs_InitResult_t result, void *user_ptr);
+typedef void (*NetworkStatusCb_t)(uint16_t change_mask, uint16_t events, Ucs_Network_Availability_t availability,
+    Ucs_Network_AvailInfo_t avail_info, Ucs_Network_AvailTransCause_t avail_trans_cause, uint16_t node_address,
+    uint8_t max_position, uint16_t packet_bw, void *user_ptr);
+typedef void (*RouteReportCb_t)(Ucs_Rm_Route_t *route_ptr, Ucs_Rm_RouteInfos_t route_infos, void *user_ptr);
+
+static UCSI_Data_t ucsi;
+static uint16_t simTime;
+static InitResultCb_t initResultCb;
+static uint32_t routeRequests;
+static int32_t reportedBuildMs = -1;
+static int32_t reportedRoutes = -1;
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         UNICENS API STUBS                            */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+Ucs_Inst_t *Ucs_CreateInstance(void) { return (Ucs_Inst_t *)&ucsi; }
+Ucs_Return_t Ucs_SetDefaultConfig(Ucs_InitData_t *init_ptr) { memset(init_ptr, 0, sizeof(*init_ptr)); return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Init(Ucs_Inst_t *self, const Ucs_InitData_t *init_ptr, InitResultCb_t init_result_fptr) { initResultCb = init_result_fptr; return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Stop(Ucs_Inst_t *self, void (*stopped_fptr)(Ucs_StdResult_t, void *)) { return UCS_RET_SUCCESS; }
+void Ucs_Service(Ucs_Inst_t *self) {}
+void Ucs_ReportTimeout(Ucs_Inst_t *self) {}
+Ucs_Return_t Ucs_Rm_SetRouteActive(Ucs_Inst_t *self, Ucs_Rm_Route_t *route_ptr, bool active) { routeRequests++; return UCS_RET_SUCCESS; }
+uint16_t Ucs_Rm_GetConnectionLabel(Ucs_Inst_t *self, Ucs_Rm_Route_t *route_ptr) { return 0; }
+Ucs_Return_t Ucs_Ns_Run(Ucs_Inst_t *self, uint16_t node_address, Ucs_Ns_Script_t *script_list_ptr, uint8_t script_list_size,
+    void (*result_fptr)(uint16_t, Ucs_Ns_ResultCode_t, Ucs_Ns_ErrorInfo_t, void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Gpio_CreatePort(Ucs_Inst_t *self, uint16_t node_address, uint8_t index, uint16_t debounce_time,
+    void (*result_fptr)(uint16_t, uint16_t, Ucs_Gpio_Result_t, void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Gpio_WritePort(Ucs_Inst_t *self, uint16_t node_address, uint16_t port_handle, uint16_t mask, uint16_t data,
+    void (*result_fptr)(uint16_t, uint16_t, uint16_t, uint16_t, Ucs_Gpio_Result_t, void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_I2c_WritePort(Ucs_Inst_t *self, uint16_t node_address, uint16_t port_handle, Ucs_I2c_TrMode_t mode, uint8_t block_count,
+    uint8_t slave_address, uint16_t timeout, uint8_t data_len, uint8_t *data_ptr,
+    void (*result_fptr)(uint16_t, uint16_t, uint8_t, uint8_t, Ucs_I2c_Result_t, void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_I2c_ReadPort(Ucs_Inst_t *self, uint16_t node_address, uint16_t port_handle, uint8_t slave_address, uint8_t data_len,
+    uint16_t timeout, void (*result_fptr)(uint16_t, uint16_t, uint8_t, uint8_t, uint8_t[], Ucs_I2c_Result_t, void *)) { return UCS_RET_SUCCESS; }
+Ucs_AmsTx_Msg_t *Ucs_AmsTx_AllocMsg(Ucs_Inst_t *self, uint16_t data_size) { return NULL; }
+Ucs_Return_t Ucs_AmsTx_SendMsg(Ucs_Inst_t *self, Ucs_AmsTx_Msg_t *msg_ptr,
+    void (*tx_complete_fptr)(Ucs_AmsTx_Msg_t *, Ucs_AmsTx_Result_t, Ucs_AmsTx_Info_t, void *)) { return UCS_RET_SUCCESS; }
+void Ucs_AmsTx_FreeUnusedMsg(Ucs_Inst_t *self, Ucs_AmsTx_Msg_t *msg_ptr) {}
+Ucs_AmsRx_Msg_t *Ucs_AmsRx_PeekMsg(Ucs_Inst_t *self) { return NULL; }
+void Ucs_AmsRx_ReleaseMsg(Ucs_Inst_t *self) {}
+Ucs_Return_t Ucs_Prog_IS_RAM(Ucs_Inst_t *self, Ucs_Signature_t *signature, Ucs_IdentString_t *ident_string,
+    void (*result_fptr)(Ucs_Prg_ResCode_t, Ucs_Prg_Func_t, uint8_t, uint8_t[], void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Prog_IS_ROM(Ucs_Inst_t *self, Ucs_Signature_t *signature, Ucs_IdentString_t *ident_string,
+    void (*result_fptr)(Ucs_Prg_ResCode_t, Ucs_Prg_Func_t, uint8_t, uint8_t[], void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Nd_Start(Ucs_Inst_t *self) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Nd_Stop(Ucs_Inst_t *self) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Nd_InitAll(Ucs_Inst_t *self) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Network_Startup(Ucs_Inst_t *self, uint16_t packet_bw, uint16_t forced_na_timeout,
+    void (*result_fptr)(Ucs_StdResult_t, void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Network_Shutdown(Ucs_Inst_t *self, void (*result_fptr)(Ucs_StdResult_t, void *)) { return UCS_RET_SUCCESS; }
+Ucs_Return_t Ucs_Network_SetPacketFilterMode(Ucs_Inst_t *self, uint16_t node_address, uint16_t mode,
+    void (*result_fptr)(uint16_t, Ucs_StdResult_t, void *)) { return UCS_RET_SUCCESS; }
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         UCSI CALLBACKS                               */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+uint16_t UCSI_CB_OnGetTime(void *pTag) { return simTime; }
+
+void UCSI_CB_OnUserMessage(void *pTag, bool isError, const char format[], uint16_t vargsCnt, ...)
+{
+    va_list argptr;
+    va_start(argptr, vargsCnt);
+    if (0 == strcmp(format, "All %d routes built %d ms after network available"))
+    {
+        reportedRoutes = va_arg(argptr, int);
+        reportedBuildMs = va_arg(argptr, int);
+    }
+    else if (isError)
+    {
+        printf("UCSI error: ");
+        vprintf(format, argptr);
+        printf("\n");
+    }
+    va_end(argptr);
+}
+
+void UCSI_CB_OnCommandResult(void *pTag, UnicensCmd_t command, bool success, uint16_t nodeAddress) {}
+void UCSI_CB_OnSetServiceTimer(void *pTag, uint16_t timeout) {}
+void UCSI_CB_OnNetworkState(void *pTag, bool isAvailable, uint16_t packetBandwidth, uint8_t amountOfNodes) {}
+void UCSI_CB_OnPrintRouteTable(void *pTag, const char pString[]) {}
+void UCSI_CB_OnServiceRequired(void *pTag) {}
+void UCSI_CB_OnResetInic(void *pTag) {}
+void UCSI_CB_OnResetControlChannel(void *pTag) {}
+void UCSI_CB_OnTxRequest(void *pTag, const uint8_t *pPayload, uint32_t payloadLen) {}
+void UCSI_CB_OnStart(void *pTag) {}
+void UCSI_CB_OnStop(void *pTag) {}
+void UCSI_CB_OnAmsMessageReceived(void *pTag) {}
+void UCSI_CB_OnRouteResult(void *pTag, uint16_t routeId, bool isActive, uint16_t connectionLabel) {}
+void UCSI_CB_OnGpioStateChange(void *pTag, uint16_t nodeAddress, uint8_t gpioPinId, bool isHighState) {}
+void UCSI_CB_OnMgrReport(void *pTag, Ucs_MgrReport_t code, Ucs_Signature_t *signature, Ucs_Rm_Node_t *pNode) {}
+void UCSI_CB_OnProgrammingDone(void *pTag, bool changed) {}
+void UCSI_CB_OnI2CRead(void *pTag, bool success, uint16_t targetAddress, uint8_t slaveAddr, const uint8_t *pBuffer, uint32_t bufLen) {}
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+/*                         SIMULATION                                   */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>*/
+
+static double Now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(void)
+{
+    static Ucs_Signature_t signatures[NODES];
+    static Ucs_Rm_Node_t nodes[NODES];
+    static Ucs_Rm_EndPoint_t endpoints[NODES];
+    static Ucs_Rm_Route_t routes[ROUTES];
+    const int32_t expectedMs = ROUTES * ROUTE_BUILD_MS;
+    double start;
+    int errors = 0;
+    uint32_t i;
+    /* One source on the timing master, one sink on every other node */
+    for (i = 0; i < NODES; i++)
+    {
+        signatures[i].node_address = 0x200 + i;
+        nodes[i].signature_ptr = &signatures[i];
+        endpoints[i].endpoint_type = (0 == i) ? UCS_RM_EP_SOURCE : UCS_RM_EP_SINK;
+        endpoints[i].node_obj_ptr = &nodes[i];
+    }
+    for (i = 0; i < ROUTES; i++)
+    {
+        routes[i].source_endpoint_ptr = &endpoints[0];
+        routes[i].sink_endpoint_ptr = &endpoints[i + 1];
+        routes[i].active = 1;
+        routes[i].route_id = 0x10 + i;
+    }
+    start = Now();
+    UCSI_Init(&ucsi, &ucsi);
+    if (!UCSI_NewConfig(&ucsi, 0, routes, ROUTES, nodes, NODES))
+    {
+        printf("FAILED: UCSI_NewConfig rejected %d nodes and %d routes\n", NODES, ROUTES);
+        return 1;
+    }
+    UCSI_Service(&ucsi);
+    initResultCb(UCS_INIT_RES_SUCCESS, &ucsi);
+    UCSI_Service(&ucsi);
+    simTime = 1000;
+    ((NetworkStatusCb_t)ucsi.uniInitData.network.status.cb_fptr)(0, 0, UCS_NW_AVAILABLE, 0, 0, 1, NODES - 1, 52, &ucsi);
+    for (i = 0; i < ROUTES; i++)
+    {
+        simTime += ROUTE_BUILD_MS;
+        /* Report in a scattered order, UNICENS builds routes of different nodes in parallel */
+        ((RouteReportCb_t)ucsi.uniInitData.rm.report_fptr)(&routes[(i * 17) % ROUTES], UCS_RM_ROUTE_INFOS_BUILT, &ucsi);
+        UCSI_Service(&ucsi);
+    }
+    printf("%d nodes, %d routes: UCSI reported %d routes built after %d ms (expected %d ms), %.1f us on the host\n",
+        NODES, ROUTES, (int)reportedRoutes, (int)reportedBuildMs, (int)expectedMs, (Now() - start) * 1e6);
+    if (ROUTES != reportedRoutes || expectedMs != reportedBuildMs)
+    {
+        printf("  FAIL: route build time not reported as expected\n");
+        errors++;
+    }
+    printf(0 == errors ? "PASS\n" : "FAILED\n");
+    return errors;
+}
@@ -0,0 +1,668 @@
+#!/usr/bin/env python3
+#
+# Portable replacement for xml2struct.exe, the UNICENS network configuration
+# compiler. Reads audio-source/config.xml, validates it against the element,
+# attribute and value rules of unicens.xsd, and prints the Ucs_Xrm_* / Ucs_Rm_*
+# tables of src/default_config.c in the same layout as the Windows tool:
+#
+#   python3 tools/xml2struct/xml2struct.py audio-source/config.xml > audio-source/samv71-ucs/src/default_config.c
+#   python3 tools/xml2struct/xml2struct.py --check audio-source/samv71-ucs/src/default_config.c audio-source/config.xml
+#
+# A summary with the XRM job count, the script message count and the
+# estimated bandwidth of every route goes to stderr. Use --quiet to omit it.
+#
+# Consecutive I2CPortWrite elements of a script, which address the same slave
+# with the same timeout and block length, are merged into one burst. Each block
+# is still a separate I2C message to the slave, but the node needs only one
+# INIC round trip for all of them. Use --no-merge to keep them as written.
+#
+# --synthetic N prints a configuration with one source and N sink nodes, to
+# generate and benchmark large topologies. N is at most 63, the source node
+# counts against the 64 nodes the firmware handles:
+#
+#   python3 tools/xml2struct/xml2struct.py --synthetic 63 > big.xml
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+import xml.parsers.expat as expat
+
+VERSION = '1.0.0'
+XS = '{http://www.w3.org/2001/XMLSchema}'
+DEFAULT_SCHEMA = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'audio-source', 'unicens.xsd')
+
+# Network frame, see the INIC hardware data sheet. Sync and packet bandwidth share it
+FRAME_RATE = 48000
+FRAME_BYTES = {'INICnet-150': 372, 'MOST150': 372}
+# Data bytes of one I2C script message, same limit as I2C_WRITE_MAX_LEN of the UCSI
+I2C_WRITE_MAX_LEN = 32
+I2C_BURST_MAX_BLOCKS = 30
+# Remote nodes the firmware can handle, UCS_NUM_REMOTE_DEVICES of ucs_cfg.h (MAX_NODES of the UCSI minus the local node)
+MAX_REMOTE_NODES = 63
+I2C_DEFAULT_TIMEOUT = 100
+
+INIC_FBLOCK = 0x00
+INIC_INST = 0x01
+OP_START_RESULT = 0x02
+OP_RESULT = 0x0C
+FKT_GPIO_PORT_CREATE = 0x0701
+FKT_GPIO_PORT_PIN_MODE = 0x0703
+FKT_GPIO_PIN_STATE = 0x0704
+FKT_I2C_PORT_CREATE = 0x06C1
+FKT_I2C_PORT_READ = 0x06C3
+FKT_I2C_PORT_WRITE = 0x06C4
+GPIO_PORT_HANDLE = (0x1D, 0x00)
+I2C_PORT_HANDLE = (0x0F, 0x00)
+NW_PORT_HANDLE = '0x0D00'
+
+I2C_SPEED = {'SlowMode': 0, 'FastMode': 1}
+I2C_MODE = {'DefaultMode': 0, 'RepeatedStartMode': 1, 'BurstMode': 2}
+MUTE_MODE = {'NoMuting': 'UCS_SYNC_MUTE_MODE_NO_MUTING', 'MuteSignal': 'UCS_SYNC_MUTE_MODE_MUTE_SIGNAL'}
+STRM_CLOCK = {'8Fs': 'UCS_STREAM_PORT_CLK_CFG_8FS', '16fs': 'UCS_STREAM_PORT_CLK_CFG_16FS',
+              '32Fs': 'UCS_STREAM_PORT_CLK_CFG_32FS', '64Fs': 'UCS_STREAM_PORT_CLK_CFG_64FS',
+              '128Fs': 'UCS_STREAM_PORT_CLK_CFG_128FS', '256Fs': 'UCS_STREAM_PORT_CLK_CFG_256FS',
+              '512Fs': 'UCS_STREAM_PORT_CLK_CFG_512FS', 'Willdcard': 'UCS_STREAM_PORT_CLK_CFG_WILD'}
+STRM_ALIGN = {'Left16Bit': 'UCS_STREAM_PORT_ALGN_LEFT16BIT', 'Left24Bit': 'UCS_STREAM_PORT_ALGN_LEFT24BIT',
+              'Right16Bit': 'UCS_STREAM_PORT_ALGN_RIGHT16BIT', 'Right24Bit': 'UCS_STREAM_PORT_ALGN_RIGHT24BIT',
+              'Seq': 'UCS_STREAM_PORT_ALGN_SEQ', 'TDM16Bit': 'UCS_STREAM_PORT_ALGN_TDM16BIT',
+              'TDM24Bit': 'UCS_STREAM_PORT_ALGN_TDM24BIT'}
+MLB_CLOCK = {'256Fs': 'UCS_MLB_CLK_CFG_256_FS', '512Fs': 'UCS_MLB_CLK_CFG_512_FS',
+             '1024Fs': 'UCS_MLB_CLK_CFG_1024_FS', '2048Fs': 'UCS_MLB_CLK_CFG_2048_FS',
+             '3072Fs': 'UCS_MLB_CLK_CFG_3072_FS', '4096Fs': 'UCS_MLB_CLK_CFG_4096_FS',
+             '6114Fs': 'UCS_MLB_CLK_CFG_6144_FS', '8192Fs': 'UCS_MLB_CLK_CFG_8192_FS'}
+USB_PHY = {'Standard': 'UCS_USB_PHY_LAYER_STANDARD', 'HSIC': 'UCS_USB_PHY_LAYER_HSCI'}
+ISOC_SIZE = {'188': 'UCS_ISOC_PCKT_SIZE_188', '196': 'UCS_ISOC_PCKT_SIZE_196', '206': 'UCS_ISOC_PCKT_SIZE_206'}
+DATA_TYPE = {
+    'SyncConnection': {'NetworkSocket': 'UCS_NW_SCKT_SYNC_DATA', 'MediaLBSocket': 'UCS_MLB_SCKT_SYNC_DATA',
+                       'USBSocket': 'UCS_USB_SCKT_SYNC_DATA', 'StreamSocket': 'UCS_STREAM_PORT_SCKT_SYNC_DATA'},
+    'AVPConnection': {'NetworkSocket': 'UCS_NW_SCKT_AV_PACKETIZED', 'MediaLBSocket': 'UCS_MLB_SCKT_AV_PACKETIZED',
+                      'USBSocket': 'UCS_USB_SCKT_AV_PACKETIZED'},
+}
+
+
+class ConfigError(Exception):
+    pass
+
+
+def parse_xml(path):
+    """Parses an XML file and remembers the line of every element for the error messages."""
+    lines = {}
+    builder = ET.TreeBuilder()
+    parser = expat.ParserCreate(namespace_separator='}')
+
+    def start(tag, attrs):
+        # expat reports namespaces as "uri}name", ElementTree expects "{uri}name"
+        fix = lambda name: '{' + name if '}' in name else name
+        elem = builder.start(fix(tag), dict((fix(k), v) for k, v in attrs.items()))
+        lines[elem] = parser.CurrentLineNumber
+
+    parser.StartElementHandler = start
+    parser.EndElementHandler = lambda tag: builder.end(tag)
+    parser.CharacterDataHandler = builder.data
+    try:
+        with open(path, 'rb') as f:
+            parser.Parse(f.read(), True)
+        return builder.close(), lines
+    except expat.ExpatError as e:
+        raise ConfigError('%s: %s' % (path, e))
+    except OSError as e:
+        raise ConfigError(str(e))
+
+
+class Schema:
+    """Checks the elements, attributes and values allowed by unicens.xsd.
+
+    Occurrence limits are not checked here, the compiler reports them with a clearer message."""
+
+    def __init__(self, path):
+        root, _ = parse_xml(path)
+        self.types = {t.get('name'): t for t in root.findall(XS + 'complexType')}
+        self.simple = {t.get('name'): t for t in root.findall(XS + 'simpleType')}
+        self.top = {e.get('name'): e for e in root.findall(XS + 'element')}
+        self.models = {}
+
+    def model(self, decl):
+        if decl not in self.models:
+            attrs, children = {}, {}
+            self.models[decl] = (attrs, children)
+            if decl.get('type') in self.types:
+                self.collect(self.types[decl.get('type')], attrs, children)
+            for ct in decl.findall(XS + 'complexType'):
+                self.collect(ct, attrs, children)
+        return self.models[decl]
+
+    def collect(self, node, attrs, children):
+        for child in node:
+            if XS + 'extension' == child.tag:
+                if child.get('base') in self.types:
+                    self.collect(self.types[child.get('base')], attrs, children)
+                self.collect(child, attrs, children)
+            elif child.tag in (XS + 'complexContent', XS + 'sequence', XS + 'choice', XS + 'all'):
+                self.collect(child, attrs, children)
+            elif XS + 'element' == child.tag:
+                children[child.get('name')] = child
+            elif XS + 'attribute' == child.tag:
+                attrs[child.get('name')] = child
+
+    def value_ok(self, decl, value):
+        kind = decl.get('type')
+        simple = decl.find(XS + 'simpleType')
+        if simple is None and kind in self.simple:
+            simple = self.simple[kind]
+        if simple is not None:
+            restriction = simple.find(XS + 'restriction')
+            if restriction is None:
+                return True
+            kind = restriction.get('base')
+            enums = [e.get('value') for e in restriction.findall(XS + 'enumeration')]
+            if enums and value not in enums:
+                return False
+            for pattern in restriction.findall(XS + 'pattern'):
+                if not re.fullmatch(pattern.get('value').strip('^$'), value):
+                    return False
+        if 'xs:integer' == kind:
+            return re.fullmatch(r'[+-]?[0-9]+', value) is not None
+        if 'xs:boolean' == kind:
+            return value in ('true', 'false', '1', '0')
+        return True
+
+    def validate(self, root, lines):
+        errors = []
+        if root.tag not in self.top:
+            return ['line %d: root element must be one of %s' % (lines[root], ', '.join(self.top))]
+        self.check(root, self.top[root.tag], lines, errors)
+        return errors
+
+    def check(self, elem, decl, lines, errors):
+        attrs, children = self.model(decl)
+        where = 'line %d: %s' % (lines[elem], elem.tag)
+        for name, value in elem.attrib.items():
+            if name.startswith('{'):
+                continue  # xsi:noNamespaceSchemaLocation and friends
+            if name not in attrs:
+                errors.append('%s: unknown attribute %s' % (where, name))
+            elif not self.value_ok(attrs[name], value):
+                errors.append('%s: invalid value %s="%s"' % (where, name, value))
+        for name, adecl in attrs.items():
+            if 'required' == adecl.get('use') and name not in elem.attrib:
+                errors.append('%s: missing attribute %s' % (where, name))
+        for child in elem:
+            if not isinstance(child.tag, str):
+                continue
+            if child.tag not in children:
+                errors.append('line %d: %s is not allowed inside %s' % (lines[child], child.tag, elem.tag))
+            else:
+                self.check(child, children[child.tag], lines, errors)
+
+
+def number(elem, name, default=None):
+    value = elem.get(name)
+    if value is None:
+        if default is None:
+            raise ConfigError('%s: missing attribute %s' % (elem.tag, name))
+        return default
+    return int(value, 0)
+
+
+def hex_data(elem, name):
+    return bytes(int(x, 16) for x in elem.get(name, '').split())
+
+
+class Endpoint:
+    def __init__(self, node, conn, route, is_source):
+        self.node = node
+        self.conn = conn
+        self.route = route
+        self.is_source = is_source
+        self.nw = conn.find('NetworkSocket')
+        self.bandwidth = int(self.nw.get('Bandwidth'))
+        self.prefix = None
+        self.objects = []
+
+    def job_count(self):
+        return len(self.objects)
+
+
+class Compiler:
+    def __init__(self, root, lines, merge):
+        self.root = root
+        self.lines = lines
+        self.merge = merge
+        self.merged = 0
+        self.nodes = [e for e in root if 'Node' == e.tag]
+        self.scripts = {}
+        for script in root.findall('Script'):
+            if script.get('Name') in self.scripts:
+                self.fail(script, 'script "%s" is defined twice' % script.get('Name'))
+            self.scripts[script.get('Name')] = script
+        self.packet_bw = number(root, 'AsyncBandwidth')
+        self.routes = []
+        self.node_scripts = []
+
+    def fail(self, elem, text):
+        raise ConfigError('line %d: %s' % (self.lines.get(elem, 0), text))
+
+    # Routes --------------------------------------------------------------
+
+    def build_routes(self):
+        sources = {}
+        sinks = []
+        seen = {}
+        for node in self.nodes:
+            address = number(node, 'Address')
+            if address in seen:
+                self.fail(node, 'node address 0x%X is used twice' % address)
+            seen[address] = node
+            for conn in node:
+                if conn.tag not in ('SyncConnection', 'AVPConnection'):
+                    continue
+                sockets = [s for s in conn if isinstance(s.tag, str)]
+                if 2 != len(sockets):
+                    self.fail(conn, '%s needs exactly two sockets' % conn.tag)
+                for s in sockets:
+                    if s.tag in ('Splitter', 'Combiner'):
+                        self.fail(s, '%s is not supported by this converter' % s.tag)
+                kinds = [s.tag for s in sockets]
+                if 1 != kinds.count('NetworkSocket'):
+                    self.fail(conn, '%s needs exactly one NetworkSocket' % conn.tag)
+                route = sockets[0].get('Route') if 'NetworkSocket' == kinds[0] else sockets[1].get('Route')
+                ep = Endpoint(node, conn, route, 'NetworkSocket' == kinds[1])
+                if ep.is_source:
+                    if route in sources:
+                        self.fail(conn, 'route "%s" has more than one source' % route)
+                    sources[route] = ep
+                else:
+                    sinks.append(ep)
+        ids = {}
+        for i, sink in enumerate(sinks, 1):
+            if sink.route not in sources:
+                self.fail(sink.conn, 'route "%s" has no source' % sink.route)
+            source = sources[sink.route]
+            if source.bandwidth != sink.bandwidth:
+                self.fail(sink.nw, 'route "%s" uses %d bytes at the source, but %d at the sink' %
+                          (sink.route, source.bandwidth, sink.bandwidth))
+            if source.conn.tag != sink.conn.tag:
+                self.fail(sink.conn, 'route "%s" mixes %s and %s' % (sink.route, source.conn.tag, sink.conn.tag))
+            # Routes without RouteId are numbered from 0x1000 to stay clear of the hand picked ones
+            route_id = number(sink.nw, 'RouteId', 0x1000 + i)
+            if route_id in ids:
+                self.fail(sink.nw, 'route id 0x%04X is used twice' % route_id)
+            ids[route_id] = sink
+            active = sink.nw.get('IsActive', source.nw.get('IsActive', 'true')) in ('true', '1')
+            self.routes.append((i, route_id, active, source, sink))
+        used = set(s.route for s in sinks)
+        for route, source in sources.items():
+            if route not in used:
+                print('warning: line %d: route "%s" has no sink and is dropped' % (self.lines[source.conn], route),
+                      file=sys.stderr)
+
+    def socket_objects(self, ep, sock, direction):
+        node = ep.node
+        prefix = ep.prefix
+        dtype = DATA_TYPE[ep.conn.tag].get(sock.tag)
+        if dtype is None:
+            self.fail(sock, '%s can not be used in an %s' % (sock.tag, ep.conn.tag))
+        if 'NetworkSocket' == sock.tag:
+            name = prefix + '_NetworkSocket'
+            ep.objects.append(('Ucs_Xrm_NetworkSocket_t', name, [
+                'UCS_XRM_RC_TYPE_NW_SOCKET', NW_PORT_HANDLE, direction, dtype, str(ep.bandwidth)]))
+            return name
+        if 'MediaLBSocket' == sock.tag:
+            port = node.find('MediaLBPort')
+            if port is not None:
+                pname = prefix + '_MlbPort'
+                ep.objects.append(('Ucs_Xrm_MlbPort_t', pname, [
+                    'UCS_XRM_RC_TYPE_MLB_PORT', '0', MLB_CLOCK[port.get('ClockConfig')]]))
+            else:
+                pname = prefix + '_DcPort'
+                ep.objects.append(('Ucs_Xrm_DefaultCreatedPort_t', pname, [
+                    'UCS_XRM_RC_TYPE_DC_PORT', 'UCS_XRM_PORT_TYPE_MLB', '0']))
+            name = prefix + '_MlbSocket'
+            ep.objects.append(('Ucs_Xrm_MlbSocket_t', name, [
+                'UCS_XRM_RC_TYPE_MLB_SOCKET', '&' + pname, direction, dtype, sock.get('Bandwidth'),
+                '0x%02X' % number(sock, 'ChannelAddress')]))
+            return name
+        if 'StreamSocket' == sock.tag:
+            port = node.find('StreamPort')
+            if port is None:
+                self.fail(sock, 'node 0x%X has a StreamSocket, but no StreamPort' % number(node, 'Address'))
+            align = STRM_ALIGN[port.get('DataAlignment')]
+            # Both serial ports are created, port B follows the clock of port A
+            ep.objects.append(('Ucs_Xrm_StrmPort_t', prefix + '_StrmPort0', [
+                'UCS_XRM_RC_TYPE_STRM_PORT', '0', STRM_CLOCK[port.get('ClockConfig')], align]))
+            ep.objects.append(('Ucs_Xrm_StrmPort_t', prefix + '_StrmPort1', [
+                'UCS_XRM_RC_TYPE_STRM_PORT', '1', 'UCS_STREAM_PORT_CLK_CFG_WILD', align]))
+            pin = sock.get('StreamPinID')
+            name = prefix + '_StrmSocket'
+            ep.objects.append(('Ucs_Xrm_StrmSocket_t', name, [
+                'UCS_XRM_RC_TYPE_STRM_SOCKET', '&%s_StrmPort%d' % (prefix, 0 if 'A' == pin[3] else 1), direction,
+                dtype, sock.get('Bandwidth'), 'UCS_STREAM_PORT_PIN_ID_' + pin]))
+            return name
+        port = node.find('USBPort')
+        if port is not None:
+            pname = prefix + '_UsbPort'
+            ep.objects.append(('Ucs_Xrm_UsbPort_t', pname, [
+                'UCS_XRM_RC_TYPE_USB_PORT', '0', USB_PHY[port.get('PhysicalLayer')],
+                '0x%04X' % number(port, 'DeviceInterfaces'), str(number(port, 'StreamingIfEpInCount')),
+                str(number(port, 'StreamingIfEpOutCount'))]))
+        else:
+            pname = prefix + '_DcPort'
+            ep.objects.append(('Ucs_Xrm_DefaultCreatedPort_t', pname, [
+                'UCS_XRM_RC_TYPE_DC_PORT', 'UCS_XRM_PORT_TYPE_USB', '0']))
+        name = prefix + '_UsbSocket'
+        ep.objects.append(('Ucs_Xrm_UsbSocket_t', name, [
+            'UCS_XRM_RC_TYPE_USB_SOCKET', '&' + pname, direction, dtype,
+            '0x%02X' % number(sock, 'EndpointAddress'), str(number(sock, 'FramesPerTransaction'))]))
+        return name
+
+    def endpoint_objects(self, ep, number_):
+        ep.prefix = '%sOfRoute%d' % ('Src' if ep.is_source else 'Snk', number_)
+        sockets = [s for s in ep.conn if isinstance(s.tag, str)]
+        sock_in = self.socket_objects(ep, sockets[0], 'UCS_SOCKET_DIR_INPUT')
+        sock_out = self.socket_objects(ep, sockets[1], 'UCS_SOCKET_DIR_OUTPUT')
+        if 'SyncConnection' == ep.conn.tag:
+            ep.objects.append(('Ucs_Xrm_SyncCon_t', ep.prefix + '_SyncCon', [
+                'UCS_XRM_RC_TYPE_SYNC_CON', '&' + sock_in, '&' + sock_out,
+                MUTE_MODE[ep.conn.get('MuteMode', 'NoMuting')], '0']))
+        else:
+            ep.objects.append(('Ucs_Xrm_AvpCon_t', ep.prefix + '_AvpCon', [
+                'UCS_XRM_RC_TYPE_AVP_CON', '&' + sock_in, '&' + sock_out, ISOC_SIZE[ep.conn.get('IsocPacketSize')]]))
+
+    # Scripts -------------------------------------------------------------
+
+    def i2c_write(self, elem):
+        data = hex_data(elem, 'Payload')
+        mode = I2C_MODE[elem.get('Mode', 'DefaultMode')]
+        blocks = number(elem, 'BlockCount', 0)
+        if I2C_MODE['BurstMode'] == mode:
+            if not 1 <= blocks <= I2C_BURST_MAX_BLOCKS:
+                self.fail(elem, 'BlockCount must be 1 to %d in BurstMode' % I2C_BURST_MAX_BLOCKS)
+            block_len = number(elem, 'Length', len(data) // blocks)
+            if block_len * blocks != len(data):
+                self.fail(elem, 'Payload has %d bytes, but BlockCount * Length is %d' % (len(data), block_len * blocks))
+        else:
+            if 0 != blocks:
+                self.fail(elem, 'BlockCount must be 0 unless Mode is BurstMode')
+            block_len = number(elem, 'Length', len(data))
+            if block_len != len(data):
+                self.fail(elem, 'Payload has %d bytes, but Length is %d' % (len(data), block_len))
+        return {'address': number(elem, 'Address'), 'timeout': number(elem, 'Timeout', I2C_DEFAULT_TIMEOUT),
+                'mode': mode, 'blocks': blocks, 'block_len': block_len, 'data': data, 'elem': elem}
+
+    def can_merge(self, a, b):
+        if I2C_MODE['RepeatedStartMode'] in (a['mode'], b['mode']):
+            return False
+        return (a['address'] == b['address'] and a['timeout'] == b['timeout'] and a['block_len'] == b['block_len']
+                and max(a['blocks'], 1) + max(b['blocks'], 1) <= I2C_BURST_MAX_BLOCKS
+                and len(a['data']) + len(b['data']) <= I2C_WRITE_MAX_LEN)
+
+    def script_messages(self, script):
+        ops = []
+        for elem in script:
+            if not isinstance(elem.tag, str):
+                continue
+            if 'I2CPortWrite' == elem.tag:
+                w = self.i2c_write(elem)
+                if self.merge and ops and 'I2CPortWrite' == ops[-1][0] and self.can_merge(ops[-1][1], w):
+                    prev = ops[-1][1]
+                    prev['blocks'] = max(prev['blocks'], 1) + max(w['blocks'], 1)
+                    prev['mode'] = I2C_MODE['BurstMode']
+                    prev['data'] += w['data']
+                    self.merged += 1
+                    continue
+                ops.append(('I2CPortWrite', w))
+            else:
+                ops.append((elem.tag, elem))
+        msgs = []
+        pause = 0
+        for kind, op in ops:
+            if 'Pause' == kind:
+                pause += number(op, 'WaitTime')
+                continue
+            fkt, payload, op_resp, payload_resp, fblock = None, None, OP_RESULT, b'', INIC_FBLOCK
+            op_req = OP_START_RESULT
+            if 'I2CPortCreate' == kind:
+                fkt, payload = FKT_I2C_PORT_CREATE, bytes((0x00, 0x00, 0x01, I2C_SPEED[op.get('Speed')]))
+            elif 'I2CPortWrite' == kind:
+                length = op['block_len'] if I2C_MODE['BurstMode'] == op['mode'] else len(op['data'])
+                fkt = FKT_I2C_PORT_WRITE
+                payload = bytes(I2C_PORT_HANDLE + (op['mode'], op['blocks'], op['address'], length,
+                                                   op['timeout'] >> 8, op['timeout'] & 0xFF)) + op['data']
+            elif 'I2CPortRead' == kind:
+                timeout = number(op, 'Timeout', I2C_DEFAULT_TIMEOUT)
+                fkt = FKT_I2C_PORT_READ
+                payload = bytes(I2C_PORT_HANDLE + (number(op, 'Address'), number(op, 'Length'),
+                                                   timeout >> 8, timeout & 0xFF))
+            elif 'GPIOPortCreate' == kind:
+                debounce = number(op, 'DebounceTime')
+                fkt, payload = FKT_GPIO_PORT_CREATE, bytes((0x00, debounce >> 8, debounce & 0xFF))
+            elif 'GPIOPortPinMode' == kind:
+                fkt, payload = FKT_GPIO_PORT_PIN_MODE, bytes(GPIO_PORT_HANDLE) + hex_data(op, 'PinConfiguration')
+            elif 'GPIOPinState' == kind:
+                mask, data = number(op, 'Mask'), number(op, 'Data')
+                fkt = FKT_GPIO_PIN_STATE
+                payload = bytes(GPIO_PORT_HANDLE + (mask >> 8, mask & 0xFF, data >> 8, data & 0xFF))
+            elif 'MsgSend' == kind:
+                fblock, fkt = number(op, 'FBlockId'), number(op, 'FunctionId')
+                op_req, payload = number(op, 'OpTypeRequest'), hex_data(op, 'PayloadRequest')
+                op_resp, payload_resp = number(op, 'OpTypeResponse', OP_RESULT), hex_data(op, 'PayloadResponse')
+            else:
+                self.fail(op, '%s is not supported by this converter' % kind)
+            if 0xFF < len(payload) or 0xFF < len(payload_resp):
+                self.fail(op if isinstance(op, ET.Element) else op['elem'], 'script message payload too long')
+            msgs.append((pause, fblock, fkt, op_req, payload, op_resp, payload_resp))
+            pause = 0
+        if 0 != pause:
+            print('warning: line %d: pause at the end of script "%s" is ignored' %
+                  (self.lines[script], script.get('Name')), file=sys.stderr)
+        return msgs
+
+    def build_scripts(self):
+        for node in self.nodes:
+            name = node.get('Script')
+            if name is None:
+                continue
+            if name not in self.scripts:
+                self.fail(node, 'node 0x%X links the unknown script "%s"' % (number(node, 'Address'), name))
+            self.node_scripts.append((node, self.script_messages(self.scripts[name])))
+
+    # Output --------------------------------------------------------------
+
+    def emit(self, out, generator):
+        def obj(ctype, name, fields):
+            out.append('%s %s = { ' % (ctype, name))
+            out.append(',\n'.join('    ' + f for f in fields) + ' };')
+
+        def byte_list(data):
+            return ', '.join('0x%02X' % b for b in data)
+
+        out.append('/*' + '-' * 96 + '*/')
+        out.append('/* %-94s */' % 'UNICENS Generated Network Configuration')
+        out.append('/* %-94s */' % generator)
+        out.append('/*' + '-' * 96 + '*/')
+        out.append('#include "ucs_api.h"')
+        out.append('')
+        out.append('uint16_t PacketBandwidth = %d;' % self.packet_bw)
+        out.append('uint16_t RoutesSize = %d;' % len(self.routes))
+        out.append('uint16_t NodeSize = %d;' % len(self.nodes))
+        out.append('')
+        for i, route_id, active, source, sink in self.routes:
+            out.append('/* Route %d from source-node=0x%X to sink-node=0x%X */' %
+                       (i, number(source.node, 'Address'), number(sink.node, 'Address')))
+            for ep in (source, sink):
+                if ep.prefix is not None:
+                    continue
+                self.endpoint_objects(ep, i)
+                for ctype, name, fields in ep.objects:
+                    obj(ctype, name, fields)
+                out.append('Ucs_Xrm_ResObject_t *%s_JobList[] = {' % ep.prefix)
+                out.append(''.join('    &%s,\n' % name for _, name, _ in ep.objects) + '    NULL };')
+        for node, msgs in self.node_scripts:
+            suffix = 'ForNode%X' % number(node, 'Address')
+            for n, (pause, fblock, fkt, op_req, payload, op_resp, payload_resp) in enumerate(msgs, 1):
+                for kind, op, data in (('Request', op_req, payload), ('Response', op_resp, payload_resp)):
+                    pointer = 'NULL'
+                    if data:
+                        pointer = 'Payload%s%d%s' % (kind, n, suffix)
+                        out.append('UCS_NS_CONST uint8_t %s[] = {' % pointer)
+                        out.append('    %s };' % byte_list(data))
+                    out.append('UCS_NS_CONST Ucs_Ns_ConfigMsg_t %s%d%s = {' % (kind, n, suffix))
+                    out.append('    0x%02X,\n    0x%02X,\n    0x%04X,\n    0x%02X,\n    0x%02X,\n    %s };' %
+                               (fblock, INIC_INST, fkt, op, len(data), pointer))
+            entries = ['{\n        %d,\n        &Request%d%s,\n        &Response%d%s\n    }' %
+                       (m[0], n, suffix, n, suffix) for n, m in enumerate(msgs, 1)]
+            out.append('UCS_NS_CONST Ucs_Ns_Script_t Scripts%s[] = {' % suffix)
+            out.append('    ' + ', '.join(entries) + ' };')
+        scripts = dict((id(node), msgs) for node, msgs in self.node_scripts)
+        for node in self.nodes:
+            out.append('Ucs_Signature_t SignatureForNode%X = { 0x%X };' % (number(node, 'Address'), number(node, 'Address')))
+        entries = []
+        for node in self.nodes:
+            address = number(node, 'Address')
+            msgs = scripts.get(id(node))
+            entries.append('{\n        &SignatureForNode%X,\n        %s,\n        %d\n    }' %
+                           (address, ('ScriptsForNode%X' % address) if msgs else 'NULL', len(msgs) if msgs else 0))
+        out.append('Ucs_Rm_Node_t AllNodes[] = {')
+        out.append('    ' + ', '.join(entries) + ' };')
+        emitted = set()
+        for i, route_id, active, source, sink in self.routes:
+            for ep, kind in ((source, 'Source'), (sink, 'Sink')):
+                if id(ep) in emitted:
+                    continue
+                emitted.add(id(ep))
+                ep.name = '%sEndpointForRoute%d' % (kind, i)
+                out.append('Ucs_Rm_EndPoint_t %s = {' % ep.name)
+                out.append('    %s,\n    %s_JobList,\n    &AllNodes[%d] };' %
+                           ('UCS_RM_EP_SOURCE' if ep.is_source else 'UCS_RM_EP_SINK', ep.prefix, self.nodes.index(ep.node)))
+        routes = ['{\n        &%s,\n        &%s,\n        %d,\n        0x%04X\n    }' %
+                  (source.name, sink.name, 1 if active else 0, route_id) for _, route_id, active, source, sink in self.routes]
+        out.append('Ucs_Rm_Route_t AllRoutes[] = { ' + ', '.join(routes) + ' };')
+
+    def report(self, network):
+        jobs = 0
+        seen = set()
+        sync_bw = {}
+        for i, route_id, active, source, sink in self.routes:
+            for ep in (source, sink):
+                if id(ep) not in seen:
+                    seen.add(id(ep))
+                    jobs += ep.job_count()
+            # All sinks of a route listen to the same network channel
+            sync_bw[source.route] = source.bandwidth
+            print('Route %d 0x%04X "%s" 0x%X -> 0x%X: %d+%d XRM jobs, %d bytes/frame (%d kbit/s)%s' %
+                  (i, route_id, source.route, number(source.node, 'Address'), number(sink.node, 'Address'),
+                   source.job_count(), sink.job_count(), source.bandwidth, source.bandwidth * 8 * FRAME_RATE // 1000,
+                   '' if active else ', inactive'), file=sys.stderr)
+        messages = 0
+        for node, msgs in self.node_scripts:
+            messages += len(msgs)
+            print('Node 0x%X: script "%s", %d messages' % (number(node, 'Address'), node.get('Script'), len(msgs)),
+                  file=sys.stderr)
+        print('%d routes, %d nodes, %d XRM jobs, %d script messages, %d I2C writes merged into bursts' %
+              (len(self.routes), len(self.nodes), jobs, messages, self.merged), file=sys.stderr)
+        used = sum(sync_bw.values())
+        if network in FRAME_BYTES:
+            print('Network bandwidth: %d sync + %d packet of %d bytes/frame' %
+                  (used, self.packet_bw, FRAME_BYTES[network]), file=sys.stderr)
+        else:
+            print('Network bandwidth: %d sync + %d packet bytes/frame' % (used, self.packet_bw), file=sys.stderr)
+
+    def check_bandwidth(self, network):
+        used = sum(dict((src.route, src.bandwidth) for _, _, _, src, _ in self.routes).values())
+        if network in FRAME_BYTES and FRAME_BYTES[network] < used + self.packet_bw:
+            raise ConfigError('routes need %d sync bytes/frame, only %d are left next to AsyncBandwidth=%d' %
+                              (used, FRAME_BYTES[network] - self.packet_bw, self.packet_bw))
+
+
+def compile_config(path, schema_path, merge, quiet):
+    root, lines = parse_xml(path)
+    errors = Schema(schema_path).validate(root, lines)
+    if errors:
+        raise ConfigError('\n'.join('%s: %s' % (path, e) for e in errors))
+    network = root.get('Network', 'INICnet-150')
+    compiler = Compiler(root, lines, merge)
+    try:
+        compiler.build_routes()
+        compiler.build_scripts()
+        compiler.check_bandwidth(network)
+    except ConfigError as e:
+        raise ConfigError('%s: %s' % (path, e))
+    out = []
+    compiler.emit(out, 'Generator: xml2struct.py V%s' % VERSION)
+    if not quiet:
+        compiler.report(network)
+    return '\n'.join(out) + '\n'
+
+
+def synthetic(sinks):
+    """Configuration with one MediaLB source and one route per sink, each sink configured by an I2C script."""
+    # The source is the local node, so every sink is a remote node
+    if not 1 <= sinks <= MAX_REMOTE_NODES:
+        raise ConfigError('--synthetic needs 1 to %d sink nodes, the firmware handles %d nodes including the source' %
+                          (MAX_REMOTE_NODES, MAX_REMOTE_NODES + 1))
+    out = ['<?xml version="1.0"?>',
+           '<Unicens AsyncBandwidth="12" xmlns:xsi="http://www.w3.org/2001/XMLSchema-instance" '
+           'xsi:noNamespaceSchemaLocation="unicens.xsd">',
+           '  <Node Address="0x200">']
+    for i in range(sinks):
+        out.append('    <SyncConnection MuteMode="NoMuting">')
+        out.append('      <MediaLBSocket ChannelAddress="0x%X" Bandwidth="4"/>' % (0xA + 2 * i))
+        out.append('      <NetworkSocket Route="Route%d" Bandwidth="4"/>' % (i + 1))
+        out.append('    </SyncConnection>')
+    out.append('  </Node>')
+    for i in range(sinks):
+        out.append('  <Node Address="0x%X" Script="amp-config">' % (0x201 + i))
+        out.append('    <StreamPort ClockConfig="64Fs" DataAlignment="Left16Bit"/>')
+        out.append('    <SyncConnection MuteMode="NoMuting">')
+        out.append('      <NetworkSocket Route="Route%d" Bandwidth="4" RouteId="0x%X"/>' % (i + 1, 0x10 + i))
+        out.append('      <StreamSocket StreamPinID="SRXA0" Bandwidth="4"/>')
+        out.append('    </SyncConnection>')
+        out.append('  </Node>')
+    out.append('  <Script Name="amp-config">')
+    out.append('    <I2CPortCreate Speed="FastMode"/>')
+    for reg in (0x1B, 0x11, 0x12, 0x13, 0x14):
+        out.append('    <I2CPortWrite Address="0x2A" Payload="%02X 00"/>' % reg)
+    out.append('  </Script>')
+    out.append('</Unicens>')
+    return '\n'.join(out) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a UNICENS XML network configuration into C structures')
+    parser.add_argument('config', nargs='?', help='XML configuration, e.g. audio-source/config.xml')
+    parser.add_argument('-o', '--output', help='write the C file here instead of stdout')
+    parser.add_argument('--schema', help='XML schema, default is unicens.xsd next to the configuration')
+    parser.add_argument('--check', metavar='C_FILE', help='fail if C_FILE differs from the generated code')
+    parser.add_argument('--no-merge', action='store_true', help='do not merge I2C writes into bursts')
+    parser.add_argument('--quiet', action='store_true', help='omit the summary on stderr')
+    parser.add_argument('--synthetic', type=int, metavar='N', help='print a configuration with N sink nodes and exit')
+    args = parser.parse_args()
+
+    try:
+        if args.synthetic is not None:
+            sys.stdout.write(synthetic(args.synthetic))
+            return
+        if args.config is None:
+            parser.error('the XML configuration is missing')
+        schema = args.schema or os.path.join(os.path.dirname(os.path.abspath(args.config)), 'unicens.xsd')
+        if not os.path.exists(schema):
+            schema = DEFAULT_SCHEMA
+        code = compile_config(args.config, schema, not args.no_merge, args.quiet)
+    except ConfigError as e:
+        sys.exit('error: %s' % e)
+    if args.check:
+        with open(args.check) as f:
+            if f.read() != code:
+                sys.exit('error: %s is outdated, run %s' % (args.check, os.path.basename(sys.argv[0])))
+        return
+    if args.output:
+        with open(args.output, 'w', newline='\n') as f:
+            f.write(code)
+    else:
+        sys.stdout.write(code)
+
+
+if __name__ == '__main__':
+    main()